@@ -30,21 +30,33 @@ using namespace Chaos;
 Controller::Controller() {
   std::lock_guard<std::mutex> lock(stateMutex);
   memset(controllerState, 0, sizeof(controllerState));
+  for (auto& stamp : stateStamps) {
+    stamp.store(0, std::memory_order_relaxed);
+  }
   // Hybrid trigger axes are centered at JOYSTICK_MIN when released.
   controllerState[((int) TYPE_AXIS << 8) + (int) AXIS_L2] = JOYSTICK_MIN;
   controllerState[((int) TYPE_AXIS << 8) + (int) AXIS_R2] = JOYSTICK_MIN;
 }
 
-short Controller::getState(std::shared_ptr<ControllerInput> signal) {
+short Controller::getState(Handle<ControllerInput> signal) {
   return getState(signal->getID(), signal->getButtonType());
 }
 
+void Controller::storeLocked(int location, short value) {
+  if (location >= 1024 || controllerState[location] == value) {
+    return;
+  }
+  controllerState[location] = value;
+  // Stamp the signal before publishing the count, so a reader that sees the new count also sees
+  // which signal changed.
+  uint64_t count = stateChanges.load(std::memory_order_relaxed) + 1;
+  stateStamps[location].store(count, std::memory_order_release);
+  stateChanges.store(count, std::memory_order_release);
+}
+
 void Controller::storeState(const DeviceEvent& event) {
   std::lock_guard<std::mutex> lock(stateMutex);
-  int location = ((int) event.type << 8) + (int) event.id;
-  if (location < 1024) {
-    controllerState[location] = event.value;
-  }
+  storeLocked(event.index(), event.value);
 }
 
 void Controller::handleNewDeviceEvent(const DeviceEvent& event) {
@@ -80,33 +92,44 @@ bool Controller::dispatchEvent(const DeviceEvent& event, bool allow_during_menu)
   return true;
 }
 
+bool Controller::dispatchEvents(const std::vector<DeviceEvent>& events, bool allow_during_menu) {
+  if (events.empty()) {
+    return true;
+  }
+  if (controllerInjector != nullptr) {
+    return controllerInjector->dispatchControllerEvents(
+        events,
+        [this](const std::vector<DeviceEvent>& emitted) { applyEvents(emitted); },
+        allow_during_menu);
+  }
+  applyEvents(events);
+  return true;
+}
+
 void Controller::addInjector(ControllerInjector* injector) {
   this->controllerInjector = injector;
 }
 
-bool Controller::matches(const DeviceEvent& event, std::shared_ptr<ControllerInput> signal) {
+bool Controller::matches(const DeviceEvent& event, Handle<ControllerInput> signal) {
   return (event.type == signal->getButtonType() && event.id == signal->getID());
 }
 
-void Controller::setValue(std::shared_ptr<ControllerInput> signal, short value) {
+void Controller::setValue(Handle<ControllerInput> signal, short value) {
   // to do: screen to max for signal type
-  value = ControllerInput::joystickLimit(value);
-  DeviceEvent event = {0, value, (uint8_t) signal->getButtonType(), signal->getID()};
-  if (signal->getType() == ControllerSignalType::HYBRID) {
-    dispatchEvent(event);
-    event = {0, (short)((value) ? JOYSTICK_MAX : JOYSTICK_MIN), TYPE_AXIS, signal->getHybridAxis()};
-  }
-  PLOG_DEBUG << "Setting " << signal->getName() << " to " << value;
-  dispatchEvent(event);
+  std::vector<DeviceEvent> events;
+  signal->addValueEvents(value, events);
+  PLOG_DEBUG << "Setting " << signal->getName() << " to " << events.front().value;
+  // Hybrid controls set the button and axis together
+  dispatchEvents(events);
 }
 
 // Send a new event to turn off the command.
-void Controller::setOff(std::shared_ptr<ControllerInput> signal) {
+void Controller::setOff(Handle<ControllerInput> signal) {
   setValue(signal, 0);
 }
 
 // Send a new event to turn the command to its maximum value.
-void Controller::setOn(std::shared_ptr<ControllerInput> signal) {
+void Controller::setOn(Handle<ControllerInput> signal) {
   DeviceEvent event;
   PLOG_DEBUG << "Turning " << signal->getName() << " on";
   switch (signal->getType()) {
@@ -130,3 +153,10 @@ void Controller::applyEvent(const DeviceEvent& event) {
 	//}
 	storeState(event);
 }
+
+void Controller::applyEvents(const std::vector<DeviceEvent>& events) {
+  std::lock_guard<std::mutex> lock(stateMutex);
+  for (const auto& event : events) {
+    storeLocked(event.index(), event.value);
+  }
+}
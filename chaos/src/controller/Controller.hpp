@@ -20,8 +20,12 @@
 #pragma once
 #include <deque>
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <vector>
+#include <handle.hpp>
 
 #include "DeviceEvent.hpp"
 #include "ControllerInjector.hpp"
@@ -62,7 +66,22 @@ namespace Chaos {
      */
     short controllerState[1024];
 
+    /**
+     * \brief Change stamps for the controller state.
+     *
+     * Every time a signal's value changes, the change counter is advanced and the signal's entry in
+     * stateStamps is set to the new count. A reader that remembers the count from its last look can
+     * tell whether any of the signals it depends on have changed since then.
+     */
+    std::array<std::atomic<uint64_t>, 1024> stateStamps;
+    std::atomic<uint64_t> stateChanges{0};
+
     mutable std::mutex stateMutex;
+
+    /**
+     * \brief Store a value and stamp it if it changed. The caller must hold stateMutex.
+     */
+    void storeLocked(int location, short value);
 	
     ControllerInjector* controllerInjector = nullptr;
 
@@ -95,14 +114,41 @@ namespace Chaos {
      * for the hybrid controls, we only read the button signal, since currently we're only interested
      * in whether it is on or off. This may need to change for other games.
      */
-    short getState(std::shared_ptr<ControllerInput> signal);
+    short getState(Handle<ControllerInput> signal);
+
+    /**
+     * \brief Number of changes made to the controller state so far.
+     */
+    uint64_t changeCount() const { return stateChanges.load(std::memory_order_acquire); }
+
+    /**
+     * \brief Test if a signal has changed since the change count was last read.
+     *
+     * \param index Index of the signal in the state table, as returned by DeviceEvent::index()
+     * \param since Value of changeCount() when the signal was last read
+     */
+    bool changedSince(int index, uint64_t since) const {
+      return index >= 0 && index < 1024 && stateStamps[index].load(std::memory_order_acquire) > since;
+    }
 
     /**
      * \brief Change the controller state
      * 
      * \param event New event to go to the console
+     *
+     * Subclasses that need to observe the output, such as the replay harness, can override this.
+     */
+    virtual void applyEvent(const DeviceEvent& event);
+
+    /**
+     * \brief Change the controller state for several signals at once
+     *
+     * All events are stored under a single acquisition of the state lock, so the report sent to
+     * the console sees either none or all of them.
+     *
+     * \param events New events to go to the console
      */
-    void applyEvent(const DeviceEvent& event);
+    virtual void applyEvents(const std::vector<DeviceEvent>& events);
 
     /**
      * \brief Emit an event through injector dispatch policy before applying controller state.
@@ -112,6 +158,15 @@ namespace Chaos {
      * \return true if the event was applied, false if it was suppressed.
      */
     bool dispatchEvent(const DeviceEvent& event, bool allow_during_menu = false);
+
+    /**
+     * \brief Emit a batch of events through injector dispatch policy and apply them atomically.
+     *
+     * \param events Events to emit.
+     * \param allow_during_menu True when these events are part of active menu navigation.
+     * \return true if the events were applied, false if they were suppressed.
+     */
+    bool dispatchEvents(const std::vector<DeviceEvent>& events, bool allow_during_menu = false);
     
     /**
      * \brief Test if event matches a specific input signal
@@ -126,26 +181,26 @@ namespace Chaos {
      * This tests both that the event against the defined signal and that any defined condition
      * is also in effect.
      */
-    bool matches(const DeviceEvent& event, std::shared_ptr<ControllerInput> signal);
+    bool matches(const DeviceEvent& event, Handle<ControllerInput> signal);
 
     /**
      * Sets the signal to the specified value
      * \param signal The signal to set
      * \param value  The value to set
      */
-    void setValue(std::shared_ptr<ControllerInput> signal, short value);
+    void setValue(Handle<ControllerInput> signal, short value);
 
     /**
      * Turns off the button/axis for the associated input signal.
      * \param[in] The signal that we're disabling.
      */
-    void setOff(std::shared_ptr<ControllerInput> signal);
+    void setOff(Handle<ControllerInput> signal);
 
     /**
      * Turns on the button/axis for the associated input signal.
      * \param[in] The command that we're turning on.
      */
-    void setOn(std::shared_ptr<ControllerInput> signal);
+    void setOn(Handle<ControllerInput> signal);
     
     /**
      * \brief Register the injector used for passthrough event rewriting.
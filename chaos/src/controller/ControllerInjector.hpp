@@ -18,7 +18,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #pragma once
-#include <functional>
+#include <vector>
+#include <function_ref.hpp>
 #include "DeviceEvent.hpp"
 
 namespace Chaos {
@@ -49,9 +50,24 @@ namespace Chaos {
      * \return true if the event was emitted, false if it was suppressed.
      */
     virtual bool dispatchControllerEvent(const DeviceEvent& event,
-                                         const std::function<void(const DeviceEvent&)>& apply,
+                                         FunctionRef<void(const DeviceEvent&)> apply,
                                          bool allow_during_menu = false) = 0;
 
+    /**
+     * \brief Dispatch a batch of events to the controller under injector policy.
+     *
+     * The batch is either emitted or suppressed as a whole, so related signals (e.g., the two
+     * axes of a joystick) never reach the console half-updated.
+     *
+     * \param events Events to emit to controller state/output.
+     * \param apply Callback that applies the whole batch to the controller.
+     * \param allow_during_menu True if these events are part of active menu navigation.
+     * \return true if the events were emitted, false if they were suppressed.
+     */
+    virtual bool dispatchControllerEvents(const std::vector<DeviceEvent>& events,
+                                          FunctionRef<void(const std::vector<DeviceEvent>&)> apply,
+                                          bool allow_during_menu = false) = 0;
+
     /**
      * Whether raw USB reports should bypass state reconstruction in ControllerRaw.
      *
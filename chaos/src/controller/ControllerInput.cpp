@@ -115,7 +115,7 @@ short ControllerInput::getMax(ButtonType type) {
 }
 
 // necessary anymore?
-short ControllerInput::getMax(std::shared_ptr<ControllerInput> signal) {
+short ControllerInput::getMax(Handle<ControllerInput> signal) {
   return signal->getMax(TYPE_AXIS);
 }
 
@@ -135,3 +135,11 @@ bool ControllerInput::matches(const DeviceEvent& event) {
     event.index() << "; match=" << (rval ? "YES" : "NO");
   return rval;
 }
+
+void ControllerInput::addValueEvents(short value, std::vector<DeviceEvent>& events) {
+  value = joystickLimit(value);
+  events.push_back({0, value, (uint8_t) getButtonType(), button_id});
+  if (input_type == ControllerSignalType::HYBRID) {
+    events.push_back({0, (short) ((value) ? JOYSTICK_MAX : JOYSTICK_MIN), TYPE_AXIS, hybrid_axis});
+  }
+}
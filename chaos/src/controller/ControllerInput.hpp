@@ -22,8 +22,10 @@
 #include <memory>
 #include <cmath>
 #include <unordered_map>
+#include <vector>
 #include <toml++/toml.h>
 #include <plog/Log.h>
+#include <handle.hpp>
 
 #include "DeviceEvent.hpp"
 #include "signals.hpp"
@@ -197,6 +199,11 @@ namespace Chaos {
      * \return Hybrid-axis index in the controller state table.
      */
     int getHybridAxisIndex() { return hybrid_index; }
+
+    /**
+     * \brief Get the controller whose state this signal reads.
+     */
+    Controller& getController() { return controller; }
     
     /**
      * \brief Get the minimum value for this signal.
@@ -220,7 +227,7 @@ namespace Chaos {
      * For the hybrid controls, we return the maximum of the axis, because that's the value we need
      * to pass when building sequences.
      */
-    static short getMax(std::shared_ptr<ControllerInput> signal);
+    static short getMax(Handle<ControllerInput> signal);
 
     /**
      * \brief Constrain to joystick limits
@@ -243,6 +250,16 @@ namespace Chaos {
      */
     short getState(bool hybrid_axis);
 
+    /**
+     * \brief Append the events that set this signal to a value.
+     * \param value The value to set, clipped to joystick limits
+     * \param events Vector that receives the events
+     *
+     * Hybrid controls produce two events: the button value, followed by the axis set fully on or
+     * off to match it.
+     */
+    void addValueEvents(short value, std::vector<DeviceEvent>& events);
+
     /**
      * \brief Does the command match the incoming device event
      * 
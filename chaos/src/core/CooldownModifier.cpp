@@ -17,6 +17,7 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <cassert>
 #include <plog/Log.h>
 #include <timer.hpp>
@@ -32,7 +33,7 @@ using namespace Chaos;
 const std::string CooldownModifier::mod_type = "cooldown";
 
 namespace {
-short normalizeBlockedCommandValue(const std::shared_ptr<ControllerInput>& signal,
+short normalizeBlockedCommandValue(Handle<ControllerInput> signal,
                                    const DeviceEvent& event) {
   if (!signal || signal->getType() != ControllerSignalType::HYBRID) {
     return event.value;
@@ -48,7 +49,7 @@ short normalizeBlockedCommandValue(const std::shared_ptr<ControllerInput>& signa
 
 CooldownModifier::CooldownModifier(toml::table& config, EngineInterface* e) {
   
-  TOMLUtils::checkValid(config, std::vector<std::string>{"name", "description", "type", "groups",
+  TOMLUtils::checkValid(config, {"name", "description", "type", "groups",
 							  "begin_sequence", "finish_sequence", "applies_to", "while", "while_operation",
                 "start_type", "time_on", "time_off", "trigger", "unlisted"});
   initialize(config, e);
@@ -97,29 +98,33 @@ CooldownModifier::CooldownModifier(toml::table& config, EngineInterface* e) {
   for (auto& c : conditions) {
     PLOG_VERBOSE << "With condition" << c->getName();
   }
+  blocked_command_values.assign(commands.size(), 0);
+  blocked_command_valid.assign(commands.size(), false);
 }
 
 void CooldownModifier::begin() {
   cooldown_timer = 0;
   state = CooldownState::UNTRIGGERED;
-  blocked_command_values.clear();
+  std::fill(blocked_command_valid.begin(), blocked_command_valid.end(), false);
   PLOG_DEBUG << "Initialized " << getName();
 }
 
 void CooldownModifier::restoreBlockedCommands() {
-  for (auto& cmd : commands) {
+  restore_events.clear();
+  for (size_t i = 0; i < commands.size(); ++i) {
+    auto& cmd = commands[i];
     if (!cmd || !cmd->getInput()) {
       continue;
     }
-    auto signal = cmd->getInput();
-    short restore_value = engine->getState(signal->getID(), signal->getButtonType());
-    auto it = blocked_command_values.find(cmd->getName());
-    if (it != blocked_command_values.end()) {
-      restore_value = it->second;
-    }
-    engine->setValue(cmd, restore_value);
+    Handle<ControllerInput> signal = cmd->getInput();
+    short restore_value = blocked_command_valid[i]
+        ? blocked_command_values[i]
+        : engine->getState(signal->getID(), signal->getButtonType());
+    signal->addValueEvents(restore_value, restore_events);
   }
-  blocked_command_values.clear();
+  // Release everything at once so multi-signal commands come back together
+  engine->applyEvents(restore_events);
+  std::fill(blocked_command_valid.begin(), blocked_command_valid.end(), false);
 }
 
 void CooldownModifier::update() {
@@ -163,7 +168,7 @@ void CooldownModifier::update() {
       PLOG_DEBUG << "Cooldown for " << getName() << " started";
 	    cooldown_timer = time_off;
 	    state = CooldownState::BLOCK;
-      blocked_command_values.clear();
+      std::fill(blocked_command_valid.begin(), blocked_command_valid.end(), false);
       // Turn off all the commands we're blocking.
       // This was formerly done through fakePipelinedEvent(), but since remapping is now done
       // before we see this event, I don't think it needs to be pipelined.
@@ -189,12 +194,14 @@ bool CooldownModifier::tweak(DeviceEvent& event) {
   }
   // Block events in the command list while in cooldown
   if (state == CooldownState::BLOCK) {
-    for (auto& cmd : commands) {
+    for (size_t i = 0; i < commands.size(); ++i) {
+      auto& cmd = commands[i];
       assert(cmd && cmd->getInput());
-      std::shared_ptr<ControllerInput> sig = cmd->getInput();
+      Handle<ControllerInput> sig = cmd->getInput();
       PLOG_VERBOSE << "Checking " << cmd->getName() << ", maps to " << ((sig) ? sig->getName() : "NULL");
       if (sig && sig->matches(event)) {
-        blocked_command_values[cmd->getName()] = normalizeBlockedCommandValue(sig, event);
+        blocked_command_values[i] = normalizeBlockedCommandValue(sig, event);
+        blocked_command_valid[i] = true;
         PLOG_DEBUG << "Blocked " << cmd->getName();
         return false;
       }
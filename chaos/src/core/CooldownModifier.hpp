@@ -20,7 +20,7 @@
 #pragma once
 #include <queue>
 #include <memory>
-#include <unordered_map>
+#include <vector>
 #include <toml++/toml.h>
 #include <timer.hpp>
 
@@ -100,9 +100,16 @@ namespace Chaos {
      * Last observed intended values for blocked commands while in BLOCK state.
      *
      * At cooldown expiry we restore using current live controller state, but we prefer
-     * these values for commands that emitted blocked events during cooldown.
+     * these values for commands that emitted blocked events during cooldown. Entries are by
+     * position in #commands, and only those whose bit in #blocked_command_valid is set are used.
      */
-    std::unordered_map<std::string, short> blocked_command_values;
+    std::vector<short> blocked_command_values;
+    std::vector<bool> blocked_command_valid;
+
+    /**
+     * Reusable batch for restoring all blocked commands in one controller update.
+     */
+    std::vector<DeviceEvent> restore_events;
 
     void restoreBlockedCommands();
 
@@ -0,0 +1,95 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <plog/Log.h>
+#include <toml++/toml.h>
+
+#include "CurveModifier.hpp"
+#include "EngineInterface.hpp"
+#include "TOMLUtils.hpp"
+
+using namespace Chaos;
+
+const std::string CurveModifier::mod_type = "curve";
+
+namespace {
+std::vector<std::pair<double, double>> parsePoints(const toml::array& list) {
+  std::vector<std::pair<double, double>> points;
+  for (const auto& node : list) {
+    const toml::array* point = node.as_array();
+    if (!point || point->size() != 2) {
+      throw std::runtime_error("Each entry in 'points' must be a pair of numbers [input, output]");
+    }
+    std::optional<double> x = (*point)[0].value<double>();
+    std::optional<double> y = (*point)[1].value<double>();
+    if (!x || !y) {
+      throw std::runtime_error("Each entry in 'points' must be a pair of numbers [input, output]");
+    }
+    points.emplace_back(*x, *y);
+  }
+  return points;
+}
+}
+
+CurveModifier::CurveModifier(toml::table& config, EngineInterface* e) {
+  TOMLUtils::checkValid(config, {
+      "name", "description", "type", "groups", "applies_to", "begin_sequence", "finish_sequence",
+      "unlisted", "while", "while_operation", "curve", "points", "deadzone", "exponent", "steps"});
+  initialize(config, e);
+
+  if (commands.empty()) {
+    throw std::runtime_error("No commands defined in applies_to");
+  }
+
+  const toml::array* points = config["points"].as_array();
+  std::optional<std::string> shape = config["curve"].value<std::string>();
+  if (points && shape) {
+    throw std::runtime_error("Define either 'curve' or 'points', not both");
+  }
+  if (points) {
+    curve = ResponseCurve::fromPoints(parsePoints(*points));
+  } else if (!shape) {
+    throw std::runtime_error("Curve modifier needs a 'curve' or a list of 'points'");
+  } else if (*shape == "deadzone") {
+    curve = ResponseCurve::deadzone(TOMLUtils::getValue<double>(config, "deadzone", 0.0, 0.99, 0.1));
+  } else if (*shape == "exponential") {
+    curve = ResponseCurve::exponential(TOMLUtils::getValue<double>(config, "exponent", 0.1, 10.0, 2.0));
+  } else if (*shape == "steps") {
+    curve = ResponseCurve::steps(TOMLUtils::getValue<int>(config, "steps", 1, 127, 4));
+  } else {
+    throw std::runtime_error("Unknown curve '" + *shape + "'");
+  }
+}
+
+bool CurveModifier::tweak(DeviceEvent& event) {
+  for (auto& cmd : commands) {
+    if (engine->eventMatches(event, cmd)) {
+      // Buttons of hybrid controls such as the triggers keep their on/off values
+      if (event.type == TYPE_AXIS && ResponseCurve::covers(event.value) && inCondition(event)) {
+        event.value = curve.apply(event.value);
+      }
+      break;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,69 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <string>
+#include <toml++/toml.h>
+
+#include "DeviceEvent.hpp"
+#include "Modifier.hpp"
+#include "EngineInterface.hpp"
+#include "ResponseCurve.hpp"
+
+namespace Chaos {
+  /** 
+   * \brief A modifier that passes incoming signals through a response curve.
+   *
+   * The curve is either a list of control points or one of the named curves (dead zone,
+   * exponential, or stepped). Either way it is compiled into a ResponseCurve table when the
+   * modifier is loaded.
+   * 
+   * The TOML syntax defining curve modifiers is described in chaosConfigFiles.md
+   */
+  class CurveModifier : public Modifier::Registrar<CurveModifier> {
+  private:
+    ResponseCurve curve;
+    
+  public:
+    
+    /**
+     * \brief Construct a curve modifier from TOML configuration.
+     *
+     * \param config Modifier configuration table.
+     * \param e Engine interface pointer.
+     */
+    CurveModifier(toml::table& config, EngineInterface* e);
+
+    static const std::string mod_type;
+
+    /**
+     * \brief Return this modifier's registered factory type name.
+     */
+    const std::string& getModType() { return mod_type; }
+
+    /**
+     * \brief Apply the response curve to matching event values.
+     *
+     * \param event Event to transform.
+     * \return true if event should continue through pipeline.
+     */
+    bool tweak(DeviceEvent& event);
+
+  };
+};
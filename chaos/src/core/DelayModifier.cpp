@@ -18,10 +18,11 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include <algorithm>
-#include <optional>
 #include <stdexcept>
+#include <clock.hpp>
 
 #include "DelayModifier.hpp"
+#include "ControllerInput.hpp"
 #include "EngineInterface.hpp"
 #include "TOMLUtils.hpp"
 
@@ -31,8 +32,8 @@ const std::string DelayModifier::mod_type = "delay";
 
 DelayModifier::DelayModifier(toml::table& config, EngineInterface* e) {
   
-  TOMLUtils::checkValid(config, std::vector<std::string>{"name", "description", "type", "groups",
-							  "applies_to", "delay", "begin_sequence", "finish_sequence", "unlisted"});
+  TOMLUtils::checkValid(config, {"name", "description", "type", "groups",
+							  "applies_to", "delay", "queue_limit", "begin_sequence", "finish_sequence", "unlisted"});
   initialize(config, e);
 
   if (commands.empty() && ! applies_to_all) {
@@ -44,69 +45,110 @@ DelayModifier::DelayModifier(toml::table& config, EngineInterface* e) {
   if (delayTime <= 0) {
     throw std::runtime_error("Bad or missing delay time. The 'delay' parameter must be positive.");
   }
+  delay_ns = static_cast<int64_t>(delayTime * Clock::NSEC_PER_SEC);
   PLOG_VERBOSE << " - delay: " << delayTime;
+
+  int64_t limit = config["queue_limit"].value_or(4096);
+  if (limit <= 0) {
+    throw std::runtime_error("The 'queue_limit' parameter must be positive.");
+  }
+  PLOG_VERBOSE << " - queue_limit: " << limit;
+  queue_limit = static_cast<size_t>(limit);
 }
 
 void DelayModifier::begin() {
+  // Allocate on first use rather than at load, since most delay mods in a game are never chosen.
+  // The queue never grows while the mod is running.
+  if (eventQueue.capacity() == 0) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    eventQueue = RingBuffer<TimeAndEvent>(queue_limit);
+    due.reserve(queue_limit);
+  }
   clearPendingInjectedEvents();
+  dropped = 0;
+  coalesced = 0;
 }
 
 void DelayModifier::finish() {
   clearPendingInjectedEvents();
+  if (dropped || coalesced) {
+    PLOG_INFO << getName() << ": " << dropped << " events dropped with the queue full, "
+              << coalesced << " axis events coalesced";
+  }
 }
 
 std::size_t DelayModifier::clearPendingInjectedEvents() {
   std::lock_guard<std::mutex> lock(queue_mutex);
   const std::size_t cleared = eventQueue.size();
-  std::queue<TimeAndEvent> empty;
-  std::swap(eventQueue, empty);
+  eventQueue.clear();
   return cleared;
 }
 
 void DelayModifier::update() {
-  const auto now = std::chrono::steady_clock::now();
-  while (true) {
-    std::optional<TimeAndEvent> delayed;
-    {
-      std::lock_guard<std::mutex> lock(queue_mutex);
-      if (eventQueue.empty()) {
-        break;
-      }
-      const auto elapsed = std::chrono::duration<double>(now - eventQueue.front().time).count();
-      if (elapsed < delayTime) {
-        break;
-      }
-      delayed = eventQueue.front();
+  const int64_t cutoff = Clock::now() - delay_ns;
+  due.clear();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    while (!eventQueue.empty() && eventQueue.front().time <= cutoff) {
+      due.push_back(eventQueue.front());
       eventQueue.pop();
     }
-    if (!delayed) {
-      break;
+  }
+  if (due.empty()) {
+    return;
+  }
+
+  // Mark axis events that a later event for the same axis supersedes in this batch. The time
+  // field of a superseded event is cleared to flag it.
+  axis_seen.reset();
+  for (auto it = due.rbegin(); it != due.rend(); ++it) {
+    if (it->event.type != TYPE_AXIS) {
+      continue;
+    }
+    if (axis_seen.test(it->event.id)) {
+      it->time = -1;
+      ++coalesced;
+    } else {
+      axis_seen.set(it->event.id);
+    }
+  }
+
+  // Reintroduce the events without holding the queue lock; injected events can recursively
+  // touch this modifier.
+  for (TimeAndEvent& delayed : due) {
+    if (delayed.time < 0) {
+      continue;
+    }
+    PLOG_DEBUG << "Defered event sent: " << engine->getEventName(delayed.event);
+    engine->fakePipelinedEvent(delayed.event, getptr());
+  }
+}
+
+void DelayModifier::enqueue(int64_t now, const DeviceEvent& event) {
+  std::lock_guard<std::mutex> lock(queue_mutex);
+  if (!eventQueue.push({now, event})) {
+    if (dropped++ == 0) {
+      PLOG_WARNING << getName() << ": delay queue is full; dropping the oldest events";
     }
-    // Reintroduce the event after dropping the queue lock; injected events can
-    // recursively touch this modifier.
-    PLOG_DEBUG << "Defered event sent: " << engine->getEventName(delayed->event);
-    engine->fakePipelinedEvent(delayed->event, getptr());
   }
 }
 
 // Block the original command that's being delayed. We add it to a queue that is popped and sent
 // as a new event when the timer expires
 bool DelayModifier::tweak(DeviceEvent& event) {
-  const auto now = std::chrono::steady_clock::now();
+  const int64_t now = Clock::now();
   // Shortcut if we're working on all commands
   if (applies_to_all) {
     PLOG_DEBUG << "Incoming event " << engine->getEventName(event) << " queued";
-    std::lock_guard<std::mutex> lock(queue_mutex);
-    eventQueue.push ({now, event});
+    enqueue(now, event);
     return false;
   }
   else {
-    for (auto cmd : commands) {
+    for (auto& cmd : commands) {
       if (engine->eventMatches(event, cmd)) {
         PLOG_DEBUG << "Incoming event (" << engine->getEventName(event) << ") queued";
-        std::lock_guard<std::mutex> lock(queue_mutex);
-      	eventQueue.push ({now, event});
-	      return false;
+        enqueue(now, event);
+        return false;
       }
     }
   }
@@ -18,11 +18,14 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <atomic>
+#include <bitset>
 #include <cstddef>
-#include <chrono>
+#include <cstdint>
 #include <mutex>
-#include <queue>
+#include <vector>
 #include <toml++/toml.h>
+#include <ring_buffer.hpp>
 #include <timer.hpp>
 
 #include "Modifier.hpp"
@@ -31,7 +34,7 @@
 namespace Chaos {
 
   typedef struct _TimeAndEvent{
-    std::chrono::steady_clock::time_point time;
+    int64_t time;  ///< Clock::now() when the event arrived
     DeviceEvent event;
   } TimeAndEvent;
 
@@ -56,13 +59,35 @@ namespace Chaos {
    * - groups: A list of functional groups to classify the mod for voting. (_Optional_)
    * - appliesTo: A list of commands affected by the mod. (_Required_)
    * - delay: Time in seconds to delay the listed commands. (_Required_)
+   * - queue_limit: Most events held at once. (_Optional. Default = 4096_)
    *
+   * Events wait in a ring buffer of fixed size, allocated the first time the mod begins. If it
+   * fills up, the oldest event is dropped. When
+   * several events for the same axis come due in one update, only the latest is replayed, since the
+   * earlier values would be overwritten before the console could act on them. Button events are
+   * always replayed in full.
    */
   class DelayModifier : public Modifier::Registrar<DelayModifier> {
   protected:
-    std::queue<TimeAndEvent> eventQueue;
+    RingBuffer<TimeAndEvent> eventQueue;
+    size_t queue_limit;
     std::mutex queue_mutex;
     double delayTime;
+    int64_t delay_ns;
+
+    // Events that came due in the current update. Only used from update().
+    std::vector<TimeAndEvent> due;
+    // Axes already seen while scanning the due events from newest to oldest
+    std::bitset<256> axis_seen;
+
+    // Counts for the current activation
+    std::atomic<size_t> dropped{0};
+    std::atomic<size_t> coalesced{0};
+
+    /**
+     * \brief Add an event to the queue, dropping the oldest one if it is full.
+     */
+    void enqueue(int64_t now, const DeviceEvent& event);
     
   public:
     
@@ -110,5 +135,16 @@ namespace Chaos {
      * \return Number of events cleared.
      */
     std::size_t clearPendingInjectedEvents() override;
+
+    /**
+     * \brief Events discarded because the queue was full, since the mod began.
+     */
+    size_t droppedEvents() const { return dropped; }
+
+    /**
+     * \brief Axis events skipped because a later value for the same axis came due in the same
+     * update, since the mod began.
+     */
+    size_t coalescedEvents() const { return coalesced; }
   };
 };
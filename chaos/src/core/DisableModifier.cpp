@@ -17,6 +17,7 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <stdexcept>
 #include <string_view>
 
@@ -34,7 +35,7 @@ using namespace Chaos;
 const std::string DisableModifier::mod_type = "disable";
 
 namespace {
-short normalizeBlockedCommandValue(const std::shared_ptr<ControllerInput>& signal,
+short normalizeBlockedCommandValue(Handle<ControllerInput> signal,
                                    const DeviceEvent& event) {
   if (!signal || signal->getType() != ControllerSignalType::HYBRID) {
     return event.value;
@@ -52,7 +53,7 @@ DisableModifier::DisableModifier(toml::table& config, EngineInterface* e) {
   PLOG_VERBOSE << "constructing disable modifier";
   assert(config.contains("name"));
   assert(config.contains("type"));
-  TOMLUtils::checkValid(config, std::vector<std::string>{
+  TOMLUtils::checkValid(config, {
       "name", "description", "type", "groups", "applies_to", "begin_sequence", "finish_sequence",
       "filter", "while", "while_operation", "unlisted"});
 
@@ -88,12 +89,24 @@ DisableModifier::DisableModifier(toml::table& config, EngineInterface* e) {
   }
 
   condition_active_last = false;
-  blocked_command_values.clear();
+  blocked_command_values.assign(commands.size(), 0);
+  blocked_command_valid.assign(commands.size(), false);
+}
+
+void DisableModifier::recordBlocked(size_t slot, short value) {
+  blocked_command_values[slot] = value;
+  blocked_command_valid[slot] = true;
+  any_blocked = true;
+}
+
+void DisableModifier::clearBlocked() {
+  std::fill(blocked_command_valid.begin(), blocked_command_valid.end(), false);
+  any_blocked = false;
 }
 
 void DisableModifier::begin() {
   condition_active_last = inCondition();
-  blocked_command_values.clear();
+  clearBlocked();
   if (condition_active_last) {
     clampAppliedCommands();
   }
@@ -107,11 +120,12 @@ void DisableModifier::clampAppliedCommands() {
   if (applies_to_all) {
     return;
   }
-  for (auto& cmd : commands) {
+  for (size_t i = 0; i < commands.size(); ++i) {
+    auto& cmd = commands[i];
     if (!cmd) {
       continue;
     }
-    auto signal = cmd->getInput();
+    Handle<ControllerInput> signal = cmd->getInput();
     if (!signal) {
       continue;
     }
@@ -120,27 +134,24 @@ void DisableModifier::clampAppliedCommands() {
                            static_cast<uint8_t>(signal->getButtonType()), signal->getID()};
     const short filtered = getFilteredVal(current);
     if (filtered != current.value) {
-      blocked_command_values[cmd->getName()] = normalizeBlockedCommandValue(signal, current);
+      recordBlocked(i, normalizeBlockedCommandValue(signal, current));
       engine->setValue(cmd, filtered);
     }
   }
 }
 
 void DisableModifier::restoreBlockedCommands() {
-  if (applies_to_all || blocked_command_values.empty()) {
+  if (applies_to_all || !any_blocked) {
     return;
   }
-  for (auto& cmd : commands) {
-    if (!cmd || !cmd->getInput()) {
-      continue;
-    }
-    auto it = blocked_command_values.find(cmd->getName());
-    if (it == blocked_command_values.end()) {
+  for (size_t i = 0; i < commands.size(); ++i) {
+    auto& cmd = commands[i];
+    if (!cmd || !cmd->getInput() || !blocked_command_valid[i]) {
       continue;
     }
-    engine->setValue(cmd, it->second);
+    engine->setValue(cmd, blocked_command_values[i]);
   }
-  blocked_command_values.clear();
+  clearBlocked();
 }
 
 void DisableModifier::syncConditionState(const DeviceEvent* event) {
@@ -171,7 +182,7 @@ bool DisableModifier::tweak (DeviceEvent& event) {
   syncConditionState(&event);
 
   short new_val = event.value;
-  std::string cmd_name;
+  Handle<GameCommand> blocked_cmd;
   // If the condition test returns false do not block
   if (!condition_active_last) {
     return true;
@@ -180,19 +191,19 @@ bool DisableModifier::tweak (DeviceEvent& event) {
   if (applies_to_all) {
     new_val = getFilteredVal(event);
   } else {
-    for (auto& cmd : commands) {
+    for (size_t i = 0; i < commands.size(); ++i) {
+      auto& cmd = commands[i];
       if (engine->eventMatches(event, cmd)) {
-        blocked_command_values[cmd->getName()] =
-            normalizeBlockedCommandValue(cmd->getInput(), event);
+        recordBlocked(i, normalizeBlockedCommandValue(cmd->getInput(), event));
         new_val = getFilteredVal(event);
-        cmd_name = cmd->getName();
+        blocked_cmd = cmd;
         // Already matched, no need to keep looping
         break;
       }
     }
   }
   if (new_val != event.value) {
-    PLOG_DEBUG << "Blocking " << cmd_name << "(" << (int) event.type << "." << (int) event.id << ") value= " <<
+    PLOG_DEBUG << "Blocking " << (blocked_cmd ? blocked_cmd->getName() : "") << "(" << (int) event.type << "." << (int) event.id << ") value= " <<
       event.value << " set to " << new_val;
   }
   event.value = new_val;
@@ -19,7 +19,7 @@
  */
 #pragma once
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include <toml++/toml.h>
 
 #include "Modifier.hpp"
@@ -44,7 +44,16 @@ namespace Chaos {
      */
     DisableFilter filter;
     bool condition_active_last;
-    std::unordered_map<std::string, short> blocked_command_values;
+    /**
+     * Last intended value of each command in #commands that has been blocked, by position in the
+     * list. An entry is only meaningful if its bit in #blocked_command_valid is set.
+     */
+    std::vector<short> blocked_command_values;
+    std::vector<bool> blocked_command_valid;
+    bool any_blocked = false;
+
+    void recordBlocked(size_t slot, short value);
+    void clearBlocked();
 
     short getFilteredVal(DeviceEvent& event);
     void clampAppliedCommands();
@@ -22,19 +22,35 @@
 #include <vector>
 #include <memory>
 #include <list>
+#include <functional>
+#include <handle.hpp>
+#include <slot_array.hpp>
 #include "DeviceEvent.hpp"
+#include "ScheduledAction.hpp"
+#include "Sequence.hpp"
 
 // This gathers all the various data into a single facade run through the engine
 // Should we split this into multiple interfaces? Unless we need to speed things up, it's
 // probably better only to keep a pointer to a single facade (the engine)
 namespace Chaos {
   class Modifier;
+  class ModifierIndex;
   class GameCommand;
   class MenuItem;
   class ControllerInput;
   class SignalRemap;
   class GameCondition;
   class Sequence;
+
+  /**
+   * \brief Most modifiers that can be active at one time.
+   */
+  static constexpr size_t MAX_ACTIVE_MODIFIERS = 16;
+
+  /**
+   * \brief Fixed-capacity list of modifiers, in the order they were activated.
+   */
+  using ActiveModifiers = SlotArray<std::shared_ptr<Modifier>, MAX_ACTIVE_MODIFIERS>;
   
   class EngineInterface {
   public:
@@ -44,6 +60,15 @@ namespace Chaos {
      */
     virtual bool isPaused() = 0;
 
+    /**
+     * \brief Does the engine run the children of active parent modifiers itself?
+     *
+     * An engine that does places the children in its pipeline in place of their parent and
+     * updates them directly, so the parent must not forward to them. The default is false, and
+     * parents then pass updates and events on to their children.
+     */
+    virtual bool runsChildModifiers() { return false; }
+
     /**
      * \brief Inject a synthetic event back into the modifier pipeline.
      *
@@ -51,6 +76,39 @@ namespace Chaos {
      * \param sourceMod Modifier that originated the event.
      */
     virtual void fakePipelinedEvent(DeviceEvent& event, std::shared_ptr<Modifier> sourceMod) = 0;
+
+    /**
+     * \brief Inject a batch of synthetic events back into the modifier pipeline.
+     *
+     * \param events Events to inject. On return, holds only the events that survived the
+     * downstream modifiers, as they were sent to the controller.
+     * \param sourceMod Modifier that originated the events.
+     *
+     * The engine implementation passes the whole batch through the downstream modifiers in a
+     * single locked pass and applies the survivors to the controller atomically. The default
+     * injects the events one at a time.
+     */
+    virtual void fakePipelinedEvents(std::vector<DeviceEvent>& events, std::shared_ptr<Modifier> sourceMod) {
+      for (auto& event : events) {
+        fakePipelinedEvent(event, sourceMod);
+      }
+    }
+
+    /**
+     * \brief Play a sequence without blocking the caller.
+     *
+     * \param seq The sequence to send. Its events are copied, so the caller may reuse it.
+     * \param on_complete Invoked once the last event of the sequence has been sent.
+     *
+     * The engine plays the sequence on its sequence executor and runs the completion callback on
+     * the engine thread. The default sends the sequence synchronously and then invokes the callback.
+     */
+    virtual void playSequence(Sequence& seq, std::function<void()> on_complete = nullptr) {
+      seq.send();
+      if (on_complete) {
+        on_complete();
+      }
+    }
   
     // These functions access the controller
     /**
@@ -61,27 +119,95 @@ namespace Chaos {
     /**
      * \brief Test whether a raw event matches a game command in current conditions.
      */
-    virtual bool eventMatches(const DeviceEvent& event, std::shared_ptr<GameCommand> command) = 0;
+    virtual bool eventMatches(const DeviceEvent& event, Handle<GameCommand> command) = 0;
 
     /**
      * \brief Set a game command to its "off" state.
      */
-    virtual void setOff(std::shared_ptr<GameCommand> command) = 0;
+    virtual void setOff(Handle<GameCommand> command) = 0;
 
     /**
      * \brief Set a game command to its "on" state.
      */
-    virtual void setOn(std::shared_ptr<GameCommand> command) = 0 ;
+    virtual void setOn(Handle<GameCommand> command) = 0 ;
 
     /**
      * \brief Set a game command to an explicit numeric value.
      */
-    virtual void setValue(std::shared_ptr<GameCommand> command, short value) = 0 ;
+    virtual void setValue(Handle<GameCommand> command, short value) = 0 ;
+
+    /**
+     * \brief Queue a change to a game command to be made at a given time.
+     *
+     * The engine applies the change from its scheduler thread at the action's deadline, without
+     * waiting for the next tick, and holds it back while the engine is paused. Pending actions are
+     * cancelled when their source modifier finishes.
+     */
+    virtual void scheduleAction(const ScheduledAction& action) = 0;
+
+    /**
+     * \brief Drop every pending scheduled action from a modifier.
+     */
+    virtual void cancelScheduled(const Modifier* source) = 0;
+
+    /**
+     * \brief Schedule a setValue() call at an absolute time.
+     *
+     * \param when Clock time in nanoseconds
+     * \param command The command to set
+     * \param value The value to set it to
+     * \param source The modifier making the request
+     */
+    void scheduleValue(int64_t when, Handle<GameCommand> command, short value, const Modifier* source) {
+      scheduleAction(ScheduledAction{when, ScheduledAction::Kind::VALUE, value, command, source});
+    }
+
+    /**
+     * \brief Schedule a setOn() call at an absolute time.
+     */
+    void scheduleOn(int64_t when, Handle<GameCommand> command, const Modifier* source) {
+      scheduleAction(ScheduledAction{when, ScheduledAction::Kind::ON, 0, command, source});
+    }
+
+    /**
+     * \brief Schedule a setOff() call at an absolute time.
+     */
+    void scheduleOff(int64_t when, Handle<GameCommand> command, const Modifier* source) {
+      scheduleAction(ScheduledAction{when, ScheduledAction::Kind::OFF, 0, command, source});
+    }
+
+    /**
+     * \brief Make the change described by a scheduled action now.
+     */
+    void applyScheduled(const ScheduledAction& action) {
+      switch (action.kind) {
+      case ScheduledAction::Kind::VALUE:
+        setValue(action.command, action.value);
+        break;
+      case ScheduledAction::Kind::ON:
+        setOn(action.command);
+        break;
+      case ScheduledAction::Kind::OFF:
+        setOff(action.command);
+      }
+    }
 
     /**
      * \brief Apply an already-resolved raw event to controller output.
      */
     virtual void applyEvent(const DeviceEvent& event) = 0;
+
+    /**
+     * \brief Apply a batch of already-resolved raw events to controller output.
+     *
+     * The engine implementation applies the batch atomically. The default applies the events one
+     * at a time.
+     */
+    virtual void applyEvents(const std::vector<DeviceEvent>& events) {
+      for (const auto& event : events) {
+        applyEvent(event);
+      }
+    }
     
     // Functions to get modifier data
     /**
@@ -94,10 +220,18 @@ namespace Chaos {
      */
     virtual std::unordered_map<std::string, std::shared_ptr<Modifier>>& getModifierMap() = 0;
 
+    /**
+     * \brief Group and type index over the modifiers in getModifierMap().
+     *
+     * Engines that load their modifiers through a ModifierTable return its index. The default
+     * returns nullptr, and callers then build a temporary index from getModifierMap().
+     */
+    virtual const ModifierIndex* getModifierIndex() { return nullptr; }
+
     /**
      * \brief Access the currently active modifier list.
      */
-    virtual std::list<std::shared_ptr<Modifier>>& getActiveMods() = 0;
+    virtual ActiveModifiers& getActiveMods() = 0;
 
     // These functions access the menu system
     /**
@@ -0,0 +1,135 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <plog/Log.h>
+#include <clock.hpp>
+
+#include "EventScheduler.hpp"
+
+using namespace Chaos;
+
+// How long before a deadline to stop waiting on the condition variable and sleep on the clock
+// instead. Condition-variable waits can overshoot by far more than a clock_nanosleep.
+static constexpr int64_t SPIN_UP_NS = 1000000;
+
+EventScheduler::EventScheduler(Apply a, Hold h) : apply{std::move(a)}, hold{std::move(h)} {}
+
+EventScheduler::~EventScheduler() {
+  shutdown();
+}
+
+void EventScheduler::schedule(const ScheduledAction& action) {
+  bool earliest;
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    earliest = action.when < queue.nextDeadline();
+    queue.push(action);
+  }
+  if (earliest) {
+    queue_changed.notify_all();
+  }
+}
+
+void EventScheduler::cancel(const Modifier* source) {
+  std::lock_guard<std::mutex> applying(apply_mutex);
+  std::lock_guard<std::mutex> guard(queue_mutex);
+  size_t dropped = queue.cancel(source);
+  if (dropped) {
+    PLOG_DEBUG << "Cancelled " << dropped << " scheduled actions";
+  }
+}
+
+void EventScheduler::clear() {
+  std::lock_guard<std::mutex> applying(apply_mutex);
+  std::lock_guard<std::mutex> guard(queue_mutex);
+  queue.clear();
+}
+
+void EventScheduler::wake() {
+  {
+    // Taking the lock keeps the notification from falling between the thread's check of the
+    // hold and the start of its wait
+    std::lock_guard<std::mutex> guard(queue_mutex);
+  }
+  queue_changed.notify_all();
+}
+
+void EventScheduler::runDue(int64_t now) {
+  std::vector<ScheduledAction> ready;
+  std::lock_guard<std::mutex> applying(apply_mutex);
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    queue.popDue(now, ready);
+  }
+  for (const auto& action : ready) {
+    apply(action);
+  }
+}
+
+void EventScheduler::shutdown() {
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    stopping.store(true);
+    queue.clear();
+  }
+  queue_changed.notify_all();
+  WaitForInternalThreadToExit();
+}
+
+void EventScheduler::doAction() {
+  int64_t deadline;
+  {
+    std::unique_lock<std::mutex> guard(queue_mutex);
+    int64_t wait_ns = 50000000;
+    if (!Clock::isVirtual() && !hold()) {
+      wait_ns = std::min(wait_ns, queue.nextDeadline() - SPIN_UP_NS - Clock::now());
+    }
+    // Wake periodically so that a stop request or the end of a hold is noticed
+    if (wait_ns > 0) {
+      queue_changed.wait_for(guard, std::chrono::nanoseconds(wait_ns));
+    }
+    if (stopping.load() || Clock::isVirtual() || hold() || queue.empty()) {
+      return;
+    }
+    deadline = queue.nextDeadline();
+    if (deadline - Clock::now() > SPIN_UP_NS) {
+      // Woken early by a new action or a cancellation. Work out the wait again.
+      return;
+    }
+  }
+  Clock::sleepUntil(deadline);
+
+  // Apply under apply_mutex so that a modifier finishing or a game change cannot cancel actions
+  // that have already left the queue
+  std::lock_guard<std::mutex> applying(apply_mutex);
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    if (stopping.load() || hold()) {
+      return;
+    }
+    // Cancellations while we slept are honoured, since we pop only now
+    queue.popDue(Clock::now(), due);
+  }
+  for (const auto& action : due) {
+    apply(action);
+  }
+  due.clear();
+}
@@ -0,0 +1,110 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <thread.hpp>
+
+#include "ScheduledAction.hpp"
+
+namespace Chaos {
+
+  /**
+   * \brief Applies scheduled command changes at their deadlines on a thread of its own.
+   *
+   * Engine ticks come roughly every half millisecond plus whatever the tick itself costs, so a
+   * modifier that toggles a command from update() can only do so on a tick boundary. Modifiers
+   * that know their timeline in advance schedule the changes here instead. The thread sleeps on a
+   * condition variable until shortly before the earliest deadline and then sleeps on the
+   * monotonic clock for the remainder, so changes land within the resolution of the system timer.
+   *
+   * While the hold predicate is true (the engine is paused), due actions are kept rather than
+   * applied. On a virtual clock the thread stays idle and the engine calls runDue() from its tick
+   * instead, keeping replays repeatable.
+   */
+  class EventScheduler : public Thread {
+  public:
+    using Apply = std::function<void(const ScheduledAction&)>;
+    using Hold = std::function<bool()>;
+
+    /**
+     * \brief Construct a scheduler.
+     *
+     * \param apply Makes the change described by an action. Called with the apply lock held, so it
+     *              must not call back into the scheduler.
+     * \param hold Returns true while due actions should be held back.
+     */
+    EventScheduler(Apply apply, Hold hold);
+
+    ~EventScheduler();
+
+    void schedule(const ScheduledAction& action);
+
+    /**
+     * \brief Drop every pending action scheduled by a modifier.
+     *
+     * If actions are being applied, waits for them to finish, so no action from the modifier is
+     * applied after this returns.
+     */
+    void cancel(const Modifier* source);
+
+    /**
+     * \brief Drop every pending action.
+     *
+     * Like cancel(), waits for any actions being applied.
+     */
+    void clear();
+
+    /**
+     * \brief Wake the scheduler thread so it checks the hold predicate again.
+     *
+     * Call when the hold is lifted, so held actions are applied at once rather than on the
+     * thread's next periodic wake.
+     */
+    void wake();
+
+    /**
+     * \brief Apply the actions due at a given time on the caller's thread.
+     */
+    void runDue(int64_t now);
+
+    /**
+     * \brief Stop the scheduler thread. Pending actions are discarded.
+     */
+    void shutdown();
+
+  private:
+    Apply apply;
+    Hold hold;
+    // Held while due actions are popped and applied. Taken before queue_mutex.
+    std::mutex apply_mutex;
+    std::mutex queue_mutex;
+    std::condition_variable queue_changed;
+    ScheduledActionQueue queue;
+    std::vector<ScheduledAction> due;
+    std::atomic<bool> stopping{false};
+
+    void doAction() override;
+  };
+
+};
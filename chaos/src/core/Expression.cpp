@@ -0,0 +1,348 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+#include "Expression.hpp"
+
+using namespace Chaos;
+
+// Recursive-descent parser. Builds a tree, folding constant subtrees as it goes, and then
+// flattens the tree to bytecode.
+class Expression::Compiler {
+public:
+  Compiler(const std::string& t, const Resolver& r) : text{t}, resolve{r} {}
+
+  std::vector<Instruction> compile() {
+    int root = parseSum();
+    skipSpace();
+    if (pos < text.size()) {
+      fail(std::string("unexpected '") + text[pos] + "'");
+    }
+    std::vector<Instruction> code;
+    size_t depth = 0;
+    size_t max_depth = 0;
+    emit(root, code, depth, max_depth);
+    if (max_depth > MAX_STACK) {
+      throw std::runtime_error("Formula '" + text + "' is too deeply nested");
+    }
+    return code;
+  }
+
+private:
+  struct Node {
+    Op op;
+    uint32_t index;
+    double value;
+    std::array<int, 3> args;
+    int arity;
+    size_t height;
+  };
+
+  const std::string& text;
+  const Resolver& resolve;
+  size_t pos = 0;
+  size_t nesting = 0;
+  std::vector<Node> nodes;
+
+  [[noreturn]] void fail(const std::string& msg) {
+    throw std::runtime_error("Formula '" + text + "': " + msg + " at position " + std::to_string(pos));
+  }
+
+  void skipSpace() {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+      ++pos;
+    }
+  }
+
+  bool accept(char c) {
+    skipSpace();
+    if (pos < text.size() && text[pos] == c) {
+      ++pos;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c) {
+    if (!accept(c)) {
+      fail(std::string("expected '") + c + "'");
+    }
+  }
+
+  int constant(double value) {
+    nodes.push_back(Node{Op::CONST, 0, value, {-1, -1, -1}, 0, 1});
+    return static_cast<int>(nodes.size() - 1);
+  }
+
+  // Add an operator node, or a constant if all of its operands are constants
+  int make(Op op, int arity, int a, int b = -1, int c = -1) {
+    Node node{op, 0, 0.0, {a, b, c}, arity, 1};
+    bool folds = true;
+    std::array<double, 3> operands{};
+    for (int i = 0; i < arity; ++i) {
+      folds &= nodes[node.args[i]].op == Op::CONST;
+      operands[i] = nodes[node.args[i]].value;
+      node.height = std::max(node.height, nodes[node.args[i]].height + 1);
+    }
+    if (folds) {
+      Expression folded;
+      for (int i = 0; i < arity; ++i) {
+        folded.code.push_back(Instruction{Op::CONST, 0, operands[i]});
+      }
+      folded.code.push_back(Instruction{op, 0, 0.0});
+      return constant(folded.evaluate(nullptr));
+    }
+    // A long chain of operators builds a tall tree without nesting, and emit() recurses over it
+    if (node.height > MAX_NESTING) {
+      fail("formula is too long");
+    }
+    nodes.push_back(node);
+    return static_cast<int>(nodes.size() - 1);
+  }
+
+  int parseSum() {
+    int left = parseProduct();
+    for (;;) {
+      if (accept('+')) {
+        left = make(Op::ADD, 2, left, parseProduct());
+      } else if (accept('-')) {
+        left = make(Op::SUB, 2, left, parseProduct());
+      } else {
+        return left;
+      }
+    }
+  }
+
+  int parseProduct() {
+    int left = parseUnary();
+    for (;;) {
+      if (accept('*')) {
+        left = make(Op::MUL, 2, left, parseUnary());
+      } else if (accept('/')) {
+        left = make(Op::DIV, 2, left, parseUnary());
+      } else {
+        return left;
+      }
+    }
+  }
+
+  // Every recursive path in the grammar passes through here, so counting nesting here bounds the
+  // parser's recursion
+  int parseUnary() {
+    if (++nesting > MAX_NESTING) {
+      fail("formula is too deeply nested");
+    }
+    int operand;
+    if (accept('-')) {
+      operand = make(Op::NEG, 1, parseUnary());
+    } else if (accept('+')) {
+      operand = parseUnary();
+    } else {
+      operand = parsePrimary();
+    }
+    --nesting;
+    return operand;
+  }
+
+  int parsePrimary() {
+    skipSpace();
+    if (pos >= text.size()) {
+      fail("unexpected end");
+    }
+    if (accept('(')) {
+      int inner = parseSum();
+      expect(')');
+      return inner;
+    }
+    const char c = text[pos];
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+      size_t used = 0;
+      double value;
+      try {
+        value = std::stod(text.substr(pos), &used);
+      } catch (const std::exception&) {
+        fail("malformed number");
+      }
+      pos += used;
+      return constant(value);
+    }
+    if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+      const size_t start = pos;
+      while (pos < text.size() &&
+             (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')) {
+        ++pos;
+      }
+      const std::string name = text.substr(start, pos - start);
+      if (accept('(')) {
+        return parseCall(name);
+      }
+      if (name == "pi") {
+        return constant(M_PI);
+      }
+      int index = resolve ? resolve(name) : -1;
+      if (index < 0) {
+        pos = start;
+        fail("unknown variable '" + name + "'");
+      }
+      nodes.push_back(Node{Op::LOAD, static_cast<uint32_t>(index), 0.0, {-1, -1, -1}, 0, 1});
+      return static_cast<int>(nodes.size() - 1);
+    }
+    fail(std::string("unexpected '") + c + "'");
+  }
+
+  int parseCall(const std::string& name) {
+    struct Function {
+      const char* name;
+      Op op;
+      int arity;
+    };
+    static const Function functions[] = {
+      {"sin", Op::SIN, 1}, {"cos", Op::COS, 1}, {"abs", Op::ABS, 1}, {"noise", Op::NOISE, 1},
+      {"min", Op::MIN, 2}, {"max", Op::MAX, 2}, {"clamp", Op::CLAMP, 3}
+    };
+    for (const Function& f : functions) {
+      if (name == f.name) {
+        std::array<int, 3> args{-1, -1, -1};
+        for (int i = 0; i < f.arity; ++i) {
+          if (i > 0) {
+            expect(',');
+          }
+          args[i] = parseSum();
+        }
+        expect(')');
+        return make(f.op, f.arity, args[0], args[1], args[2]);
+      }
+    }
+    fail("unknown function '" + name + "'");
+  }
+
+  void emit(int n, std::vector<Instruction>& code, size_t& depth, size_t& max_depth) {
+    const Node& node = nodes[n];
+    for (int i = 0; i < node.arity; ++i) {
+      emit(node.args[i], code, depth, max_depth);
+    }
+    code.push_back(Instruction{node.op, node.index, node.value});
+    if (node.op == Op::CONST || node.op == Op::LOAD) {
+      max_depth = std::max(max_depth, ++depth);
+    } else {
+      depth -= node.arity - 1;
+    }
+  }
+};
+
+Expression::Expression(const std::string& text, const Resolver& resolve) {
+  code = Compiler(text, resolve).compile();
+}
+
+bool Expression::isConstant() const {
+  return code.size() == 1 && code[0].op == Op::CONST;
+}
+
+double Expression::evaluate(const double* variables) const {
+  std::array<double, MAX_STACK> stack;
+  size_t top = 0;
+  for (const Instruction& in : code) {
+    switch (in.op) {
+    case Op::CONST:
+      stack[top++] = in.value;
+      break;
+    case Op::LOAD:
+      stack[top++] = variables[in.index];
+      break;
+    case Op::NEG:
+      stack[top - 1] = -stack[top - 1];
+      break;
+    case Op::ADD:
+      --top;
+      stack[top - 1] += stack[top];
+      break;
+    case Op::SUB:
+      --top;
+      stack[top - 1] -= stack[top];
+      break;
+    case Op::MUL:
+      --top;
+      stack[top - 1] *= stack[top];
+      break;
+    case Op::DIV:
+      // Dividing by zero gives zero rather than an infinity that would pin the axis
+      --top;
+      stack[top - 1] = (stack[top] == 0.0) ? 0.0 : stack[top - 1] / stack[top];
+      break;
+    case Op::SIN:
+      stack[top - 1] = std::sin(stack[top - 1]);
+      break;
+    case Op::COS:
+      stack[top - 1] = std::cos(stack[top - 1]);
+      break;
+    case Op::ABS:
+      stack[top - 1] = std::fabs(stack[top - 1]);
+      break;
+    case Op::MIN:
+      --top;
+      stack[top - 1] = std::min(stack[top - 1], stack[top]);
+      break;
+    case Op::MAX:
+      --top;
+      stack[top - 1] = std::max(stack[top - 1], stack[top]);
+      break;
+    case Op::CLAMP:
+      top -= 2;
+      stack[top - 1] = std::max(stack[top], std::min(stack[top - 1], stack[top + 1]));
+      break;
+    case Op::NOISE:
+      stack[top - 1] = noise(stack[top - 1]);
+      break;
+    }
+  }
+  return top ? stack[0] : 0.0;
+}
+
+namespace {
+  // Pseudo-random value between -1 and 1 for an integer lattice point
+  double lattice(int64_t n) {
+    uint32_t h = static_cast<uint32_t>(n) * 0x9E3779B1u;
+    h ^= h >> 15;
+    h *= 0x85EBCA77u;
+    h ^= h >> 13;
+    h *= 0xC2B2AE3Du;
+    h ^= h >> 16;
+    return h / 2147483647.5 - 1.0;
+  }
+}
+
+double Expression::noise(double x) {
+  if (!std::isfinite(x)) {
+    return 0.0;
+  }
+  // The lattice repeats every 2^32 points, so reducing x keeps the value and keeps the lattice
+  // coordinates well inside the range of int64_t
+  x = std::fmod(x, 4294967296.0);
+  const double base = std::floor(x);
+  const double f = x - base;
+  // Smoothstep between neighbouring lattice values
+  const double u = f * f * (3.0 - 2.0 * f);
+  const int64_t n = static_cast<int64_t>(base);
+  return lattice(n) + (lattice(n + 1) - lattice(n)) * u;
+}
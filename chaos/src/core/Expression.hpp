@@ -0,0 +1,119 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Chaos {
+
+  /**
+   * \brief Small arithmetic expression compiled to stack-machine bytecode.
+   *
+   * Expressions are written in ordinary infix notation:
+   *
+   * - numbers, and the constant `pi`
+   * - variables, whose names are resolved by the caller when the expression is compiled
+   * - the operators `+`, `-`, `*`, `/`, unary minus, and parentheses
+   * - the functions `sin(x)`, `cos(x)`, `abs(x)`, `min(a, b)`, `max(a, b)`,
+   *   `clamp(x, lo, hi)`, and `noise(x)`
+   *
+   * `noise(x)` is smooth one-dimensional value noise between -1 and 1. It is a fixed function of
+   * x, so a replay produces the same values.
+   *
+   * Parsing happens once, when the configuration is loaded. Any subexpression whose operands are
+   * all constants is folded into a single constant. Evaluation runs the bytecode on a fixed-size
+   * stack and never allocates.
+   */
+  class Expression {
+  public:
+    /**
+     * \brief Map a variable name to its index in the array passed to evaluate().
+     *
+     * Return a negative number if the name is unknown.
+     */
+    using Resolver = std::function<int(const std::string& name)>;
+
+    /**
+     * \brief Deepest evaluation stack an expression may need.
+     */
+    static const size_t MAX_STACK = 32;
+
+    /**
+     * \brief Deepest nesting of operators, parentheses and function calls the parser accepts.
+     */
+    static const size_t MAX_NESTING = 256;
+
+    Expression() = default;
+
+    /**
+     * \brief Compile an expression.
+     *
+     * \param text Source of the expression
+     * \param resolve Lookup for variable names
+     *
+     * Throws std::runtime_error if the expression is malformed or names an unknown variable or
+     * function.
+     */
+    Expression(const std::string& text, const Resolver& resolve);
+
+    /**
+     * \brief Evaluate the expression.
+     *
+     * \param variables Values of the variables, indexed as returned by the resolver
+     */
+    double evaluate(const double* variables) const;
+
+    /**
+     * \brief Did the whole expression fold to a single constant?
+     */
+    bool isConstant() const;
+
+    /**
+     * \brief Number of bytecode instructions.
+     */
+    size_t size() const { return code.size(); }
+
+    /**
+     * \brief Smooth value noise between -1 and 1.
+     *
+     * Gives 0 for NaN and infinite inputs.
+     */
+    static double noise(double x);
+
+  private:
+    enum class Op : uint8_t {
+      CONST, LOAD, NEG, ADD, SUB, MUL, DIV, SIN, COS, ABS, MIN, MAX, CLAMP, NOISE
+    };
+
+    struct Instruction {
+      Op op;
+      uint32_t index;
+      double value;
+    };
+
+    class Compiler;
+
+    std::vector<Instruction> code;
+  };
+
+};
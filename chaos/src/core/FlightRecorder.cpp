@@ -0,0 +1,195 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <plog/Log.h>
+#include <clock.hpp>
+
+#include "FlightRecorder.hpp"
+
+using namespace Chaos;
+
+namespace {
+  const char FILE_MAGIC[8] = {'T', 'C', 'C', 'F', 'R', 'E', 'C', '\0'};
+
+  template <typename T>
+  void writeValue(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+}
+
+FlightRecorder::FlightRecorder() : ring{std::make_unique<std::array<Slot, CAPACITY>>()} {}
+
+int64_t FlightRecorder::now() {
+  return Clock::now();
+}
+
+void FlightRecorder::record(uint32_t serial, Stage stage, uint16_t modifier,
+                            const DeviceEvent& before, const DeviceEvent& after, bool valid) {
+  if (!enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  Decision decision = Decision::PASS;
+  if (!valid) {
+    decision = Decision::DROP;
+  } else if (before.value != after.value || before.type != after.type || before.id != after.id) {
+    decision = Decision::REWRITE;
+  }
+
+  uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = (*ring)[index & (CAPACITY - 1)];
+  uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.record = Record{now(), serial, modifier, stage, decision, before.value, after.value,
+                       before.type, before.id, after.type, after.id};
+  slot.sequence.store(seq + 2, std::memory_order_release);
+}
+
+void FlightRecorder::setModifierNames(const std::vector<std::string>& names) {
+  std::lock_guard<std::mutex> guard(names_mutex);
+  modifier_names = names;
+  first_valid.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+std::vector<FlightRecorder::Record> FlightRecorder::snapshot(double seconds) const {
+  std::vector<Record> records;
+  uint64_t end = head.load(std::memory_order_acquire);
+  uint64_t begin = (end > CAPACITY) ? end - CAPACITY : 0;
+  begin = std::max(begin, first_valid.load(std::memory_order_acquire));
+  int64_t cutoff = (seconds > 0) ? now() - (int64_t) (seconds * 1e9) : INT64_MIN;
+
+  records.reserve(end - begin);
+  for (uint64_t i = begin; i < end; ++i) {
+    const Slot& slot = (*ring)[i & (CAPACITY - 1)];
+    uint32_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+      continue;
+    }
+    Record copy = slot.record;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != before || copy.time_ns < cutoff) {
+      continue;
+    }
+    records.push_back(copy);
+  }
+  // Concurrent writers can finish slightly out of order
+  std::stable_sort(records.begin(), records.end(),
+                   [](const Record& a, const Record& b) { return a.time_ns < b.time_ns; });
+  return records;
+}
+
+long FlightRecorder::dump(const std::string& path, double seconds) const {
+  std::vector<Record> records = snapshot(seconds);
+  std::vector<std::string> names;
+  {
+    std::lock_guard<std::mutex> guard(names_mutex);
+    names = modifier_names;
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    PLOG_ERROR << "Cannot open '" << path << "' to write the flight recording";
+    return -1;
+  }
+  out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+  writeValue<uint16_t>(out, FILE_VERSION);
+  writeValue<uint16_t>(out, sizeof(Record));
+  writeValue<uint32_t>(out, names.size());
+  for (const auto& name : names) {
+    uint16_t len = (uint16_t) std::min<size_t>(name.size(), UINT16_MAX);
+    writeValue<uint16_t>(out, len);
+    out.write(name.data(), len);
+  }
+  writeValue<uint64_t>(out, records.size());
+  out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+  if (!out) {
+    PLOG_ERROR << "Error writing the flight recording to '" << path << "'";
+    return -1;
+  }
+  PLOG_INFO << "Wrote " << records.size() << " flight recorder entries to " << path;
+  return (long) records.size();
+}
+
+bool FlightRecorder::load(std::istream& in, std::vector<std::string>& names,
+                          std::vector<Record>& records) {
+  char magic[sizeof(FILE_MAGIC)];
+  uint16_t version;
+  uint16_t record_size;
+  uint32_t num_names;
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0 ||
+      !readValue(in, version) || version != FILE_VERSION ||
+      !readValue(in, record_size) || record_size != sizeof(Record) ||
+      !readValue(in, num_names)) {
+    return false;
+  }
+  names.clear();
+  for (uint32_t i = 0; i < num_names; ++i) {
+    uint16_t len;
+    if (!readValue(in, len)) {
+      return false;
+    }
+    std::string name(len, '\0');
+    if (!in.read(name.data(), len)) {
+      return false;
+    }
+    names.push_back(std::move(name));
+  }
+  uint64_t count;
+  if (!readValue(in, count) || count > CAPACITY) {
+    return false;
+  }
+  records.resize(count);
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(records.data()), count * sizeof(Record)));
+}
+
+const char* FlightRecorder::stageName(Stage stage) {
+  switch (stage) {
+  case Stage::INPUT:
+    return "input";
+  case Stage::INJECT:
+    return "inject";
+  case Stage::REMAP:
+    return "remap";
+  case Stage::TWEAK:
+    return "tweak";
+  case Stage::OUTPUT:
+    return "output";
+  }
+  return "unknown";
+}
+
+const char* FlightRecorder::decisionName(Decision decision) {
+  switch (decision) {
+  case Decision::PASS:
+    return "pass";
+  case Decision::DROP:
+    return "drop";
+  case Decision::REWRITE:
+    return "rewrite";
+  }
+  return "unknown";
+}
@@ -0,0 +1,199 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DeviceEvent.hpp"
+
+namespace Chaos {
+
+  /**
+   * \brief Fixed-size record of what happened to each event in the modifier pipeline.
+   *
+   * Every event that enters the pipeline gets a serial number. The recorder stores the incoming
+   * event, the decision each active modifier made about it (pass, drop, or rewrite), and the event
+   * that finally went to the console. Records are written into a preallocated ring with a single
+   * atomic increment and no locks, so recording can stay on during normal play. When the ring is
+   * full, the oldest records are overwritten.
+   *
+   * The contents can be dumped to a compact binary file, which validate_mod can decode with its
+   * --decode-recording option.
+   */
+  class FlightRecorder {
+  public:
+    /**
+     * \brief Where in the pipeline a record was taken.
+     */
+    enum class Stage : uint8_t {
+      INPUT,   ///< Event as received from the controller
+      INJECT,  ///< Event injected by a modifier; the modifier field names the source
+      REMAP,   ///< Decision of a modifier's remap pass
+      TWEAK,   ///< Decision of a modifier's tweak pass
+      OUTPUT   ///< Event as sent to the console (or dropped)
+    };
+
+    /**
+     * \brief What a modifier did with the event.
+     */
+    enum class Decision : uint8_t {
+      PASS,    ///< Event left unchanged
+      DROP,    ///< Event blocked
+      REWRITE  ///< Event changed
+    };
+
+    /**
+     * \brief One entry of the ring. Stored and written to disk as-is.
+     */
+    struct Record {
+      int64_t time_ns;
+      uint32_t serial;
+      uint16_t modifier;
+      Stage stage;
+      Decision decision;
+      short in_value;
+      short out_value;
+      uint8_t in_type;
+      uint8_t in_id;
+      uint8_t out_type;
+      uint8_t out_id;
+    };
+    static_assert(sizeof(Record) == 24, "FlightRecorder::Record must stay packed");
+
+    /**
+     * \brief Modifier field value for records that do not belong to a modifier.
+     */
+    static const uint16_t NO_MODIFIER = 0xFFFF;
+
+    /**
+     * \brief Number of records held in the ring. Must be a power of two.
+     */
+    static const size_t CAPACITY = 1 << 17;
+
+    /**
+     * \brief Version of the on-disk format.
+     */
+    static const uint16_t FILE_VERSION = 1;
+
+    FlightRecorder();
+
+    /**
+     * \brief Turn recording on or off.
+     */
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    /**
+     * \brief Is the recorder currently recording?
+     */
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Reserve a serial number for a new event entering the pipeline.
+     */
+    uint32_t nextSerial() { return next_serial.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * \brief Record a stage of an event's trip through the pipeline.
+     *
+     * \param serial Serial number returned by nextSerial()
+     * \param stage Pipeline stage
+     * \param modifier Table index of the modifier responsible, or NO_MODIFIER
+     * \param before The event before this stage
+     * \param after The event after this stage
+     * \param valid False if this stage dropped the event
+     */
+    void record(uint32_t serial, Stage stage, uint16_t modifier,
+                const DeviceEvent& before, const DeviceEvent& after, bool valid = true);
+
+    /**
+     * \brief Set the names used to label the modifier field of records in a dump.
+     *
+     * Names are indexed by Modifier::getTableIndex(). Changing the names clears the ring, since
+     * older records refer to the previous table.
+     */
+    void setModifierNames(const std::vector<std::string>& names);
+
+    /**
+     * \brief Copy the records taken within the last few seconds, oldest first.
+     *
+     * \param seconds How far back to look. Zero or less returns everything in the ring.
+     */
+    std::vector<Record> snapshot(double seconds) const;
+
+    /**
+     * \brief Write the records taken within the last few seconds to a binary file.
+     *
+     * \param path File to write
+     * \param seconds How far back to look. Zero or less writes everything in the ring.
+     * \return The number of records written, or -1 if the file could not be written.
+     */
+    long dump(const std::string& path, double seconds) const;
+
+    /**
+     * \brief Read a file written by dump().
+     *
+     * \param in Stream to read
+     * \param names Receives the modifier names
+     * \param records Receives the records
+     * \return false if the stream is not a recording in a format we understand
+     */
+    static bool load(std::istream& in, std::vector<std::string>& names, std::vector<Record>& records);
+
+    /**
+     * \brief Get the current time in the clock used to stamp records.
+     */
+    static int64_t now();
+
+    /**
+     * \brief Human-readable name of a stage.
+     */
+    static const char* stageName(Stage stage);
+
+    /**
+     * \brief Human-readable name of a decision.
+     */
+    static const char* decisionName(Decision decision);
+
+  private:
+    // A writer bumps the slot's sequence number to an odd value while it copies the record in and
+    // back to an even value when done, so a reader can detect and skip torn entries.
+    struct Slot {
+      std::atomic<uint32_t> sequence{0};
+      Record record;
+    };
+
+    std::unique_ptr<std::array<Slot, CAPACITY>> ring;
+    std::atomic<uint64_t> head{0};
+    // Index of the first record that belongs to the current modifier table
+    std::atomic<uint64_t> first_valid{0};
+    std::atomic<uint32_t> next_serial{0};
+    std::atomic<bool> enabled{true};
+
+    mutable std::mutex names_mutex;
+    std::vector<std::string> modifier_names;
+  };
+
+};
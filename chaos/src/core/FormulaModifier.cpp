@@ -71,9 +71,9 @@ const std::string FormulaModifier::mod_type = "formula";
 
   FormulaModifier::FormulaModifier(toml::table& config, EngineInterface* e) {
 
-  TOMLUtils::checkValid(config, std::vector<std::string>{
+  TOMLUtils::checkValid(config, {
       "name", "description", "type", "groups", "applies_to", "begin_sequence", "finish_sequence",
-      "while", "while_operation", "formula_type", "amplitude", "period_length",
+      "while", "while_operation", "formula", "formula_type", "amplitude", "period_length",
       "range", "direction", "unlisted"});
   initialize(config, e);
 
@@ -82,10 +82,14 @@ const std::string FormulaModifier::mod_type = "formula";
   }
 
   std::optional<std::string> formula = config["formula_type"].value<std::string>();
-  if (!formula) {
+  if (config.contains("formula")) {
+    if (formula) {
+      throw std::runtime_error("Use either 'formula' or 'formula_type', not both");
+    }
+    formula_type = FormulaTypes::EXPRESSION;
+  } else if (!formula) {
     throw std::runtime_error("Missing required formula_type key");
-  }
-  if (*formula == "circle") {
+  } else if (*formula == "circle") {
     formula_type = FormulaTypes::CIRCLE;
   } else if (*formula == "eight_curve") {
     formula_type = FormulaTypes::EIGHT_CURVE;
@@ -129,26 +133,86 @@ const std::string FormulaModifier::mod_type = "formula";
   }
   amplitude *= JOYSTICK_MAX;
 
-  period_length = config["period_length"].value_or(1.0);
+  double period_length = config["period_length"].value_or(1.0);
   if (period_length <= 0.0) {
     PLOG_WARNING << "Period must be a positive number. Setting to 1 second.";
     period_length = 1.0;
   }
-  period_length = 2.0 * M_PI / period_length;
+  frequency = 1.0 / period_length;
+  waveform = Waveform(formula_type, amplitude, commands.size());
+  if (formula_type == FormulaTypes::EXPRESSION) {
+    compileExpressions(config);
+  }
 }
 
-void FormulaModifier::begin() {
-  command_value.clear();
-  for (auto& cmd : commands) {
-    command_value[cmd] = cmd->getState(true);
+void FormulaModifier::compileExpressions(toml::table& config) {
+  std::vector<std::string> sources;
+  if (std::optional<std::string> single = config["formula"].value<std::string>()) {
+    sources.assign(commands.size(), *single);
+  } else if (const toml::array* list = config["formula"].as_array()) {
+    for (const auto& node : *list) {
+      std::optional<std::string> source = node.value<std::string>();
+      if (!source) {
+        throw std::runtime_error("'formula' must be a string or an array of strings");
+      }
+      sources.push_back(*source);
+    }
+    if (sources.size() != commands.size()) {
+      throw std::runtime_error("'formula' must hold one expression for each command in applies_to");
+    }
+  } else {
+    throw std::runtime_error("'formula' must be a string or an array of strings");
+  }
+
+  Expression::Resolver resolve = [this](const std::string& name) -> int {
+    if (name == "t") {
+      return VAR_T;
+    }
+    if (name == "time") {
+      return VAR_TIME;
+    }
+    if (name == "i") {
+      return VAR_I;
+    }
+    if (name == "value") {
+      return VAR_VALUE;
+    }
+    std::shared_ptr<ControllerInput> input = engine->getInput(name);
+    if (!input) {
+      return -1;
+    }
+    auto it = std::find(expression_inputs.begin(), expression_inputs.end(), input);
+    if (it == expression_inputs.end()) {
+      expression_inputs.push_back(input);
+      it = expression_inputs.end() - 1;
+    }
+    return VAR_FIRST_INPUT + static_cast<int>(it - expression_inputs.begin());
+  };
+  for (const std::string& source : sources) {
+    expressions.emplace_back(source, resolve);
   }
-  command_offset.clear();
-  for (auto& cmd : commands) {
-    command_offset[cmd] = 0;
+  expression_vars.assign(VAR_FIRST_INPUT + expression_inputs.size(), 0.0);
+}
+
+int FormulaModifier::expressionOffset(size_t slot) {
+  expression_vars[VAR_I] = static_cast<double>(slot);
+  expression_vars[VAR_VALUE] = static_cast<double>(command_value[slot]) / JOYSTICK_MAX;
+  const double offset = amplitude * expressions[slot].evaluate(expression_vars.data());
+  // Keep wild results in a range that converts safely; the event value is clamped afterwards
+  constexpr double limit = JOYSTICK_MAX - JOYSTICK_MIN;
+  return std::isnan(offset) ? 0 : static_cast<int>(std::clamp(offset, -limit, limit));
+}
+
+void FormulaModifier::begin() {
+  command_value.resize(commands.size());
+  for (size_t i = 0; i < commands.size(); ++i) {
+    command_value[i] = commands[i]->getState(true);
   }
+  command_offset.assign(commands.size(), 0);
   condition_active_last = inCondition();
+  pending_events.reserve(commands.size());
 
-  command_fixed_offset.clear();
+  command_fixed_offset.assign(commands.size(), 0);
   if (formula_type == FormulaTypes::RANDOM_OFFSET) {
     Random rng;
     const double selected_offset = chooseFromInterval(rng, {range_min, range_max});
@@ -158,7 +222,6 @@ void FormulaModifier::begin() {
     const double selected_direction_radians = selected_direction_degrees * M_PI / 180.0;
 
     for (size_t i = 0; i < commands.size(); ++i) {
-      const auto& cmd = commands[i];
       int offset = static_cast<int>(std::lround(selected_offset));
 
       if (has_direction) {
@@ -168,85 +231,92 @@ void FormulaModifier::begin() {
             : selected_offset * std::sin(selected_direction_radians);
         offset = static_cast<int>(std::lround(component));
       }
-      command_fixed_offset[cmd] = offset;
+      command_fixed_offset[i] = offset;
     }
   }
 }
 
+void FormulaModifier::restoreCommandValues() {
+  DeviceEvent event{};
+  pending_events.clear();
+  for (size_t i = 0; i < commands.size(); ++i) {
+    event.id = commands[i]->getInput()->getID();
+    event.type = commands[i]->getInput()->getButtonType();
+    event.value = command_value[i];
+    pending_events.push_back(event);
+  }
+  engine->fakePipelinedEvents(pending_events, getptr());
+}
+
 void FormulaModifier::update() {
-  DeviceEvent event;
+  DeviceEvent event{};
   const bool condition_active = inCondition();
 
   if (!condition_active) {
     if (condition_active_last) {
       // Restore baseline values once when while-condition deactivates.
-      for (auto& cmd : commands) {
-        event.id = cmd->getInput()->getID();
-        event.type = cmd->getInput()->getButtonType();
-        event.value = command_value[cmd];
-        engine->fakePipelinedEvent(event, getptr());
-      }
-    }
-    for (auto& cmd : commands) {
-      command_offset[cmd] = 0;
+      restoreCommandValues();
     }
+    std::fill(command_offset.begin(), command_offset.end(), 0);
     condition_active_last = false;
     return;
   }
 
   event.type = TYPE_AXIS;
-  double t = timer.runningTime() * period_length;
-  int i = 0;
-
-  for (auto& cmd : commands) {
-    if (formula_type == FormulaTypes::RANDOM_OFFSET) {
-      command_offset[cmd] = command_fixed_offset[cmd];
-    } else {
-      const bool first_in_pair = ((i % 2) == 0);
-      switch (formula_type) {
-        case FormulaTypes::CIRCLE:
-          // Apply paired components in-order so [A, B, A, B, ...] maps consistently.
-          command_offset[cmd] = first_in_pair
-              ? static_cast<int>(amplitude * std::sin(t))
-              : static_cast<int>(amplitude * std::cos(t));
-          break;
-        case FormulaTypes::EIGHT_CURVE:
-          command_offset[cmd] = static_cast<int>(amplitude * std::sin(4.0*(i+1)*(t+1.6)));
-          break;
-        case FormulaTypes::JANKY:
-          command_offset[cmd] = static_cast<int>(amplitude * (std::cos(t+4.0*i) + std::cos(2.0*t)/2.0) *
-                                       std::sin((t+4.0*i)/5.0)/2.0);
-          break;
-        case FormulaTypes::RANDOM_OFFSET:
-          break;
+  const Waveform::Phase phase = Waveform::phase(timer.runningTime() * frequency);
+  pending_events.clear();
+
+  if (formula_type == FormulaTypes::EXPRESSION) {
+    expression_vars[VAR_T] = timer.runningTime() * frequency * 2.0 * M_PI;
+    expression_vars[VAR_TIME] = timer.runningTime();
+    for (size_t k = 0; k < expression_inputs.size(); ++k) {
+      ControllerInput& input = *expression_inputs[k];
+      double state;
+      if (input.getType() == ControllerSignalType::HYBRID) {
+        // Triggers read how far they are pulled, from 0 to 1
+        state = engine->getState(input.getHybridAxis(), TYPE_AXIS) - JOYSTICK_MIN;
+        state /= JOYSTICK_MAX - JOYSTICK_MIN;
+      } else if (input.getButtonType() == TYPE_AXIS) {
+        state = engine->getState(input.getID(), TYPE_AXIS) / static_cast<double>(JOYSTICK_MAX);
+      } else {
+        state = engine->getState(input.getID(), TYPE_BUTTON);
       }
+      expression_vars[VAR_FIRST_INPUT + k] = state;
+    }
+  }
+
+  for (size_t i = 0; i < commands.size(); ++i) {
+    // Paired components are applied in order so [A, B, A, B, ...] maps consistently.
+    switch (formula_type) {
+    case FormulaTypes::RANDOM_OFFSET:
+      command_offset[i] = command_fixed_offset[i];
+      break;
+    case FormulaTypes::EXPRESSION:
+      command_offset[i] = expressionOffset(i);
+      break;
+    default:
+      command_offset[i] = waveform.offset(i, phase);
     }
-    event.id = cmd->getInput()->getID();
-    event.value = fmin(fmax(command_value[cmd] + command_offset[cmd], JOYSTICK_MIN), JOYSTICK_MAX);
-    engine->fakePipelinedEvent(event, getptr());
-    PLOG_DEBUG << cmd->getName() << " orig value = " << command_value[cmd] << " + offset " << command_offset[cmd];
-    i++;
+    event.id = commands[i]->getInput()->getID();
+    event.value = std::clamp(command_value[i] + command_offset[i], JOYSTICK_MIN, JOYSTICK_MAX);
+    pending_events.push_back(event);
+    PLOG_DEBUG << commands[i]->getName() << " orig value = " << command_value[i] << " + offset " << command_offset[i];
   }
+  // Send all axes together so paired axes never reach the console half-updated
+  engine->fakePipelinedEvents(pending_events, getptr());
   condition_active_last = true;
 }
 
 void FormulaModifier::finish() {
-  DeviceEvent event;
   // Restore axes to their non-skewed positions
-  for (auto& cmd : commands) {
-    event.id = cmd->getInput()->getID();
-    event.type = cmd->getInput()->getButtonType();
-    event.value = command_value[cmd];
-    engine->fakePipelinedEvent(event, getptr());
-  }
-
+  restoreCommandValues();
 }
 
 bool FormulaModifier::tweak(DeviceEvent& event) {
-  for (auto& cmd : commands) {
-    if (engine->eventMatches(event, cmd)) {
-      command_value[cmd] = event.value;
-      event.value = fmin(fmax(event.value + command_offset[cmd], JOYSTICK_MIN), JOYSTICK_MAX);
+  for (size_t i = 0; i < commands.size(); ++i) {
+    if (engine->eventMatches(event, commands[i])) {
+      command_value[i] = event.value;
+      event.value = fmin(fmax(event.value + command_offset[i], JOYSTICK_MIN), JOYSTICK_MAX);
     }
   }
   return true;
@@ -19,18 +19,16 @@
  */
 #pragma once
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include <toml++/toml.h>
 
 #include "Modifier.hpp"
+#include "Expression.hpp"
 #include "Game.hpp"
+#include "Waveform.hpp"
 
 namespace Chaos {
 
-  enum class FormulaTypes {
-    CIRCLE, EIGHT_CURVE, JANKY, RANDOM_OFFSET
-  };
-
   /**
    * \brief Modifier that alters the signal through a formula.
    *
@@ -54,6 +52,13 @@ namespace Chaos {
    * - janky:       axis 1 = (cos(t) + cos(2t)/2) * sin(t/5)/2
    *                axis 2 = (cos(t+4) + cos(2t)/2) * sin((t+4)/5)/2
    * - random_offset: axis 1..N use fixed offsets selected once at begin()
+   *
+   * Instead of a formula type, the mod can give its own formula as an expression (see Expression),
+   * either one for all axes or one per axis. The expression can read the time, the axis' slot
+   * and incoming value, and the state of any controller signal. It is compiled when the
+   * configuration is loaded.
+   *
+   * The waveforms are evaluated in fixed point from a sine table (see Waveform).
    * 
    * Commands altered by formula modifiers should be axes only.
    */
@@ -62,7 +67,28 @@ namespace Chaos {
   private:
     FormulaTypes formula_type;
     double amplitude;
-    double period_length;
+    // Periods per second
+    double frequency;
+    Waveform waveform;
+
+    // Variables available to user-defined expressions. Signal states follow the fixed ones.
+    enum ExpressionVariable { VAR_T, VAR_TIME, VAR_I, VAR_VALUE, VAR_FIRST_INPUT };
+    // Compiled expression for each command slot
+    std::vector<Expression> expressions;
+    // Signals read by the expressions, in variable order
+    std::vector<std::shared_ptr<ControllerInput>> expression_inputs;
+    // Variable values for the current update
+    std::vector<double> expression_vars;
+
+    /**
+     * \brief Compile the 'formula' key, which holds one expression or one per command.
+     */
+    void compileExpressions(toml::table& config);
+
+    /**
+     * \brief Offset for one command slot from its user-defined expression.
+     */
+    int expressionOffset(size_t slot);
     bool has_direction;
     double range_min;
     double range_max;
@@ -70,9 +96,20 @@ namespace Chaos {
     double direction_max;
     bool condition_active_last{false};
 
-    std::unordered_map<std::shared_ptr<GameCommand>, int> command_value;
-    std::unordered_map<std::shared_ptr<GameCommand>, int> command_offset;
-    std::unordered_map<std::shared_ptr<GameCommand>, int> command_fixed_offset;
+    // Per-command state, indexed by the command's position in 'commands'
+    std::vector<int> command_value;
+    std::vector<int> command_offset;
+    std::vector<int> command_fixed_offset;
+
+    /**
+     * \brief Reusable batch holding the events for one update, so paired axes are sent together.
+     */
+    std::vector<DeviceEvent> pending_events;
+
+    /**
+     * \brief Send every command back to its last incoming (unskewed) value.
+     */
+    void restoreCommandValues();
 
   public:
     /**
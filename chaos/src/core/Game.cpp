@@ -383,6 +383,11 @@ bool Game::loadConfigFile(const std::string& configfile, EngineInterface* engine
     PLOG_WARNING << "You asked for " << active_modifiers << ". There must be at least one.";
     ++parse_warnings;
     active_modifiers = 1;
+  } else if (active_modifiers > (int) MAX_ACTIVE_MODIFIERS) {
+    PLOG_ERROR << "You asked for " << active_modifiers << " active modifiers. The most allowed is "
+               << MAX_ACTIVE_MODIFIERS << ".";
+    ++parse_warnings;
+    active_modifiers = MAX_ACTIVE_MODIFIERS;
   } else if (active_modifiers > 5) {
     PLOG_WARNING << "Having too many active modifiers may cause undesirable side-effects.";
   }
@@ -497,7 +502,7 @@ void Game::makeMenu(toml::table& config) {
 
 void Game::addMenuItem(toml::table& config) {
 
-  TOMLUtils::checkValid(config, std::vector<std::string>{"name", "type", "offset", "tab", "confirm",
+  TOMLUtils::checkValid(config, {"name", "type", "offset", "tab", "confirm",
                         "initial", "parent", "guard", "hidden", "counter", "counter_action"});
 
   std::optional<std::string> entry_name = config["name"].value<std::string>();
@@ -706,7 +711,7 @@ std::shared_ptr<GameCondition> Game::makeCondition(toml::table& config) {
 
   PLOG_VERBOSE << "Initializing game condition " << *condition_name;
   
-  TOMLUtils::checkValid(config, std::vector<std::string>{
+  TOMLUtils::checkValid(config, {
       "name", "command", "clear_on", "threshold", "threshold_type", "clear_threshold",
       "clear_threshold_type"});
 
@@ -922,8 +927,6 @@ std::shared_ptr<Sequence> Game::makeSequence(toml::table& config,
                                              const std::string& key,
                                              bool required) {
 
-  std::shared_ptr<Sequence> seq = std::make_shared<Sequence>(controller);
-
   toml::array* event_list = config[key].as_array();
   if (! event_list) {
     if (required) {
@@ -933,6 +936,8 @@ std::shared_ptr<Sequence> Game::makeSequence(toml::table& config,
     return nullptr;
   }
 
+  std::shared_ptr<Sequence> seq = std::make_shared<Sequence>(controller);
+
   for (toml::node& elem : *event_list) {
     toml::table *definition = elem.as_table();
     if (!definition) {
@@ -941,7 +946,7 @@ std::shared_ptr<Sequence> Game::makeSequence(toml::table& config,
       continue;
     }
 
-    TOMLUtils::checkValid(*definition, std::vector<std::string>{"event", "command", "delay",
+    TOMLUtils::checkValid(*definition, {"event", "command", "delay",
                           "repeat", "value"}, "makeSequence");
       
     std::optional<std::string> event = (*definition)["event"].value<std::string>();
@@ -1134,10 +1139,15 @@ void Game::addGameConditions(const toml::table& config, const std::string& key,
       // check that the string matches the name of a previously defined object
    	  std::shared_ptr<GameCondition> item = getCondition(*cmd);
       if (item) {
-        // Make a new copy of the reference condition rather than reusing the same pointer, so that each
-        // mod has its own separate copy of the conditions' states.
-        std::shared_ptr<GameCondition> copy(new GameCondition(*item));
-        vec.push_back(copy);
+        // Give each mod its own copy of a persistent condition, so that each mod has a separate copy
+        // of the condition's state. Transient conditions have no state of their own, so mods share
+        // them and a cached result serves all of them.
+        if (item->isTransient()) {
+          vec.push_back(item);
+        } else {
+          std::shared_ptr<GameCondition> copy(new GameCondition(*item));
+          vec.push_back(copy);
+        }
         PLOG_VERBOSE << "Added '" << *cmd << "' to the " << key << " vector.";
       } else {
         ++parse_errors;
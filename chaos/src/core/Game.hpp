@@ -142,6 +142,11 @@ namespace Chaos {
      */
     std::unordered_map<std::string, std::shared_ptr<Modifier>>& getModifierMap() { return modifiers.getModMap();}
 
+    /**
+     * \brief Get the group and type index of the loaded modifiers
+     */
+    const ModifierIndex& getModifierIndex() const { return modifiers.getIndex(); }
+
     /**
      * \brief Get the list of modifiers as a Json object
      * 
@@ -149,6 +154,11 @@ namespace Chaos {
      */
     Json::Value getModList() { return modifiers.getModList(); }
 
+    /**
+     * \brief Get the modifier names ordered by their table index
+     */
+    std::vector<std::string> getModNames() { return modifiers.getModNames(); }
+
 
     /**
      * \brief Access the controller input lookup table for the current game.
@@ -92,8 +92,11 @@ namespace Chaos {
     /**
      * \brief Accessor for the ControllerInput object bound to this command.
      * \return std::shared_ptr to the ControllerInput object.
+     *
+     * Returned by reference so that per-event callers can use the binding, or build a Handle from
+     * it, without changing its reference count.
      */
-    std::shared_ptr<ControllerInput> getInput() { return binding; }
+    const std::shared_ptr<ControllerInput>& getInput() const { return binding; }
     
     /**
      * \brief Get the current state of the controller for this command
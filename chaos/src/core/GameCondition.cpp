@@ -24,6 +24,7 @@
 #include <plog/Log.h>
 
 #include "GameCondition.hpp"
+#include "Controller.hpp"
 #include "GameCommand.hpp"
 #include "ControllerInput.hpp"
 #include "TOMLUtils.hpp"
@@ -31,7 +32,7 @@
 using namespace Chaos;
 
 namespace {
-bool eventMatchesSignal(const DeviceEvent& event, const std::shared_ptr<ControllerInput>& signal) {
+bool eventMatchesSignal(const DeviceEvent& event, Handle<ControllerInput> signal) {
   if (!signal) {
     return false;
   }
@@ -45,7 +46,7 @@ bool eventMatchesSignal(const DeviceEvent& event, const std::shared_ptr<Controll
   );
 }
 
-short signalStateWithEvent(const std::shared_ptr<ControllerInput>& signal, short thresh, const DeviceEvent& event) {
+short signalStateWithEvent(Handle<ControllerInput> signal, short thresh, const DeviceEvent& event) {
   if (eventMatchesSignal(event, signal)) {
     return event.value;
   }
@@ -56,16 +57,50 @@ short signalStateWithEvent(const std::shared_ptr<ControllerInput>& signal, short
 GameCondition::GameCondition(const std::string& condition_name) :
   name{condition_name} {}
 
+GameCondition::GameCondition(const GameCondition& other) :
+  name{other.name},
+  while_conditions{other.while_conditions},
+  clear_on{other.clear_on},
+  persistent_state{other.persistent_state},
+  threshold{other.threshold},
+  threshold_type{other.threshold_type},
+  clear_threshold{other.clear_threshold},
+  clear_threshold_type{other.clear_threshold_type},
+  controller{other.controller},
+  watched{other.watched} {}
+
 void GameCondition::addWhile(std::shared_ptr<GameCommand> command) {
   // Translate command to the index of the device event for fast comparison
   PLOG_DEBUG << "Adding while condition for " << command->getName();
   while_conditions.push_back(command->getInput());
+  watch(command->getInput());
 }
 
 void GameCondition::addClearOn(std::shared_ptr<GameCommand> command) {
   // Translate command to the index of the device event for fast comparison
   PLOG_DEBUG << "Adding clear_on condition for " << command->getName();
   clear_on.push_back(command->getInput());
+  watch(command->getInput());
+}
+
+void GameCondition::watch(Handle<ControllerInput> signal) {
+  if (!signal) {
+    return;
+  }
+  if (!controller) {
+    controller = &signal->getController();
+  }
+  // Whether a hybrid signal is read as a button or an axis depends on the threshold, which is set
+  // later, so watch both.
+  watched.push_back(signal->getIndex());
+  if (signal->getType() == ControllerSignalType::HYBRID) {
+    watched.push_back(signal->getHybridAxisIndex());
+  }
+  invalidate();
+}
+
+bool GameCondition::watches(int index) const {
+  return std::find(watched.begin(), watched.end(), index) != watched.end();
 }
 
 bool GameCondition::thresholdComparison(short value, short thresh, ThresholdType type) {
@@ -98,10 +133,10 @@ bool GameCondition::distanceComparison(short x, short y, short thresh, Threshold
   return (d < thresh * thresh);
 }
 
-short GameCondition::calculateThreshold(double proportion, std::vector<std::shared_ptr<ControllerInput>> conditions) {
+short GameCondition::calculateThreshold(double proportion, const std::vector<Handle<ControllerInput>>& conditions) {
   assert(proportion >= -1.0 && proportion <= 1.0);
   short t = 1;
-  std::shared_ptr<ControllerInput> signal;
+  Handle<ControllerInput> signal;
 
   // Translate the threshold to an integer based on the signal of the first command in the commands list
   if (conditions.empty()) {
@@ -130,15 +165,17 @@ short GameCondition::calculateThreshold(double proportion, std::vector<std::shar
 
 void GameCondition::setThreshold(double proportion) {
   threshold = calculateThreshold(proportion, while_conditions);
+  invalidate();
   PLOG_DEBUG << "Threshold for " << name << " set to " << threshold;
 }
 
 void GameCondition::setClearThreshold(double proportion) {
   clear_threshold = calculateThreshold(proportion, clear_on);
+  invalidate();
   PLOG_DEBUG << "Clear-on threshold for " << name << " set to " << clear_threshold;
 }
 
-bool GameCondition::testCondition(std::vector<std::shared_ptr<ControllerInput>> conditions, short thresh, ThresholdType type) {
+bool GameCondition::testCondition(const std::vector<Handle<ControllerInput>>& conditions, short thresh, ThresholdType type) {
   if (type == ThresholdType::DISTANCE || type == ThresholdType::DISTANCE_BELOW) {
     assert(conditions.size() == 2);
     short x = conditions[0]->getState(true);
@@ -147,13 +184,13 @@ bool GameCondition::testCondition(std::vector<std::shared_ptr<ControllerInput>>
   }
 
   return std::all_of(conditions.begin(), conditions.end(),
-                     [&](std::shared_ptr<ControllerInput> c) {
+                     [&](Handle<ControllerInput> c) {
 	                      return thresholdComparison(c->getState(thresh != 1), thresh, type); 
                       });
 
 }
 
-bool GameCondition::testConditionWithEvent(std::vector<std::shared_ptr<ControllerInput>> conditions, short thresh,
+bool GameCondition::testConditionWithEvent(const std::vector<Handle<ControllerInput>>& conditions, short thresh,
                                            ThresholdType type, const DeviceEvent& event) {
   if (type == ThresholdType::DISTANCE || type == ThresholdType::DISTANCE_BELOW) {
     assert(conditions.size() == 2);
@@ -163,12 +200,37 @@ bool GameCondition::testConditionWithEvent(std::vector<std::shared_ptr<Controlle
   }
 
   return std::all_of(conditions.begin(), conditions.end(),
-                     [&](std::shared_ptr<ControllerInput> c) {
+                     [&](Handle<ControllerInput> c) {
                        return thresholdComparison(signalStateWithEvent(c, thresh, event), thresh, type);
                      });
 }
 
 bool GameCondition::inCondition() {
+  if (!controller) {
+    return evaluate();
+  }
+  // Read the count before the state so that a change made while we evaluate leaves the cache stale
+  const uint64_t count = controller->changeCount();
+  const uint64_t cached = cache.load(std::memory_order_acquire);
+  if (cached != NOT_CACHED) {
+    const uint64_t since = cached >> 1;
+    if (since == count) {
+      return cached & 1;
+    }
+    if (std::none_of(watched.begin(), watched.end(),
+                     [this, since](int index) { return controller->changedSince(index, since); })) {
+      cache.store((count << 1) | (cached & 1), std::memory_order_release);
+      return cached & 1;
+    }
+  }
+  const bool was_persistent = persistent_state;
+  const bool rval = evaluate();
+  cache.store(persistent_state == was_persistent ? ((count << 1) | rval) : NOT_CACHED,
+              std::memory_order_release);
+  return rval;
+}
+
+bool GameCondition::evaluate() {
   bool rval;
   if (persistent_state) {
     // Check if we've hit the clear condition
@@ -188,6 +250,10 @@ bool GameCondition::inCondition() {
 
 bool GameCondition::inCondition(const DeviceEvent& event) {
   bool rval;
+  if (isTransient() && !watches(event.index())) {
+    // The event doesn't touch anything we read, so the prediction is the live state
+    return inCondition();
+  }
   if (persistent_state) {
     rval = testConditionWithEvent(clear_on, clear_threshold, clear_threshold_type, event);
     if (rval) {
@@ -18,15 +18,19 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
 #include <toml++/toml.h>
+#include <handle.hpp>
 #include "DeviceEvent.hpp"
 #include "enumerations.hpp"
 
 namespace Chaos {
 
+  class Controller;
   class GameCommand;
   class GameCommandTable;
   class ControllerInput;
@@ -58,14 +62,21 @@ namespace Chaos {
    * the real-time state of the controller for the condition. The function inCondition(event) 
    * tests if the passed event matches the condition without checking the live state of the
    * controller. Note that this latter function only makes sense when used on simple conditions.
+   *
+   * Conditions are checked on every event and every tick, and the same condition is often shared by
+   * several modifiers, so inCondition() caches its result. The cache is tagged with the controller's
+   * change count and is only recomputed when one of the signals the condition reads has changed
+   * since then. A persistent condition that has just set or cleared its state is always recomputed
+   * on the next call, since its clear_on test may already pass.
    */
   class GameCondition {
   private:
     std::string name;
 
-    std::vector<std::shared_ptr<ControllerInput>> while_conditions;
+    // The inputs are owned by the game's signal table, which outlives its conditions.
+    std::vector<Handle<ControllerInput>> while_conditions;
 
-    std::vector<std::shared_ptr<ControllerInput>> clear_on;
+    std::vector<Handle<ControllerInput>> clear_on;
 
     /**
      * The current state of a persistent trigger
@@ -80,8 +91,37 @@ namespace Chaos {
 
     ThresholdType clear_threshold_type = ThresholdType::ABOVE;
 
-    bool testCondition(std::vector<std::shared_ptr<ControllerInput>> conditions, short thresh, ThresholdType type);
-    bool testConditionWithEvent(std::vector<std::shared_ptr<ControllerInput>> conditions, short thresh,
+    static constexpr uint64_t NOT_CACHED = UINT64_MAX;
+
+    /**
+     * Controller that the condition's signals read from. Set by the first signal added.
+     */
+    Controller* controller = nullptr;
+
+    /**
+     * State-table indices of every signal read by the while and clear_on tests.
+     */
+    std::vector<int> watched;
+
+    /**
+     * The last result of inCondition() packed as (controller change count << 1) | result, or
+     * NOT_CACHED if it must be recomputed.
+     */
+    std::atomic<uint64_t> cache{NOT_CACHED};
+
+    void watch(Handle<ControllerInput> signal);
+
+    bool watches(int index) const;
+
+    /**
+     * \brief Evaluate the condition against the live controller state, ignoring the cache.
+     */
+    bool evaluate();
+
+    void invalidate() { cache.store(NOT_CACHED, std::memory_order_relaxed); }
+
+    bool testCondition(const std::vector<Handle<ControllerInput>>& conditions, short thresh, ThresholdType type);
+    bool testConditionWithEvent(const std::vector<Handle<ControllerInput>>& conditions, short thresh,
                                 ThresholdType type, const DeviceEvent& event);
 
     /**
@@ -97,7 +137,7 @@ namespace Chaos {
 
     bool distanceComparison(short x, short y, short thresh, ThresholdType type);
 
-    short calculateThreshold(double proportion, std::vector<std::shared_ptr<ControllerInput>> conditions);
+    short calculateThreshold(double proportion, const std::vector<Handle<ControllerInput>>& conditions);
 
   public:
     /**
@@ -107,6 +147,11 @@ namespace Chaos {
      */
     GameCondition(const std::string& name);
 
+    /**
+     * \brief Copy a condition's definition and state. The copy starts with an empty cache.
+     */
+    GameCondition(const GameCondition& other);
+
     /**
      * \brief Get the threshold value required for the while condition to be true
      * 
@@ -136,12 +181,12 @@ namespace Chaos {
     /**
      * \brief Sets the rule for how to test the threshold value that triggers a condition.
      */
-    void setThresholdType(ThresholdType new_type) { threshold_type = new_type; }
+    void setThresholdType(ThresholdType new_type) { threshold_type = new_type; invalidate(); }
 
     /**
      * \brief Sets the rule for how to test the threshold value that triggers a condition.
      */
-    void setClearThresholdType(ThresholdType new_type) { clear_threshold_type = new_type; }
+    void setClearThresholdType(ThresholdType new_type) { clear_threshold_type = new_type; invalidate(); }
 
     /**
      * \brief Add a command to the while condition list
@@ -163,6 +208,9 @@ namespace Chaos {
 
     /**
      * \brief Tests if the condition's parameters have all been met.
+     *
+     * Returns the cached result unless one of the condition's signals has changed since it was
+     * computed.
      */
     bool inCondition();
 
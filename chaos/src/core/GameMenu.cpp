@@ -53,8 +53,14 @@ std::shared_ptr<MenuItem> GameMenu::getMenuItem(toml::table& config, const std::
 }
 
 void GameMenu::setState(std::shared_ptr<MenuItem> item, unsigned int new_val, bool restore, Controller& controller) {
-  PLOG_DEBUG << "Creating set menu sequence";
   Sequence seq{controller, true};
+  composeState(item, new_val, restore, controller, seq);
+  seq.send();
+}
+
+void GameMenu::composeState(std::shared_ptr<MenuItem> item, unsigned int new_val, bool restore,
+                            Controller& controller, Sequence& seq) {
+  PLOG_DEBUG << "Creating set menu sequence";
 
   // Keep visibility/offset corrections in sync with the latest guard states.
   syncGuardedVisibility();
@@ -93,7 +99,6 @@ void GameMenu::setState(std::shared_ptr<MenuItem> item, unsigned int new_val, bo
   const bool closes_menu_after_select = item->requiresConfirm();
   if (closes_menu_after_select) {
     PLOG_DEBUG << "Skipping reverse navigation for confirm item " << item->getName();
-    seq.send();
     return;
   }
 
@@ -110,10 +115,16 @@ void GameMenu::setState(std::shared_ptr<MenuItem> item, unsigned int new_val, bo
       addToSequence(seq, "menu exit");
     }
   }
-  seq.send();
 }
 
 void GameMenu::restoreState(std::shared_ptr<MenuItem> item, Controller& controller) {
+  Sequence seq{controller, true};
+  if (composeRestore(item, controller, seq)) {
+    seq.send();
+  }
+}
+
+bool GameMenu::composeRestore(std::shared_ptr<MenuItem> item, Controller& controller, Sequence& seq) {
   PLOG_DEBUG << "Creating restore menu sequence";
   if (item->hasSiblingCounter() && !item->isOption()) {
     std::shared_ptr<MenuItem> counter_item = item->getSiblingCounter();
@@ -122,7 +133,7 @@ void GameMenu::restoreState(std::shared_ptr<MenuItem> item, Controller& controll
     PLOG_DEBUG << "Counter " << counter_item->getName()
                << " now " << counter_item->getCounter();
     if (counter_item->getCounter() > 0) {
-      return;
+      return false;
     }
 
     std::shared_ptr<MenuItem> initial_item{nullptr};
@@ -136,13 +147,14 @@ void GameMenu::restoreState(std::shared_ptr<MenuItem> item, Controller& controll
     if (!initial_item) {
       PLOG_WARNING << "No initial submenu item found for " << counter_item->getName()
                    << " offset " << counter_item->getDefault();
-      return;
+      return false;
     }
     // Use restore=true so selecting the initial item does not re-increment the shared counter.
-    setState(initial_item, initial_item->getDefault(), true, controller);
-    return;
+    composeState(initial_item, initial_item->getDefault(), true, controller, seq);
+    return true;
   }
-  setState(item, item->getDefault(), true, controller);
+  composeState(item, item->getDefault(), true, controller, seq);
+  return true;
 }
 
 void GameMenu::correctOffset(std::shared_ptr<MenuItem> changed) {
@@ -126,6 +126,29 @@ namespace Chaos {
      */
     void restoreState(std::shared_ptr<MenuItem> item, Controller& controller);
 
+    /**
+     * \brief Build the sequence that sets a menu item, without sending it
+     * \param item The menu item to change
+     * \param new_val The new value of the item
+     * \param restore True if resetting to default state
+     * \param controller Reference to the Controller object
+     * \param seq Sequence that receives the navigation events
+     *
+     * The menu's record of item states is updated immediately, so sequences composed later build
+     * on this one. The caller is responsible for sending the sequence, in order.
+     */
+    void composeState(std::shared_ptr<MenuItem> item, unsigned int new_val, bool restore,
+                      Controller& controller, Sequence& seq);
+
+    /**
+     * \brief Build the sequence that restores a menu item to its default, without sending it
+     * \param item The menu item to restore
+     * \param controller Reference to the Controller object
+     * \param seq Sequence that receives the navigation events
+     * \return false if no navigation is needed (e.g., a shared counter is still in use)
+     */
+    bool composeRestore(std::shared_ptr<MenuItem> item, Controller& controller, Sequence& seq);
+
     /**
      * \brief Update the offset correction when menu items are hidden or revealed
      * \param changed The item whose visibility has changed
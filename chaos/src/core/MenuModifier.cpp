@@ -27,7 +27,7 @@ const std::string MenuModifier::mod_type = "menu";
 
 MenuModifier::MenuModifier(toml::table& config, EngineInterface* e) {
   
-  TOMLUtils::checkValid(config, std::vector<std::string>{"name", "description", "type", "groups",
+  TOMLUtils::checkValid(config, {"name", "description", "type", "groups",
              "menu_items", "reset_on_finish", "begin_sequence",
              "finish_sequence","unlisted"});
 
@@ -46,7 +46,7 @@ MenuModifier::MenuModifier(toml::table& config, EngineInterface* e) {
     if (!m) {
       throw std::runtime_error("menu_items must be an array of inline tables");
     }
-    TOMLUtils::checkValid(*m, std::vector<std::string>{"entry", "value"},"menu entry");
+    TOMLUtils::checkValid(*m, {"entry", "value"},"menu entry");
     if (! m->contains("entry")) {
       throw std::runtime_error("Each table within a menu_item array must contain an 'entry' key");
     }
@@ -25,6 +25,7 @@
 #include <algorithm>
 
 #include <plog/Log.h>
+#include <clock.hpp>
 
 #include "config.hpp"
 #include "enumerations.hpp"
@@ -100,8 +101,14 @@ void Modifier::initialize(toml::table& config, EngineInterface* e) {
 // actions for all mods. From there we dispatch to the appropriate child routine by invoking the
 // virtual functions.
 void Modifier::_begin() {
-  timer.initialize();
+  _begin(Clock::now());
+}
+
+void Modifier::_begin(int64_t now) {
+  ModifierProfile::Scope cost(profile, ModifierProfile::BEGIN);
+  timer.initialize(now);
   pause_time_accumulator = 0;
+  begin_pending = false;
   begin();
   sendBeginSequence();
 }
@@ -110,17 +117,39 @@ void Modifier::_begin() {
 void Modifier::begin() {}
 
 void Modifier::_update(bool wasPaused) {
-  timer.update();
+  _update(wasPaused, Clock::now());
+}
+
+void Modifier::_update(bool wasPaused, int64_t now) {
+  timer.update(now);
   if (wasPaused) {
     pause_time_accumulator += timer.dTime();
   }
+  // Hold off until the begin sequence has played, just as if _begin() had blocked for it
+  if (begin_pending.load()) {
+    return;
+  }
+  ModifierProfile::Scope cost(profile, ModifierProfile::UPDATE);
   update();
 }
 
 void Modifier::update() {}
 
 void Modifier::_finish() {
-  sendFinishSequence();
+  ModifierProfile::Scope cost(profile, ModifierProfile::FINISH);
+  // Changes still scheduled for later belong to a mod that is no longer active
+  if (engine) {
+    engine->cancelScheduled(this);
+  }
+  if (on_finish && !on_finish->empty()) {
+    // The virtual finish function runs after the finish sequence has played
+    std::shared_ptr<Modifier> self = shared_from_this();
+    sendFinishSequence([self]() {
+      PLOG_DEBUG << "Calling virtual finish function for mod " << self->name;
+      self->finish();
+    });
+    return;
+  }
   PLOG_DEBUG << "Calling virtual finish function for mod " << name;
   finish();
 }
@@ -131,8 +160,14 @@ bool Modifier::remap(DeviceEvent& event) {
   return true;
 }
 
+bool Modifier::_remap(DeviceEvent& event) {
+  ModifierProfile::Scope cost(profile, ModifierProfile::REMAP);
+  return remap(event);
+}
+
 
 bool Modifier::_tweak(DeviceEvent& event) {
+  ModifierProfile::Scope cost(profile, ModifierProfile::TWEAK);
   return tweak(event);
 }
 
@@ -144,17 +179,26 @@ void Modifier::sendBeginSequence() {
   if (on_begin && !on_begin->empty()) {
     PLOG_DEBUG << "Sending beginning sequence for " << getName();
     in_sequence = lock_while_busy;
-    on_begin->send();
-    in_sequence = false;
+    begin_pending = true;
+    std::shared_ptr<Modifier> self = shared_from_this();
+    engine->playSequence(*on_begin, [self]() {
+      self->in_sequence = false;
+      self->begin_pending = false;
+    });
   }
 }
 
-void Modifier::sendFinishSequence() { 
+void Modifier::sendFinishSequence(std::function<void()> then) { 
   if (on_finish && !on_finish->empty()) {
     PLOG_DEBUG << "Sending finishing sequence for " << getName();
     in_sequence = lock_while_busy;
-    on_finish->send();
-    in_sequence = false;
+    std::shared_ptr<Modifier> self = shared_from_this();
+    engine->playSequence(*on_finish, [self, then]() {
+      self->in_sequence = false;
+      if (then) {
+        then();
+      }
+    });
   }
 }
 
@@ -163,11 +207,11 @@ bool Modifier::inCondition() {
     return true;
   }
   if (condition_operation == ConditionCheck::ALL) {
-    return std::all_of(conditions.begin(), conditions.end(), [](std::shared_ptr<GameCondition> c) { return c->inCondition(); });
+    return std::all_of(conditions.begin(), conditions.end(), [](Handle<GameCondition> c) { return c->inCondition(); });
   } else if (condition_operation == ConditionCheck::ANY) {
-    return std::any_of(conditions.begin(), conditions.end(), [](std::shared_ptr<GameCondition> c) { return c->inCondition(); });
+    return std::any_of(conditions.begin(), conditions.end(), [](Handle<GameCondition> c) { return c->inCondition(); });
   } else {
-    return std::none_of(conditions.begin(), conditions.end(), [](std::shared_ptr<GameCondition> c) { return c->inCondition(); });
+    return std::none_of(conditions.begin(), conditions.end(), [](Handle<GameCondition> c) { return c->inCondition(); });
   }
 }
 
@@ -177,17 +221,17 @@ bool Modifier::inCondition(const DeviceEvent& event) {
   }
   if (condition_operation == ConditionCheck::ALL) {
     return std::all_of(conditions.begin(), conditions.end(),
-                       [&event](std::shared_ptr<GameCondition> c) {
+                       [&event](Handle<GameCondition> c) {
                          return c->isTransient() ? c->inCondition(event) : c->inCondition();
                        });
   } else if (condition_operation == ConditionCheck::ANY) {
     return std::any_of(conditions.begin(), conditions.end(),
-                       [&event](std::shared_ptr<GameCondition> c) {
+                       [&event](Handle<GameCondition> c) {
                          return c->isTransient() ? c->inCondition(event) : c->inCondition();
                        });
   } else {
     return std::none_of(conditions.begin(), conditions.end(),
-                        [&event](std::shared_ptr<GameCondition> c) {
+                        [&event](Handle<GameCondition> c) {
                           return c->isTransient() ? c->inCondition(event) : c->inCondition();
                         });
   }
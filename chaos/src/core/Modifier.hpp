@@ -18,11 +18,15 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <json/json.h>
 #include <toml++/toml.h>
@@ -35,6 +39,7 @@
 #include "EngineInterface.hpp"
 #include "GameCommand.hpp"
 #include "GameCondition.hpp"
+#include "ModifierProfile.hpp"
 #include "Sequence.hpp"
 
 namespace Chaos {
@@ -77,9 +82,9 @@ namespace Chaos {
    * from your constructor.
    *
    * The utility function checkValid() can be used to warn a user who uses an invalid key for the
-   * TOML table you are checking. You must provide the calling function the toml table and a vector
+   * TOML table you are checking. You must provide the calling function the toml table and a list
    * of the legal key names for that table. If there are any key names in the table that are not
-   * listed in this vector, a warning will be generated in the log file.
+   * in this list, a warning will be generated in the log file.
    * 
    *     // Sample header file samplemod.hpp for a modifier class
    *     #pragma once
@@ -100,7 +105,7 @@ namespace Chaos {
    *     using namespace Chaos;
    * 
    *     SampleModifier::SampleModifier(toml::table& config, Game& game) {
-   *       checkValid(config, std::vector<std::string>{"name", "description", "type", "other",
+   *       checkValid(config, {"name", "description", "type", "other",
    *                  "keys", "to", "recognize"});
    *       initialize(config);
    *       // Initialization specific to this modifier goes here
@@ -113,6 +118,10 @@ namespace Chaos {
     std::shared_ptr<Modifier> parent;
     std::string name;
     std::string description;
+    unsigned short table_index = 0;
+    ModifierProfile profile;
+    // True from _begin() until the begin sequence has finished playing
+    std::atomic<bool> begin_pending{false};
 
   protected:
     std::unordered_set<std::string> groups;
@@ -159,8 +168,11 @@ namespace Chaos {
 
     /**
      * \brief The current state of any begin or finish sequence that is beeing issued
+     *
+     * Sequences play on the engine's sequence executor, so this is set and cleared on different
+     * threads.
      */
-    bool in_sequence;
+    std::atomic<bool> in_sequence;
 
     /**
      * \brief A flag to indicate that events should be dropped while sending a sequence.
@@ -262,6 +274,30 @@ namespace Chaos {
      */
     std::string& getDescription() { return description; }
 
+    /**
+     * \brief Get the position of this mod in the order the game's modifiers were defined.
+     *
+     * Indices are dense, starting at 0, and stay fixed until the game configuration is reloaded.
+     */
+    unsigned short getTableIndex() { return table_index; }
+
+    /**
+     * \brief Set the position of this mod in the modifier table.
+     */
+    void setTableIndex(unsigned short index) { table_index = index; }
+
+    /**
+     * \brief Is the begin sequence still playing?
+     *
+     * The mod does not update until it has finished.
+     */
+    bool isBeginPending() const { return begin_pending.load(); }
+
+    /**
+     * \brief Get the CPU time this mod has used, by entry point.
+     */
+    ModifierProfile& getProfile() { return profile; }
+
     /**
      * \brief Get name by which this type of modifier is identified in the TOML file.
      */
@@ -319,6 +355,12 @@ namespace Chaos {
      */
     void _begin();
 
+    /**
+     * \brief Common entry point into the begin function, starting the timer at a given time
+     * \param now Current time in nanoseconds, as returned by Clock::now()
+     */
+    void _begin(int64_t now);
+
     /**
      * \brief Commands to execute when the mod is first applied. 
      * 
@@ -336,6 +378,15 @@ namespace Chaos {
      * so child routines should not send that out themselves.
      */
     void _update(bool wasPaused);
+
+    /**
+     * \brief Main entry point into the update loop, using a time already read from the clock
+     * \param wasPaused Are we calling update() for the first time after a pause?
+     * \param now Current time in nanoseconds, as returned by Clock::now()
+     *
+     * The engine reads the clock once per tick and passes the same time to every modifier.
+     */
+    void _update(bool wasPaused, int64_t now);
   
     /**
      * \brief Commands to execute at fixed intervals throughout the lifetime of the mod.
@@ -360,6 +411,13 @@ namespace Chaos {
      */
     virtual void finish();
 
+    /**
+     * \brief Append the active child modifiers, in the order they process events.
+     *
+     * Ordinary modifiers have no children and append nothing.
+     */
+    virtual void getChildren(std::vector<Modifier*>& children) {}
+
     /**
      * \brief Clear any pending internally queued events this modifier may inject later.
      *
@@ -381,6 +439,16 @@ namespace Chaos {
      */
     virtual bool remap(DeviceEvent& event);
 
+    /**
+     * \brief Common entry point into the remap function
+     * \param[in,out] event The event coming from the controller
+     * \return The result of remap()
+     *
+     * This function is called directly by the ChaosEngine class for each incoming event. It times
+     * the call and then invokes the virtual remap() function.
+     */
+    bool _remap(DeviceEvent& event);
+
     /**
      * \brief Common entry point into the tweak function
      * \param[in,out] event The event coming from the controller to test/alter.
@@ -417,6 +485,11 @@ namespace Chaos {
      * groupings within or across mod types.
      */
     Json::Value getGroups();
+
+    /**
+     * \brief Get the names of the groups to which this modifier belongs.
+     */
+    const std::unordered_set<std::string>& getGroupNames() const { return groups; }
     
     /**
      * \brief Checks the list of game conditions 
@@ -472,12 +545,13 @@ namespace Chaos {
 
     /**
      * \brief Send any sequence intended to issue when the modifier is finishing.
+     * \param then Invoked once the sequence has finished playing
      * 
-     * This function is called automatically after a modifier completes its finish() routine.
-     * Child classes do not need to invoke it specifically. If the finish_sequence is empty,
-     * this will do nothing.
+     * This function is called automatically before a modifier's finish() routine, which is
+     * passed in as the continuation. Child classes do not need to invoke it specifically. If the
+     * finish_sequence is empty, this will do nothing.
      */
-    void sendFinishSequence();
+    void sendFinishSequence(std::function<void()> then);
 
 
   };
@@ -0,0 +1,107 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+
+#include <plog/Log.h>
+
+#include "ModifierIndex.hpp"
+#include "Modifier.hpp"
+
+using namespace Chaos;
+
+void ModifierIndex::clear() {
+  by_id.clear();
+  ids.clear();
+  groups.clear();
+  types.clear();
+  every = DynamicBitset();
+  not_children = DynamicBitset();
+  empty = DynamicBitset();
+  ++build_count;
+}
+
+void ModifierIndex::build(const std::unordered_map<std::string, std::shared_ptr<Modifier>>& mods) {
+  clear();
+  std::vector<std::pair<std::string, std::shared_ptr<Modifier>>> ordered;
+  ordered.reserve(mods.size());
+  for (const auto& [name, mod] : mods) {
+    if (mod) {
+      ordered.emplace_back(name, mod);
+    }
+  }
+  std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+    if (a.second->getTableIndex() != b.second->getTableIndex()) {
+      return a.second->getTableIndex() < b.second->getTableIndex();
+    }
+    return a.first < b.first;
+  });
+
+  const size_t n = ordered.size();
+  every = DynamicBitset(n);
+  every.fill();
+  not_children = DynamicBitset(n);
+  empty = DynamicBitset(n);
+  by_id.reserve(n);
+  for (const auto& [name, mod] : ordered) {
+    const size_t id = by_id.size();
+    by_id.push_back(mod);
+    ids[mod.get()] = static_cast<int>(id);
+    for (const auto& group : mod->getGroupNames()) {
+      auto [it, inserted] = groups.try_emplace(group, n);
+      it->second.set(id);
+    }
+    auto [it, inserted] = types.try_emplace(mod->getModType(), n);
+    it->second.set(id);
+    if (!mod->allowAsChild()) {
+      not_children.set(id);
+    }
+  }
+  PLOG_DEBUG << "Indexed " << n << " modifiers in " << groups.size() << " groups and "
+             << types.size() << " types";
+}
+
+int ModifierIndex::id(const Modifier* mod) const {
+  auto it = ids.find(mod);
+  return (it == ids.end()) ? -1 : it->second;
+}
+
+const DynamicBitset& ModifierIndex::inGroup(const std::string& group) const {
+  auto it = groups.find(group);
+  return (it == groups.end()) ? empty : it->second;
+}
+
+const DynamicBitset& ModifierIndex::ofType(const std::string& type) const {
+  auto it = types.find(type);
+  return (it == types.end()) ? empty : it->second;
+}
+
+void ModifierIndex::insert(DynamicBitset& set, const Modifier* mod) const {
+  int i = id(mod);
+  if (i >= 0) {
+    set.set(i);
+  }
+}
+
+void ModifierIndex::erase(DynamicBitset& set, const Modifier* mod) const {
+  int i = id(mod);
+  if (i >= 0) {
+    set.reset(i);
+  }
+}
@@ -0,0 +1,122 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dynamic_bitset.hpp>
+
+namespace Chaos {
+
+  class Modifier;
+
+  /**
+   * \brief Group and type membership of the loaded modifiers as bitsets.
+   *
+   * Every modifier is given a dense id, in table order, and each group and each modifier type maps
+   * to the set of ids that belong to it. Picking random children then only needs set operations on
+   * a few words and a pick of the n-th set bit, without walking the modifier map or comparing
+   * strings.
+   *
+   * The index is built once all the modifiers have been created and is not updated afterwards.
+   */
+  class ModifierIndex {
+  public:
+    /**
+     * \brief Index a set of modifiers, replacing any previous contents.
+     *
+     * Ids follow the modifiers' table indices, with the name breaking ties.
+     */
+    void build(const std::unordered_map<std::string, std::shared_ptr<Modifier>>& mods);
+
+    void clear();
+
+    /**
+     * \brief Number of indexed modifiers. Ids run from 0 to size() - 1.
+     */
+    size_t size() const { return by_id.size(); }
+
+    /**
+     * \brief Incremented each time the index is rebuilt.
+     *
+     * Callers that cache sets derived from the index can use this to tell when they are stale.
+     */
+    uint32_t generation() const { return build_count; }
+
+    /**
+     * \brief Modifier with the given id.
+     */
+    const std::shared_ptr<Modifier>& get(size_t id) const { return by_id[id]; }
+
+    /**
+     * \brief Id of a modifier, or -1 if it is not in the index.
+     */
+    int id(const Modifier* mod) const;
+
+    /**
+     * \brief An empty set sized for this index.
+     */
+    DynamicBitset none() const { return DynamicBitset(size()); }
+
+    /**
+     * \brief The set of every indexed modifier.
+     */
+    const DynamicBitset& all() const { return every; }
+
+    /**
+     * \brief Modifiers in a group. Unknown groups give an empty set.
+     */
+    const DynamicBitset& inGroup(const std::string& group) const;
+
+    /**
+     * \brief Modifiers of a type. Unknown types give an empty set.
+     */
+    const DynamicBitset& ofType(const std::string& type) const;
+
+    /**
+     * \brief Modifiers that cannot be used as the child of another modifier.
+     */
+    const DynamicBitset& notChildren() const { return not_children; }
+
+    /**
+     * \brief Add a modifier to a set, if it is in the index.
+     */
+    void insert(DynamicBitset& set, const Modifier* mod) const;
+
+    /**
+     * \brief Remove a modifier from a set, if it is in the index.
+     */
+    void erase(DynamicBitset& set, const Modifier* mod) const;
+
+  private:
+    std::vector<std::shared_ptr<Modifier>> by_id;
+    std::unordered_map<const Modifier*, int> ids;
+    std::unordered_map<std::string, DynamicBitset> groups;
+    std::unordered_map<std::string, DynamicBitset> types;
+    DynamicBitset every;
+    DynamicBitset not_children;
+    DynamicBitset empty;
+    uint32_t build_count = 0;
+  };
+
+};
@@ -0,0 +1,125 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#include "ModifierProfile.hpp"
+
+using namespace Chaos;
+
+int64_t ModifierProfile::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Only the engine thread records calls, so a plain load and store is enough for each counter.
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void ModifierProfile::add(Phase phase, int64_t ns) {
+  uint64_t duration = (ns > 0) ? (uint64_t) ns : 0;
+  Counters& c = counters[phase];
+  bump(c.calls, 1);
+  bump(c.total_ns, duration);
+  if (duration > c.max_ns.load(std::memory_order_relaxed)) {
+    c.max_ns.store(duration, std::memory_order_relaxed);
+  }
+
+  uint64_t us = duration / 1000;
+  int bucket = (us == 0) ? 0 : 64 - __builtin_clzll(us);
+  if (bucket >= NUM_BUCKETS) {
+    bucket = NUM_BUCKETS - 1;
+  }
+  std::atomic<uint32_t>& b = c.histogram[bucket];
+  b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+bool ModifierProfile::empty() const {
+  for (const auto& c : counters) {
+    if (c.calls.load(std::memory_order_relaxed) > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Json::Value ModifierProfile::toJson() const {
+  Json::Value result(Json::objectValue);
+  for (int p = 0; p < NUM_PHASES; ++p) {
+    const Counters& c = counters[p];
+    uint64_t calls = c.calls.load(std::memory_order_relaxed);
+    if (calls == 0) {
+      continue;
+    }
+    Json::Value phase;
+    phase["calls"] = (Json::UInt64) calls;
+    phase["mean_us"] = c.total_ns.load(std::memory_order_relaxed) / 1000.0 / calls;
+    phase["max_us"] = c.max_ns.load(std::memory_order_relaxed) / 1000.0;
+    Json::Value histogram(Json::arrayValue);
+    for (const auto& b : c.histogram) {
+      histogram.append(b.load(std::memory_order_relaxed));
+    }
+    phase["histogram"] = histogram;
+    result[phaseName((Phase) p)] = phase;
+  }
+  return result;
+}
+
+std::string ModifierProfile::summary() const {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1);
+  bool first = true;
+  for (int p = 0; p < NUM_PHASES; ++p) {
+    const Counters& c = counters[p];
+    uint64_t calls = c.calls.load(std::memory_order_relaxed);
+    if (calls == 0) {
+      continue;
+    }
+    if (!first) {
+      out << "; ";
+    }
+    first = false;
+    out << phaseName((Phase) p) << " " << calls << " calls, mean "
+        << c.total_ns.load(std::memory_order_relaxed) / 1000.0 / calls << " us, max "
+        << c.max_ns.load(std::memory_order_relaxed) / 1000.0 << " us";
+  }
+  return out.str();
+}
+
+const char* ModifierProfile::phaseName(Phase phase) {
+  switch (phase) {
+  case REMAP:
+    return "remap";
+  case TWEAK:
+    return "tweak";
+  case UPDATE:
+    return "update";
+  case BEGIN:
+    return "begin";
+  case FINISH:
+    return "finish";
+  case INJECT:
+    return "inject";
+  default:
+    return "unknown";
+  }
+}
@@ -0,0 +1,139 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <json/json.h>
+
+namespace Chaos {
+
+  /**
+   * \brief CPU time spent inside one modifier, broken down by entry point.
+   *
+   * For each phase we keep a call count, the total and worst-case time, and a histogram of call
+   * durations. Times are inclusive: a parent modifier's figures include the time spent in its
+   * children.
+   *
+   * Accounting is off unless profile_modifiers is set in chaosconfig.toml. When off, each timed
+   * call costs a single relaxed load. When on, it adds two clock reads and a handful of relaxed
+   * stores. Calls are only recorded from the engine thread, so the counters are atomic only to let
+   * the interface read them while the engine runs.
+   */
+  class ModifierProfile {
+  public:
+    /**
+     * \brief The modifier entry point being timed.
+     */
+    enum Phase {
+      REMAP,
+      TWEAK,
+      UPDATE,
+      BEGIN,
+      FINISH,
+      INJECT,   ///< Downstream mods processing events this mod injected
+      NUM_PHASES
+    };
+
+    /**
+     * \brief Number of histogram buckets.
+     *
+     * Bucket 0 counts calls under 1 µs. Bucket i counts calls from 2^(i-1) up to 2^i µs, and the
+     * last bucket also counts everything longer.
+     */
+    static const int NUM_BUCKETS = 16;
+
+    /**
+     * \brief Times a call for as long as it is in scope.
+     */
+    class Scope {
+      ModifierProfile& profile;
+      Phase phase;
+      bool timing;
+      int64_t start;
+    public:
+      Scope(ModifierProfile& p, Phase ph) : profile{p}, phase{ph}, timing{isEnabled()},
+                                            start{timing ? now() : 0} {}
+      ~Scope() {
+        if (timing) {
+          profile.add(phase, now() - start);
+        }
+      }
+    };
+
+    /**
+     * \brief Turn accounting on or off for all modifiers.
+     */
+    static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    /**
+     * \brief Is accounting turned on?
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Add one call of the given duration.
+     *
+     * Must only be called from the engine thread.
+     */
+    void add(Phase phase, int64_t ns);
+
+    /**
+     * \brief Have any calls been recorded?
+     */
+    bool empty() const;
+
+    /**
+     * \brief Report the counters for the interface.
+     *
+     * Only phases with at least one call are included. Each phase reports its call count, the
+     * mean and maximum time in microseconds, and the histogram.
+     */
+    Json::Value toJson() const;
+
+    /**
+     * \brief One-line summary of the counters for the log.
+     */
+    std::string summary() const;
+
+    /**
+     * \brief Name of a phase as used in reports.
+     */
+    static const char* phaseName(Phase phase);
+
+    /**
+     * \brief Read the clock used for timing, in nanoseconds.
+     */
+    static int64_t now();
+
+  private:
+    struct Counters {
+      std::atomic<uint64_t> calls{0};
+      std::atomic<uint64_t> total_ns{0};
+      std::atomic<uint64_t> max_ns{0};
+      std::array<std::atomic<uint32_t>, NUM_BUCKETS> histogram{};
+    };
+    std::array<Counters, NUM_PHASES> counters;
+
+    inline static std::atomic<bool> enabled{false};
+  };
+
+};
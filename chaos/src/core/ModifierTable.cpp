@@ -17,7 +17,7 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
-#include <regex>
+#include <algorithm>
 #include <plog/Log.h>
 
 #include "ModifierTable.hpp"
@@ -30,6 +30,7 @@ void ModifierTable::clear() {
     PLOG_VERBOSE << "Clearing existing Modifier data.";
     mod_map.clear();
   }
+  index.clear();
 }
 
 // Handles the static initialization. We construct the list of mods from their TOML-file
@@ -63,7 +64,9 @@ int ModifierTable::buildModList(toml::table& config, EngineInterface* engine,
 	      continue;
       }
       // regularize the name by removing any duplicate spaces
-      *mod_name = std::regex_replace(*mod_name, std::regex(" {2,}"), " ");
+      mod_name->erase(std::unique(mod_name->begin(), mod_name->end(),
+                                  [](char a, char b) { return a == ' ' && b == ' '; }),
+                      mod_name->end());
       std::optional<std::string> mod_type = (*modifier)["type"].value<std::string>();
       if (!mod_type) {
         ++parse_errors;
@@ -85,6 +88,7 @@ int ModifierTable::buildModList(toml::table& config, EngineInterface* engine,
 	      std::shared_ptr<Modifier> m = Modifier::create(*mod_type, *modifier, engine);
         assert(m);
         m->setLifespan(default_time);
+        m->setTableIndex(mod_map.size());
         auto [it, result] = mod_map.try_emplace(*mod_name, m);
         if (! result) {
           ++parse_errors;
@@ -103,6 +107,7 @@ int ModifierTable::buildModList(toml::table& config, EngineInterface* engine,
     PLOG_ERROR << "No modifiers were defined.";
     throw std::runtime_error("No modifiers defined");
   }
+  index.build(mod_map);
   return parse_errors;
 }
 
@@ -117,6 +122,16 @@ Json::Value ModifierTable::getModList() {
   return mod;
 }
 
+std::vector<std::string> ModifierTable::getModNames() {
+  std::vector<std::string> names(mod_map.size());
+  for (auto const& [key, val] : mod_map) {
+    if (val->getTableIndex() < names.size()) {
+      names[val->getTableIndex()] = key;
+    }
+  }
+  return names;
+}
+
 std::shared_ptr<Modifier> ModifierTable::getModifier(const std::string& name) {
   auto iter = mod_map.find(name);
   if (iter != mod_map.end()) {
@@ -20,8 +20,10 @@
 #pragma once
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include <json/json.h>
 #include "Modifier.hpp"
+#include "ModifierIndex.hpp"
 #include "EngineInterface.hpp"
 
 namespace Chaos {
@@ -37,6 +39,11 @@ namespace Chaos {
      */
     std::unordered_map<std::string, std::shared_ptr<Modifier>> mod_map;
 
+    /**
+     * Group and type membership of the mods in mod_map, rebuilt with the list
+     */
+    ModifierIndex index;
+
   public:
     /**
      * \brief Clear all defined modifiers.
@@ -65,11 +72,21 @@ namespace Chaos {
      */
     std::unordered_map<std::string, std::shared_ptr<Modifier>>& getModMap() { return mod_map; }
 
+    /**
+     * \brief Access the group and type index of the loaded modifiers.
+     */
+    const ModifierIndex& getIndex() const { return index; }
+
     /**
      * \brief Get the number of modifiers currently loaded.
      */
     int getNumModifiers() { return mod_map.size(); }
 
+    /**
+     * \brief Get the modifier names ordered by their table index.
+     */
+    std::vector<std::string> getModNames();
+
     /**
      * Return list of modifiers for the chat bot.
      */
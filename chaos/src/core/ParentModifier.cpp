@@ -17,6 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "ParentModifier.hpp"
+#include "ModifierIndex.hpp"
 #include "TOMLUtils.hpp"
 #include <algorithm>
 #include <random.hpp>
@@ -53,7 +54,7 @@ ParentModifier::ParentModifier(toml::table& config, EngineInterface* e) {
   assert(config.contains("name"));
   assert(config.contains("type"));
 
-  TOMLUtils::checkValid(config, std::vector<std::string>{
+  TOMLUtils::checkValid(config, {
       "name", "description", "type", "groups", "begin_sequence", "finish_sequence",
       "children", "random", "value", "select_from", "select_groups", "unlisted"});
   initialize(config, e);
@@ -126,103 +127,77 @@ ParentModifier::ParentModifier(toml::table& config, EngineInterface* e) {
   }
 }
 
+void ParentModifier::buildRandomPool(const ModifierIndex& index) {
+  random_pool = index.none();
+  if (!random_select_from.empty()) {
+    for (const auto& mod : random_select_from) {
+      index.insert(random_pool, mod.get());
+    }
+  } else if (!random_select_groups.empty()) {
+    for (const auto& group : random_select_groups) {
+      random_pool |= index.inGroup(group);
+    }
+    // Group-limited random selection never includes parent modifiers.
+    random_pool -= index.ofType(mod_type);
+  } else {
+    // Exclude parent mods that do random child selection. (This excludes self.)
+    DynamicBitset random_parents = index.ofType(mod_type);
+    random_parents &= index.notChildren();
+    random_pool = index.all();
+    random_pool -= random_parents;
+  }
+  pool_index = &index;
+  pool_generation = index.generation();
+}
+
 void ParentModifier::buildRandomList() {
   Random rng;
-  const auto& all_mods = engine->getModifierMap();
-  std::unordered_set<std::string> used_names;
+  const ModifierIndex* index = engine->getModifierIndex();
+  ModifierIndex local;
+  if (!index) {
+    local.build(engine->getModifierMap());
+    index = &local;
+  }
+  if (index == &local || index != pool_index || index->generation() != pool_generation) {
+    buildRandomPool(*index);
+  }
 
+  eligible = random_pool;
   for (const auto& mod : engine->getActiveMods()) {
-    if (mod) {
-      used_names.insert(mod->getName());
-    }
+    index->erase(eligible, mod.get());
   }
   for (const auto& mod : fixed_children) {
-    if (mod) {
-      used_names.insert(mod->getName());
-    }
+    index->erase(eligible, mod.get());
   }
   for (const auto& mod : random_children) {
-    if (mod) {
-      used_names.insert(mod->getName());
-    }
-  }
-
-  std::vector<std::pair<std::string, std::shared_ptr<Modifier>>> eligible;
-  if (!random_select_from.empty()) {
-    eligible.reserve(random_select_from.size());
-    for (const auto& mod : random_select_from) {
-      if (!mod) {
-        continue;
-      }
-      eligible.emplace_back(mod->getName(), mod);
-    }
-  } else {
-    eligible.reserve(all_mods.size());
-    for (const auto& [m_name, mod] : all_mods) {
-      if (!mod) {
-        continue;
-      }
-
-      if (!random_select_groups.empty()) {
-        // Group-limited random selection never includes parent modifiers.
-        if (mod->getModType() == mod_type) {
-          continue;
-        }
-        bool in_group = false;
-        const Json::Value groups = mod->getGroups();
-        for (const auto& group : groups) {
-          if (group.isString() &&
-              random_select_groups.find(group.asString()) != random_select_groups.end()) {
-            in_group = true;
-            break;
-          }
-        }
-        if (!in_group) {
-          continue;
-        }
-      } else {
-        // Exclude parent mods that do random child selection. (This excludes self.)
-        if (mod->getModType() == mod_type && !mod->allowAsChild()) {
-          continue;
-        }
-      }
-      eligible.emplace_back(m_name, mod);
-    }
-  }
-
-  std::vector<std::pair<std::string, std::shared_ptr<Modifier>>> filtered;
-  filtered.reserve(eligible.size());
-  for (const auto& [name, mod] : eligible) {
-    if (used_names.find(name) != used_names.end()) {
-      continue;
-    }
-    filtered.emplace_back(name, mod);
+    index->erase(eligible, mod.get());
   }
-  eligible.swap(filtered);
 
-  if (eligible.empty()) {
+  size_t available = eligible.count();
+  if (available == 0) {
     PLOG_WARNING << "No eligible modifiers available for random children in " << getName();
     return;
   }
 
   size_t target = static_cast<size_t>(num_randos);
   if (random_num_randos) {
-    target = static_cast<size_t>(
-        std::floor(rng.uniform(1.0, static_cast<double>(num_randos) + 0.01)));
+    target = static_cast<size_t>(rng.between(1, num_randos));
   }
   const size_t requested = static_cast<size_t>(num_randos);
-  target = std::min(target, eligible.size());
-  if (requested > eligible.size()) {
+  target = std::min(target, available);
+  if (requested > available) {
     PLOG_WARNING << "Requested up to " << requested << " random child modifiers for " << getName()
-                 << " but only " << eligible.size() << " are eligible";
+                 << " but only " << available << " are eligible";
   }
 
   while (random_children.size() < target) {
-    size_t selection = static_cast<size_t>(std::floor(rng.uniform(0, eligible.size() - 0.01)));
-    auto [name, mod] = eligible[selection];
-    PLOG_INFO << "Selected " << name << " as child mod";
+    size_t selection = static_cast<size_t>(rng.below(available));
+    size_t id = eligible.nth(selection);
+    eligible.reset(id);
+    --available;
+    const auto& mod = index->get(id);
+    PLOG_INFO << "Selected " << mod->getName() << " as child mod";
     random_children.push_back(mod);
-    eligible.erase(eligible.begin() + selection);
   }
 }
 
@@ -231,7 +206,7 @@ void ParentModifier::begin() {
   // Initialize any pre-determined modifiers
   for (auto& mod : fixed_children) {
     mod->setParentModifier(getptr());
-    mod->_begin();
+    mod->_begin(timer.lastTime());
   }
   if (num_randos > 0) {
     // Get a new random set of modifiers
@@ -239,18 +214,23 @@ void ParentModifier::begin() {
     // Initialize what we've selected
     for (auto& mod : random_children) {
       mod->setParentModifier(getptr());
-      mod->_begin();
+      mod->_begin(timer.lastTime());
     }
   }
 }
 
 void ParentModifier::update() {
+  if (engine->runsChildModifiers()) {
+    return;
+  }
+  // Children run on the time the engine handed to this parent rather than reading the clock again
+  const int64_t now = timer.lastTime();
   for (auto& mod : fixed_children) {
-    mod->_update(engine->isPaused());
+    mod->_update(engine->isPaused(), now);
   }
 
   for (auto& mod : random_children) {
-    mod->_update(engine->isPaused());
+    mod->_update(engine->isPaused(), now);
   }
 }
 
@@ -265,16 +245,25 @@ void ParentModifier::finish() {
   random_children.clear();
 }
 
+void ParentModifier::getChildren(std::vector<Modifier*>& children) {
+  for (auto& mod : fixed_children) {
+    children.push_back(mod.get());
+  }
+  for (auto& mod : random_children) {
+    children.push_back(mod.get());
+  }
+}
+
 bool ParentModifier::remap(DeviceEvent& event) {
   bool rval;
   for (auto& mod : fixed_children) {
-    rval = mod->remap(event);
+    rval = mod->_remap(event);
     if (!rval) {
       return false;
     }
   }
   for (auto& mod : random_children) {
-    rval = mod->remap(event);
+    rval = mod->_remap(event);
     if (!rval) {
       return false;
     }
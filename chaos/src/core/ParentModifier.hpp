@@ -21,6 +21,7 @@
 #include <string>
 #include <unordered_set>
 #include <toml++/toml.h>
+#include <dynamic_bitset.hpp>
 
 #include "Modifier.hpp"
 #include "EngineInterface.hpp"
@@ -40,6 +41,9 @@ namespace Chaos {
    * Child modifiers in #fixed_children will be processed in the same order that they are specified
    * in the TOML file. If both named child mods and random mods are specified, the random mods
    * will be processed after all the mods specified in #fixed_children.
+   *
+   * The chaos engine puts the children of an active parent straight into its event pipeline, so a
+   * parent costs no more per event than its children would on their own.
    */
   class ParentModifier : public Modifier::Registrar<ParentModifier> {
   protected:
@@ -74,6 +78,25 @@ namespace Chaos {
      */
     std::unordered_set<std::string> random_select_groups;
 
+    /**
+     * Modifiers that random selection may draw from, before excluding those already in use. This
+     * is resolved from the engine's modifier index the first time children are picked.
+     */
+    DynamicBitset random_pool;
+
+    /**
+     * Index and index generation that #random_pool was resolved against
+     */
+    const ModifierIndex* pool_index = nullptr;
+    uint32_t pool_generation = 0;
+
+    /**
+     * Scratch set of the candidates for one selection
+     */
+    DynamicBitset eligible;
+
+    void buildRandomPool(const ModifierIndex& index);
+
     void buildRandomList();
   public:
     /**
@@ -97,7 +120,7 @@ namespace Chaos {
     void begin();
 
     /**
-     * \brief Update active child modifiers.
+     * \brief Update active child modifiers, unless the engine runs them itself.
      */
     void update();
 
@@ -106,11 +129,18 @@ namespace Chaos {
      */
     void finish();
 
+    /**
+     * \brief Append the fixed children, then the random ones chosen for this activation.
+     */
+    void getChildren(std::vector<Modifier*>& children);
+
     /**
      * \brief Route event processing through active children.
      *
      * \param event Event to process.
      * \return true if the event should continue through the pipeline.
+     *
+     * Only used by engines that do not run the children themselves.
      */
     bool remap(DeviceEvent& event);
 
@@ -119,6 +149,8 @@ namespace Chaos {
      *
      * \param event Event to process.
      * \return true if the event should continue through the pipeline.
+     *
+     * Only used by engines that do not run the children themselves.
      */
     bool tweak(DeviceEvent& event);
   };
@@ -40,7 +40,7 @@ void RemapModifier::setDebugAxisFuzzThreshold(int threshold) {
 
 RemapModifier::RemapModifier(toml::table& config, EngineInterface* e) {
 
-  TOMLUtils::checkValid(config, std::vector<std::string>{
+  TOMLUtils::checkValid(config, {
       "name", "description", "type", "groups", "disable_signals", "remap",
       "random_remap", "unlisted"});
 
@@ -52,6 +52,7 @@ RemapModifier::RemapModifier(toml::table& config, EngineInterface* e) {
   }
   
   engine->addControllerInputs(config, "disable_signals", signals);
+  reset_events.reserve(signals.size() * 2);
 
   // remap
   if (config.contains("remap")) {
@@ -69,7 +70,7 @@ RemapModifier::RemapModifier(toml::table& config, EngineInterface* e) {
       if (! remapping) {
 	      throw std::runtime_error("Remapping instructions must be formatted as a table");
       }
-      TOMLUtils::checkValid(*remapping, std::vector<std::string>{"from", "to", "to_neg", "to_min", "invert",
+      TOMLUtils::checkValid(*remapping, {"from", "to", "to_neg", "to_min", "invert",
                  "threshold", "sensitivity"}, "remap config");
       
       std::shared_ptr<ControllerInput> from = lookupInput(*remapping, "from", true);
@@ -146,6 +147,7 @@ RemapModifier::RemapModifier(toml::table& config, EngineInterface* e) {
     " to_min = " << r.to_min << " to_negative = " << (r.to_negative ? r.to_negative->getName() : "NONE") <<
     " threshold = " << r.threshold << " invert = " << r.invert;
   }
+  compileRoutes();
 }
 
 std::shared_ptr<ControllerInput> RemapModifier::lookupInput(const toml::table& config, const std::string& key, bool required) {
@@ -176,7 +178,7 @@ void RemapModifier::begin() {
     }
     // Iterate through the list of signals we're remapping and assign a random signal to it
     for (auto& [key, value] : remaps) {
-      int index = floor(rng.uniform(0, buttons.size()-0.01));
+      int index = static_cast<int>(rng.below(buttons.size()));
       auto it = buttons.begin();
       std::advance(it, index);
       value.to_console =  *it;
@@ -187,255 +189,311 @@ void RemapModifier::begin() {
     for (auto [key, value] : remaps) {
       PLOG_DEBUG << key->getName() << " remapped to " << (value.to_console)->getName();
     }
+    compileRoutes();
   }
   if (signals.size() > 0) {
+    reset_events.clear();
     for (auto& sig : signals) {
       event.value = 0;
       event.id = sig->getID();
       event.type = sig->getButtonType();
-      engine->applyEvent(event);
+      reset_events.push_back(event);
       if (sig->getType() == ControllerSignalType::HYBRID) {
         event.id = sig->getHybridAxisIndex();
         event.type = TYPE_AXIS;
         event.value = JOYSTICK_MIN;
-        engine->applyEvent(event);
+        reset_events.push_back(event);
       }
     }
+    engine->applyEvents(reset_events);
   }
 }
 
-bool RemapModifier::remap(DeviceEvent& event) {
-  DeviceEvent new_event{};
-  auto signal = engine->getInput(event);
+void RemapModifier::compileRoutes() {
+  routes.clear();
+  route_slot.fill(0);
+  for (auto& [from, remap] : remaps) {
+    // Random remaps are not resolved until begin()
+    if (!remap.to_console) {
+      continue;
+    }
+    if (routes.size() >= 255) {
+      PLOG_ERROR << getName() << ": too many remaps to compile; ignoring " << from->getName();
+      break;
+    }
+    ControllerInput* to = remap.to_console.get();
+    const ControllerSignalType from_type = from->getType();
+    const ControllerSignalType to_type = to->getType();
 
-  // Is this event in our list of remaps?
-  if (auto it{remaps.find(signal)}; it != std::end(remaps)) {
-    const auto[from, remap]{*it};
+    RemapRoute route{};
+    route.from = from.get();
+    route.to_console = to;
+    route.to_negative = remap.to_negative.get();
+    route.to_id = to->getID();
+    route.to_type = to->getButtonType();
+    route.to_axis = (to_type == ControllerSignalType::HYBRID) ? to->getHybridAxis() : to->getID();
+    route.on_value = 0;
+    route.threshold = remap.threshold;
+    route.scale = remap.scale;
+    route.invert = remap.invert;
+    route.fuzz_filtered = from->getSignal() == ControllerSignal::LX ||
+                          from->getSignal() == ControllerSignal::LY ||
+                          from->getSignal() == ControllerSignal::RX ||
+                          from->getSignal() == ControllerSignal::RY;
+    route.kind = RemapTransform::SUBSTITUTE;
 
-    // Touchpad active requires special setup and tear-down
     if (from->getSignal() == ControllerSignal::TOUCHPAD_ACTIVE) {
-      if (! touchpad.isActive() && event.value) {
-        PLOG_DEBUG << "Begin touchpad use";
-        touchpad.firstTouch();
-        touchpad.setActive(true);
-      } else if (touchpad.isActive() && event.value == 0) {
-        PLOG_DEBUG << "End touchpad use";
-        touchpad.setActive(false);
-        // We're stopping touchpad use. Zero out all axes in use.
-        // NB: If we ever do support other controllers, we'll need to get the indirect signal type, not
-        // this low-level value
-        for (auto s : signals) {
-          const bool is_hybrid = (s->getType() == ControllerSignalType::HYBRID);
-          uint8_t axis_id = is_hybrid ? s->getHybridAxis() : s->getID();
-          short axis_value = is_hybrid ? JOYSTICK_MIN : 0;
-          new_event = {0, axis_value, TYPE_AXIS, axis_id};
-          // Inject directly to avoid lock recursion inside the remap pass.
-          engine->applyEvent(new_event);
+      route.kind = RemapTransform::TOUCHPAD_ACTIVE;
+    } else if (to->getSignal() == ControllerSignal::NOTHING) {
+      route.kind = RemapTransform::DROP;
+    } else {
+      switch (from_type) {
+      case ControllerSignalType::BUTTON:
+        if (to_type == ControllerSignalType::THREE_STATE) {
+          // If the source button maps to the negative dpad value, use -1, otherwise, use 1
+          route.kind = RemapTransform::BUTTON_TO_LEVEL;
+          route.on_value = remap.to_min ? -1 : 1;
+        } else if (to_type == ControllerSignalType::AXIS) {
+          // If the source button maps to the negative axis value, use min, otherwise, use max
+          route.kind = RemapTransform::BUTTON_TO_LEVEL;
+          route.on_value = remap.to_min ? JOYSTICK_MIN : JOYSTICK_MAX;
+        } else if (to_type == ControllerSignalType::HYBRID) {
+          route.kind = RemapTransform::BUTTON_TO_HYBRID;
+        }
+        break;
+      case ControllerSignalType::HYBRID:
+        if (to_type == ControllerSignalType::HYBRID) {
+          route.kind = RemapTransform::HYBRID_TO_HYBRID;
+        } else if (to_type == ControllerSignalType::BUTTON) {
+          route.kind = RemapTransform::HYBRID_TO_LEVEL;
+          route.on_value = 1;
+        } else if (to_type == ControllerSignalType::THREE_STATE) {
+          route.kind = RemapTransform::HYBRID_TO_LEVEL;
+          route.on_value = remap.to_min ? -1 : 1;
+        }
+        break;
+      case ControllerSignalType::THREE_STATE:
+        if (to_type == ControllerSignalType::AXIS) {
+          route.kind = RemapTransform::THREE_STATE_TO_AXIS;
+        } else if (to_type == ControllerSignalType::BUTTON || to_type == ControllerSignalType::HYBRID) {
+          route.kind = RemapTransform::THREE_STATE_TO_BUTTONS;
+        }
+        break;
+      case ControllerSignalType::AXIS:
+        if (to_type == ControllerSignalType::BUTTON || to_type == ControllerSignalType::HYBRID) {
+          route.kind = RemapTransform::AXIS_TO_BUTTONS;
+        } else if (to_type == ControllerSignalType::THREE_STATE) {
+          route.kind = RemapTransform::AXIS_TO_THREE_STATE;
         }
+        break;
+      case ControllerSignalType::ACCELEROMETER:
+        if (to_type == ControllerSignalType::AXIS) {
+          route.kind = RemapTransform::ACCELEROMETER_TO_AXIS;
+        }
+        break;
+      case ControllerSignalType::TOUCHPAD:
+        if (to_type == ControllerSignalType::AXIS) {
+          route.kind = RemapTransform::TOUCHPAD_TO_AXIS;
+        }
+        break;
+      case ControllerSignalType::DUMMY:
+        PLOG_WARNING << "Remapping from NONE or NOTHING";
+        break;
+      default:
+        break;
       }
-      return true;
     }
+    routes.push_back(route);
+    const uint8_t slot = static_cast<uint8_t>(routes.size());
 
-    auto to_console = remap.to_console;
+    // Register the route under every index that resolves to this input in the signal table, so the
+    // lookup agrees with engine->getInput(event).
+    int indices[2] = {from->getIndex(), -1};
+    if (from_type == ControllerSignalType::HYBRID) {
+      indices[1] = from->getHybridAxisIndex();
+    }
+    for (int idx : indices) {
+      if (idx < 0 || idx >= ROUTE_SLOTS) {
+        continue;
+      }
+      DeviceEvent probe{0, 0, static_cast<uint8_t>(idx >> 8), static_cast<uint8_t>(idx & 0xff)};
+      if (engine->getInput(probe) == from) {
+        route_slot[idx] = slot;
+      }
+    }
+  }
+  PLOG_DEBUG << getName() << ": compiled " << routes.size() << " remap routes";
+}
+
+bool RemapModifier::remap(DeviceEvent& event) {
+  const int idx = event.index();
+  if (idx >= ROUTE_SLOTS || route_slot[idx] == 0) {
+    return true;
+  }
+  const RemapRoute& route = routes[route_slot[idx] - 1];
+  DeviceEvent new_event{};
+  DeviceEvent modified{0, event.value, route.to_type, route.to_id};
+  ControllerInput* to_console = route.to_console;
 
+  switch (route.kind) {
+  case RemapTransform::TOUCHPAD_ACTIVE:
+    // Touchpad active requires special setup and tear-down
+    if (! touchpad.isActive() && event.value) {
+      PLOG_DEBUG << "Begin touchpad use";
+      touchpad.firstTouch();
+      touchpad.setActive(true);
+    } else if (touchpad.isActive() && event.value == 0) {
+      PLOG_DEBUG << "End touchpad use";
+      touchpad.setActive(false);
+      // We're stopping touchpad use. Zero out all axes in use.
+      // NB: If we ever do support other controllers, we'll need to get the indirect signal type, not
+      // this low-level value
+      reset_events.clear();
+      for (auto& s : signals) {
+        const bool is_hybrid = (s->getType() == ControllerSignalType::HYBRID);
+        uint8_t axis_id = is_hybrid ? s->getHybridAxis() : s->getID();
+        short axis_value = is_hybrid ? JOYSTICK_MIN : 0;
+        reset_events.push_back({0, axis_value, TYPE_AXIS, axis_id});
+      }
+      // Inject directly to avoid lock recursion inside the remap pass.
+      engine->applyEvents(reset_events);
+    }
+    return true;
+  case RemapTransform::DROP:
     // If we are remapping to NOTHING, we drop this signal.
-    if (to_console->getSignal() == ControllerSignal::NOTHING) {
+    {
       const int axis_fuzz = g_debug_axis_fuzz_threshold.load(std::memory_order_relaxed);
-      const bool is_axis_filter_target =
-          from->getSignal() == ControllerSignal::LX ||
-          from->getSignal() == ControllerSignal::LY ||
-          from->getSignal() == ControllerSignal::RX ||
-          from->getSignal() == ControllerSignal::RY;
-      const bool suppress_debug = axis_fuzz > 0 && is_axis_filter_target &&
+      const bool suppress_debug = axis_fuzz > 0 && route.fuzz_filtered &&
                                   std::abs(static_cast<int>(event.value)) < axis_fuzz;
       if (!suppress_debug) {
-        PLOG_DEBUG << getName() << " remapping " << from->getName() << " to NOTHING";
+        PLOG_DEBUG << getName() << " remapping " << route.from->getName() << " to NOTHING";
       }
-      return false;
     }
-
-    DeviceEvent modified;
-    // Basic remapping
-    modified.id = to_console->getID();
-    modified.type = to_console->getButtonType();
-    modified.value = event.value;
-
-    if (from->getType() == ControllerSignalType::HYBRID &&
-        to_console->getType() == ControllerSignalType::HYBRID &&
-        event.type == TYPE_AXIS) {
+    return false;
+  case RemapTransform::SUBSTITUTE:
+    break;
+  case RemapTransform::BUTTON_TO_LEVEL:
+    modified.value = event.value ? route.on_value : 0;
+    break;
+  case RemapTransform::BUTTON_TO_HYBRID:
+    // A regular button mapped to a trigger must also drive the trigger axis.
+    new_event.id = route.to_axis;
+    new_event.type = TYPE_AXIS;
+    new_event.value = event.value ? JOYSTICK_MAX : JOYSTICK_MIN;
+    engine->applyEvent(new_event);
+    break;
+  case RemapTransform::HYBRID_TO_HYBRID:
+    if (event.type == TYPE_AXIS) {
       // Preserve the axis channel for trigger-to-trigger remaps.
-      modified.id = to_console->getHybridAxis();
+      modified.id = route.to_axis;
       modified.type = TYPE_AXIS;
     }
-
-    const bool from_button_to_hybrid =
-        from->getType() == ControllerSignalType::BUTTON &&
-        to_console->getType() == ControllerSignalType::HYBRID;
-    if (from_button_to_hybrid) {
-      // A regular button mapped to a trigger must also drive the trigger axis.
-      new_event.id = to_console->getHybridAxis();
-      new_event.type = TYPE_AXIS;
-      new_event.value = event.value ? JOYSTICK_MAX : JOYSTICK_MIN;
-      engine->applyEvent(new_event);
-    }
-
-    if (from->getType() == ControllerSignalType::HYBRID &&
-        (to_console->getType() == ControllerSignalType::BUTTON ||
-         to_console->getType() == ControllerSignalType::THREE_STATE) &&
-        event.type == TYPE_BUTTON) {
+    break;
+  case RemapTransform::HYBRID_TO_LEVEL:
+    if (event.type == TYPE_BUTTON) {
       // For hybrid sources remapped to discrete outputs, only process the axis component.
       return false;
     }
+    modified.value = (event.value && event.value >= route.threshold) ? route.on_value : 0;
+    break;
+  case RemapTransform::THREE_STATE_TO_AXIS:
+    // Scale to axis extremes
+    modified.value = ControllerInput::joystickLimit(JOYSTICK_MAX*event.value);
+    break;
+  case RemapTransform::THREE_STATE_TO_BUTTONS:
+    {
+      // Three-state remaps must also process neutral (0) events to release previously pressed
+      // targets.
+      ControllerInput* positive_button = route.to_console;
+      ControllerInput* negative_button = route.to_negative;
+      ControllerInput* release = nullptr;
+      modified.type = TYPE_BUTTON;
 
-    // Now handle cases that require additional actions. Three-state remaps
-    // must also process neutral (0) events to release previously pressed targets.
-    if (event.value || from->getType() == ControllerSignalType::THREE_STATE) {
-    switch (from->getType()) {
-    case ControllerSignalType::BUTTON:
-      switch (to_console->getType()) {
-      case ControllerSignalType::THREE_STATE:
-        // If the source button maps to the negative dpad value, use -1, otherwise, use 1
-        modified.value = remap.to_min ? -1 : 1;
-        break;
-      case ControllerSignalType::AXIS:
-        // If the source button maps to the negative axis value, use min, otherwise, use max
-        modified.value = remap.to_min ? JOYSTICK_MIN : JOYSTICK_MAX;
-        break;
-      case ControllerSignalType::HYBRID:
-        break;
-      }
-      break;
-    case ControllerSignalType::HYBRID:
-      switch (to_console->getType()) {
-      case ControllerSignalType::BUTTON:
-        modified.value = (event.value >= remap.threshold) ? 1 : 0;
-        break;
-      case ControllerSignalType::THREE_STATE:
-        modified.value = (event.value >= remap.threshold) ? (remap.to_min ? -1 : 1) : 0;
-      }
-      break;
-    case ControllerSignalType::THREE_STATE:
-      switch (to_console->getType()) {
-      case ControllerSignalType::AXIS:
-	      // Scale to axis extremes
-      	modified.value = ControllerInput::joystickLimit(JOYSTICK_MAX*event.value);
-      	break;
-      case ControllerSignalType::BUTTON:
-      case ControllerSignalType::HYBRID:
-        auto positive_button = to_console;
-        auto negative_button = remap.to_negative;
-        modified.type = TYPE_BUTTON;
-
-        if (event.value > 0) {
-          modified.id = positive_button->getID();
-          modified.value = 1;
-          if (negative_button && negative_button != positive_button) {
-            new_event.id = negative_button->getID();
-            new_event.value = 0;
-            new_event.type = TYPE_BUTTON;
-            engine->applyEvent(new_event);
-          }
-        } else if (event.value < 0) {
-          if (!negative_button) {
-            PLOG_ERROR << getName() << " is missing remap for negative values of " << from->getName();
-            return true;
-          }
-          modified.id = negative_button->getID();
-          modified.value = 1;
-          if (negative_button != positive_button) {
-            new_event.id = positive_button->getID();
-            new_event.value = 0;
-            new_event.type = TYPE_BUTTON;
-            engine->applyEvent(new_event);
-          }
-        } else {
-          // Neutral three-state value should clear the active button.
-          modified.id = positive_button->getID();
-          modified.value = 0;
-          if (negative_button && negative_button != positive_button) {
-            new_event.id = negative_button->getID();
-            new_event.value = 0;
-            new_event.type = TYPE_BUTTON;
-            engine->applyEvent(new_event);
-          }
-        }
-      }
-      break;
-    case ControllerSignalType::AXIS:
-      switch (to_console->getType()) {
-      case ControllerSignalType::BUTTON:
-      case ControllerSignalType::HYBRID:
-      {
-        // When mapping from an axis to buttons/hybrids, the choice of button is determined by
-        // the sign of the value.
-        if (!remap.to_negative) {
-          PLOG_ERROR << getName() << " is missing remap for negative values of " << from->getName();
+      if (event.value < 0) {
+        if (!negative_button) {
+          PLOG_ERROR << getName() << " is missing remap for negative values of " << route.from->getName();
           return true;
         }
-        auto other_button = remap.to_negative;
-        if (event.value > 0) {
-          // if to_negative not set, to_console is the right signal to send to
-          modified.value = (event.value >= remap.threshold) ? 1 : 0;
-          }
-        else if (event.value < 0) {
-          to_console = remap.to_negative;
-          other_button = remap.to_console;
-          modified.id = to_console->getID();
-          modified.value = (event.value <= -remap.threshold) ? 1 : 0;
-        }
-        // Zero out the opposite button
-        new_event.id = other_button->getID();
+        modified.id = negative_button->getID();
+        modified.value = 1;
+        release = positive_button;
+      } else {
+        // A neutral three-state value clears the active button.
+        modified.id = positive_button->getID();
+        modified.value = event.value > 0 ? 1 : 0;
+        release = negative_button;
+      }
+      if (release && negative_button != positive_button) {
+        new_event.id = release->getID();
         new_event.value = 0;
         new_event.type = TYPE_BUTTON;
         engine->applyEvent(new_event);
-        // PLOG_DEBUG << "Other button zeroed: " << other_button->getName();
-        break;
       }
-      case ControllerSignalType::THREE_STATE:
-        if (event.value > 0) {
-          modified.value = (event.value >= remap.threshold) ? 1 : 0;
-          }
-        else if (event.value < 0) {
-          modified.value = (event.value <= -remap.threshold) ? -1 : 0;
-        }
-        break;
-   	  }
-      break;
-    case ControllerSignalType::ACCELEROMETER:
-      if (to_console->getType() == ControllerSignalType::AXIS) {
-	      modified.value= ControllerInput::joystickLimit((short) (-event.value/remap.scale));
-      }
-      break;
-    case ControllerSignalType::TOUCHPAD:
-      if (to_console->getType() == ControllerSignalType::AXIS) {
-        modified.value = touchpad.isActive() ? touchpad.getAxisValue(from->getSignal(), event.value) : 0;
+    }
+    break;
+  case RemapTransform::AXIS_TO_BUTTONS:
+    if (event.value == 0) {
+      if (route.to_negative) {
+        // Crossing back to zero should release both mapped buttons.
+        new_event.id = route.to_negative->getID();
+        new_event.type = route.to_negative->getButtonType();
+        new_event.value = 0;
+        engine->applyEvent(new_event);
       }
       break;
-    case ControllerSignalType::DUMMY:
-      PLOG_WARNING << "Remapping from NONE or NOTHING";
-      break;
-    } // end switch
-      if (remap.invert) {
-        modified.value = ControllerInput::joystickLimit(-modified.value);
+    }
+    // When mapping from an axis to buttons/hybrids, the choice of button is determined by the sign
+    // of the value.
+    if (!route.to_negative) {
+      PLOG_ERROR << getName() << " is missing remap for negative values of " << route.from->getName();
+      return true;
+    }
+    {
+      ControllerInput* other_button = route.to_negative;
+      if (event.value > 0) {
+        modified.value = (event.value >= route.threshold) ? 1 : 0;
+      } else {
+        to_console = route.to_negative;
+        other_button = route.to_console;
+        modified.id = to_console->getID();
+        modified.value = (event.value <= -route.threshold) ? 1 : 0;
       }
-    } else if (from->getType() == ControllerSignalType::AXIS &&
-               (to_console->getType() == ControllerSignalType::BUTTON ||
-                to_console->getType() == ControllerSignalType::HYBRID) &&
-               remap.to_negative) {
-      // Crossing back to zero should release both mapped buttons.
-      new_event.id = remap.to_negative->getID();
-      new_event.type = remap.to_negative->getButtonType();
+      // Zero out the opposite button
+      new_event.id = other_button->getID();
       new_event.value = 0;
+      new_event.type = TYPE_BUTTON;
       engine->applyEvent(new_event);
     }
-    if (modified.value != 0) {
-     PLOG_VERBOSE << getName() << ": " << from->getName() << ":" << event.value << " to " << to_console->getName() << "(" 
-     << (int) modified.type << "." << (int) modified.id << "):" << modified.value;
+    break;
+  case RemapTransform::AXIS_TO_THREE_STATE:
+    if (event.value > 0) {
+      modified.value = (event.value >= route.threshold) ? 1 : 0;
+    } else if (event.value < 0) {
+      modified.value = (event.value <= -route.threshold) ? -1 : 0;
     }
-    // Update the event
-    event.id = modified.id;
-    event.type = modified.type;
-    event.value = modified.value;
+    break;
+  case RemapTransform::ACCELEROMETER_TO_AXIS:
+    if (event.value) {
+      modified.value = ControllerInput::joystickLimit((short) (-event.value/route.scale));
+    }
+    break;
+  case RemapTransform::TOUCHPAD_TO_AXIS:
+    if (event.value) {
+      modified.value = touchpad.isActive() ? touchpad.getAxisValue(route.from->getSignal(), event.value) : 0;
+    }
+    break;
+  }
+
+  if (route.invert && modified.value) {
+    modified.value = ControllerInput::joystickLimit(-modified.value);
+  }
+  if (modified.value != 0) {
+   PLOG_VERBOSE << getName() << ": " << route.from->getName() << ":" << event.value << " to " << to_console->getName() << "(" 
+   << (int) modified.type << "." << (int) modified.id << "):" << modified.value;
   }
+  // Update the event
+  event.id = modified.id;
+  event.type = modified.type;
+  event.value = modified.value;
   return true;
 }
@@ -18,7 +18,9 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <array>
 #include <atomic>
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 #include <toml++/toml.h>
@@ -29,7 +31,49 @@
 #include "EngineInterface.hpp"
 
 namespace Chaos {
-  
+
+  /**
+   * \brief The transformation applied by a compiled remap route.
+   *
+   * The kind is resolved once from the source and destination signal classes when the routing
+   * table is compiled, so the per-event path does not have to re-examine signal types.
+   */
+  enum class RemapTransform : uint8_t {
+    TOUCHPAD_ACTIVE,       ///< Start/stop touchpad tracking; the event passes unchanged
+    DROP,                  ///< Remapped to NOTHING; the event is blocked
+    SUBSTITUTE,            ///< Replace the id/type and keep the value
+    BUTTON_TO_LEVEL,       ///< Button to three-state or axis: pressed maps to a fixed level
+    BUTTON_TO_HYBRID,      ///< Button to hybrid: also drive the hybrid's axis
+    HYBRID_TO_HYBRID,      ///< Hybrid to hybrid: keep the axis channel for axis events
+    HYBRID_TO_LEVEL,       ///< Hybrid to button/three-state: threshold the axis component
+    THREE_STATE_TO_AXIS,   ///< Three-state to axis: scale to the axis extremes
+    THREE_STATE_TO_BUTTONS,///< Three-state to a positive/negative button pair
+    AXIS_TO_BUTTONS,       ///< Axis to a positive/negative button pair by sign and threshold
+    AXIS_TO_THREE_STATE,   ///< Axis to three-state by sign and threshold
+    ACCELEROMETER_TO_AXIS, ///< Accelerometer to axis with sensitivity scaling
+    TOUCHPAD_TO_AXIS       ///< Touchpad position to axis through the touchpad helper
+  };
+
+  /**
+   * \brief One entry of a remap modifier's compiled routing table.
+   *
+   * Routes hold non-owning pointers into the game's signal table, which outlives every modifier.
+   */
+  struct RemapRoute {
+    RemapTransform kind;
+    ControllerInput* from;
+    ControllerInput* to_console;
+    ControllerInput* to_negative;
+    uint8_t to_id;
+    uint8_t to_type;
+    uint8_t to_axis;
+    short on_value;
+    short threshold;
+    double scale;
+    bool invert;
+    bool fuzz_filtered;
+  };
+
   /** 
    * \brief A modifier that remaps the game commands to different inputs from the controller.
    *
@@ -82,6 +126,33 @@ namespace Chaos {
      */
     Touchpad touchpad;
 
+    /**
+     * \brief Reusable batch used to zero the disabled signals in a single controller update.
+     */
+    std::vector<DeviceEvent> reset_events;
+
+    /**
+     * \brief Number of slots in the routing table, which covers every (type << 8) + id index
+     * for button and axis events.
+     */
+    static const int ROUTE_SLOTS = 512;
+
+    /**
+     * \brief Compiled form of #remaps.
+     */
+    std::vector<RemapRoute> routes;
+
+    /**
+     * \brief Route lookup by event index. Zero means the signal is not remapped by this mod;
+     * otherwise the value is one more than the position in #routes.
+     */
+    std::array<uint8_t, ROUTE_SLOTS> route_slot;
+
+    /**
+     * \brief Rebuild #routes and #route_slot from the current contents of #remaps.
+     */
+    void compileRoutes();
+
     std::shared_ptr<ControllerInput> lookupInput(const toml::table& config, const std::string& key, bool required);
 
   public:
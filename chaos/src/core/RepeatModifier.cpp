@@ -18,7 +18,9 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "RepeatModifier.hpp"
+#include <cmath>
 #include <cstdint>
+#include <clock.hpp>
 #include "TOMLUtils.hpp"
 #include "GameCommand.hpp"
 #include "ControllerInput.hpp"
@@ -28,7 +30,7 @@ using namespace Chaos;
 const std::string RepeatModifier::mod_type = "repeat";
 
 RepeatModifier::RepeatModifier(toml::table& config, EngineInterface* e) {
-  TOMLUtils::checkValid(config, std::vector<std::string>{
+  TOMLUtils::checkValid(config, {
       "name", "description", "type", "groups", "applies_to", "force_on", "time_on", "time_off",
       "repeat", "cycle_delay", "block_while_busy", "begin_sequence", "finish_sequence", "unlisted"});
   initialize(config, e);
@@ -42,6 +44,16 @@ RepeatModifier::RepeatModifier(toml::table& config, EngineInterface* e) {
   num_cycles = config["repeat"].value_or(1);
   cycle_delay = config["cycle_delay"].value_or(0.0);
 
+  on_ns = std::llround(time_on * Clock::NSEC_PER_SEC);
+  off_ns = std::llround(time_off * Clock::NSEC_PER_SEC);
+  press_period_ns = on_ns + off_ns;
+  burst_ns = (num_cycles > 0) ? press_period_ns * num_cycles : 0;
+  cycle_ns = (burst_ns > 0) ? burst_ns + std::llround(cycle_delay * Clock::NSEC_PER_SEC) : 0;
+  if (cycle_ns <= 0) {
+    PLOG_WARNING << "Modifier " << getName() << " has nothing to repeat: time_on + time_off must be "
+                 << "greater than zero and repeat must be at least 1";
+  }
+
   auto clipForceValue = [&](int raw_value, size_t idx, const char* key) -> short {
     if (idx >= commands.size() || !commands[idx] || !commands[idx]->getInput()) {
       return static_cast<short>(raw_value);
@@ -93,7 +105,7 @@ RepeatModifier::RepeatModifier(toml::table& config, EngineInterface* e) {
   }
 
   PLOG_DEBUG << " - time_on: " << time_on << "; time_off: " << time_off << "; cycle_delay: " << cycle_delay;
-  PLOG_DEBUG << " - repeat: " << repeat_count;
+  PLOG_DEBUG << " - repeat: " << num_cycles;
   if (block_while.empty()) {
     PLOG_DEBUG << " - block_while_busy: NONE";
   } else {
@@ -104,53 +116,83 @@ RepeatModifier::RepeatModifier(toml::table& config, EngineInterface* e) {
 }
 
 void RepeatModifier::begin() {
-  press_time = 0;
-  repeat_count = 0;
-  is_on = false;
+  origin.store(NOT_STARTED);
+  pause_seen = 0;
 }
 
 void RepeatModifier::update() {
-  press_time += timer.dTime();
-  if (repeat_count < num_cycles) {
-    if (press_time > time_on && is_on) {
-      int i = 0;
-      for (auto cmd : commands) {
-        if (i < force_off.size()) {
-          PLOG_DEBUG << "Setting " << cmd->getName() << " to " << force_off[i];
-          engine->setValue(cmd, force_off[i]);
-        } else {
-          PLOG_DEBUG << "Turning " << cmd->getName() << " off";
-          engine->setOff(cmd);
-        }
-        is_on = false;
-        i++;
-      }
-      press_time = 0;
-      repeat_count++;
-    } else if (press_time > time_off && !is_on) {
-      int i = 0;
-      for (auto cmd : commands) {
-        if (i < force_on.size()) {
-          PLOG_DEBUG << "Setting " << cmd->getName() << " to " << force_on[i];
-          engine->setValue(cmd, force_on[i]);
-        } else {
-          PLOG_DEBUG << "Turning " << cmd->getName() << " on";
-          engine->setOn(cmd);
-        }
-        is_on = true;
-        i++;
-      }
-      press_time = 0;
+  if (cycle_ns <= 0) {
+    return;
+  }
+  const int64_t now = timer.lastTime();
+  int64_t not_before;
+  if (origin.load() == NOT_STARTED) {
+    // Count from the previous tick (begin(), or the end of the begin sequence), less any pause
+    const double waited = timer.dTime() - (pause_time_accumulator - pause_seen);
+    const int64_t start = now - std::llround(waited * Clock::NSEC_PER_SEC);
+    origin.store(start);
+    scheduled_until = start;
+    not_before = start;
+  } else if (pause_time_accumulator > pause_seen) {
+    // The scheduler held our changes during the pause. Slide the timeline past it and schedule
+    // whatever remains of the current cycle again.
+    const int64_t shifted = origin.load() +
+        std::llround((pause_time_accumulator - pause_seen) * Clock::NSEC_PER_SEC);
+    origin.store(shifted);
+    engine->cancelScheduled(this);
+    scheduled_until = (now <= shifted) ? shifted : shifted + (now - shifted) / cycle_ns * cycle_ns;
+    not_before = now;
+  } else {
+    not_before = now;
+  }
+  pause_seen = pause_time_accumulator;
+
+  // Keep a whole cycle queued so the first press of the next one never waits on a tick
+  while (scheduled_until <= now + cycle_ns) {
+    scheduleCycle(scheduled_until, not_before);
+    scheduled_until += cycle_ns;
+  }
+}
+
+void RepeatModifier::scheduleCycle(int64_t start, int64_t not_before) {
+  PLOG_DEBUG << "Scheduling repeat cycle of " << getName() << " at " << start;
+  for (int k = 0; k < num_cycles; ++k) {
+    const int64_t press = start + k * press_period_ns + off_ns;
+    if (press >= not_before) {
+      scheduleChange(press, true);
     }
-  } else if (press_time > cycle_delay) {
-    PLOG_DEBUG << "resetting repeat cycle";
-    repeat_count = 0;
-    press_time = 0;
+    if (press + on_ns >= not_before) {
+      scheduleChange(press + on_ns, false);
+    }
+  }
+}
+
+void RepeatModifier::scheduleChange(int64_t when, bool on) {
+  const std::vector<short>& forced = on ? force_on : force_off;
+  size_t i = 0;
+  for (auto& cmd : commands) {
+    if (i < forced.size()) {
+      engine->scheduleValue(when, cmd, forced[i], this);
+    } else if (on) {
+      engine->scheduleOn(when, cmd, this);
+    } else {
+      engine->scheduleOff(when, cmd, this);
+    }
+    i++;
+  }
+}
+
+bool RepeatModifier::isOnAt(int64_t t) const {
+  const int64_t start = origin.load(std::memory_order_relaxed);
+  if (start == NOT_STARTED || t < start || cycle_ns <= 0) {
+    return false;
   }
+  const int64_t phase = (t - start) % cycle_ns;
+  return phase < burst_ns && phase % press_period_ns >= off_ns;
 }
 
 bool RepeatModifier::tweak(DeviceEvent& event) {
-  if (is_on) {
+  if (isOnAt(Clock::now())) {
     if (! force_on.empty()) {
       int i = 0;      
       for (auto& cmd : commands) {
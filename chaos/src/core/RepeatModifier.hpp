@@ -17,7 +17,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #pragma once
-#include <queue>
+#include <atomic>
+#include <cstdint>
 #include <toml++/toml.h>
 #include <timer.hpp>
 #include "Modifier.hpp"
@@ -40,8 +41,6 @@ namespace Chaos {
 
   protected:
     
-    double press_time;
-    bool is_on;
     /**
      * Time in seconds to keep the command on.
      */
@@ -53,11 +52,6 @@ namespace Chaos {
 
     double time_off;
 
-    /**
-     * Running count of how many times we've repeated the cycle
-     */
-    int repeat_count;
-
     /**
      * Total number of times to repeat the cycle
      */
@@ -68,6 +62,37 @@ namespace Chaos {
      */
     double cycle_delay;
 
+    /**
+     * \brief The timeline of one cycle, in nanoseconds.
+     *
+     * Each press period leaves the command off for off_ns and then holds it on for on_ns. A cycle
+     * is num_cycles press periods (burst_ns) followed by the cycle delay.
+     */
+    int64_t on_ns = 0;
+    int64_t off_ns = 0;
+    int64_t press_period_ns = 0;
+    int64_t burst_ns = 0;
+    int64_t cycle_ns = 0;
+
+    static constexpr int64_t NOT_STARTED = INT64_MIN;
+
+    /**
+     * \brief Clock time at which the first cycle started, moved forward by the length of any pauses.
+     *
+     * Read by tweak() on the controller thread.
+     */
+    std::atomic<int64_t> origin{NOT_STARTED};
+
+    /**
+     * Start of the first cycle that has not yet been handed to the engine's scheduler
+     */
+    int64_t scheduled_until = 0;
+
+    /**
+     * Paused time that has already been added to #origin
+     */
+    double pause_seen = 0;
+
     /**
      * The values that we set the commands to while we're in the on state
      */
@@ -85,6 +110,21 @@ namespace Chaos {
      */
     std::vector<std::shared_ptr<GameCommand>> block_while;
     
+    /**
+     * \brief Is the command in its on state at a given time?
+     */
+    bool isOnAt(int64_t t) const;
+
+    /**
+     * \brief Schedule the presses and releases of the cycle starting at a given time.
+     *
+     * \param start Clock time at which the cycle starts
+     * \param not_before Changes earlier than this are skipped
+     */
+    void scheduleCycle(int64_t start, int64_t not_before);
+
+    void scheduleChange(int64_t when, bool on);
+
   public:
 
     /**
@@ -108,7 +148,11 @@ namespace Chaos {
     void begin();
 
     /**
-     * \brief Advance repeat-cycle timing and toggled command state.
+     * \brief Keep the engine's scheduler one cycle ahead of the current time.
+     *
+     * The presses and releases are made by the scheduler at their exact times rather than on
+     * the engine tick that follows them. After a pause, the timeline is moved forward by the
+     * length of the pause and the remaining changes are scheduled again.
      */
     void update();
 
@@ -0,0 +1,104 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "ResponseCurve.hpp"
+
+using namespace Chaos;
+
+namespace {
+short clip(double value) {
+  return static_cast<short>(std::clamp<long>(std::lround(value), JOYSTICK_MIN, JOYSTICK_MAX));
+}
+}
+
+ResponseCurve::ResponseCurve() {
+  for (int i = 0; i < SIZE; ++i) {
+    table[i] = static_cast<short>(i + JOYSTICK_MIN);
+  }
+}
+
+template <typename F> ResponseCurve ResponseCurve::normalized(F shape) {
+  ResponseCurve curve;
+  for (int i = 0; i < SIZE; ++i) {
+    const int x = i + JOYSTICK_MIN;
+    const double full = (x < 0) ? -JOYSTICK_MIN : JOYSTICK_MAX;
+    const double u = std::fabs(x / full);
+    const double y = std::clamp(shape(u), 0.0, 1.0) * full;
+    curve.table[i] = clip((x < 0) ? -y : y);
+  }
+  return curve;
+}
+
+ResponseCurve ResponseCurve::linear(double amplitude, double offset) {
+  ResponseCurve curve;
+  for (int i = 0; i < SIZE; ++i) {
+    const int x = i + JOYSTICK_MIN;
+    // Same arithmetic as the scaling modifier applies to values outside the table
+    curve.table[i] = static_cast<short>(fmin(fmax((int)(amplitude * x + offset), JOYSTICK_MIN),
+                                             JOYSTICK_MAX));
+  }
+  return curve;
+}
+
+ResponseCurve ResponseCurve::fromPoints(const std::vector<std::pair<double, double>>& points) {
+  if (points.size() < 2) {
+    throw std::runtime_error("A response curve needs at least two points");
+  }
+  for (size_t i = 1; i < points.size(); ++i) {
+    if (points[i].first <= points[i - 1].first) {
+      throw std::runtime_error("Response curve points must be listed in order of increasing input");
+    }
+  }
+  ResponseCurve curve;
+  size_t seg = 1;
+  for (int i = 0; i < SIZE; ++i) {
+    const double x = i + JOYSTICK_MIN;
+    if (x <= points.front().first) {
+      curve.table[i] = clip(points.front().second);
+      continue;
+    }
+    if (x >= points.back().first) {
+      curve.table[i] = clip(points.back().second);
+      continue;
+    }
+    while (points[seg].first < x) {
+      ++seg;
+    }
+    const auto& [x0, y0] = points[seg - 1];
+    const auto& [x1, y1] = points[seg];
+    curve.table[i] = clip(y0 + (y1 - y0) * (x - x0) / (x1 - x0));
+  }
+  return curve;
+}
+
+ResponseCurve ResponseCurve::deadzone(double size) {
+  return normalized([size](double u) { return (u <= size) ? 0.0 : (u - size) / (1.0 - size); });
+}
+
+ResponseCurve ResponseCurve::exponential(double exponent) {
+  return normalized([exponent](double u) { return std::pow(u, exponent); });
+}
+
+ResponseCurve ResponseCurve::steps(int count) {
+  return normalized([count](double u) { return std::round(u * count) / count; });
+}
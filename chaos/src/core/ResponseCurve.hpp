@@ -0,0 +1,104 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "signals.hpp"
+
+namespace Chaos {
+
+  /**
+   * \brief A response curve for 8-bit signals, stored as a lookup table.
+   *
+   * The table holds the output for each of the 256 values from JOYSTICK_MIN to JOYSTICK_MAX, so
+   * applying the curve to an event costs one table load however the curve was defined. Values
+   * outside that range, such as those of the motion sensors, are not covered by the table.
+   *
+   * The named curves treat 0 as the centre of the signal and are symmetric about it. A position
+   * is measured as a fraction of full deflection in its direction: 127 and -128 are both 1.0.
+   */
+  class ResponseCurve {
+  public:
+    /**
+     * \brief Number of entries in the table.
+     */
+    static const int SIZE = JOYSTICK_MAX - JOYSTICK_MIN + 1;
+
+    /**
+     * \brief The identity curve.
+     */
+    ResponseCurve();
+
+    /**
+     * \brief The curve `amplitude * x + offset`, truncated toward zero and clipped to the signal.
+     *
+     * This is the transformation applied by the scaling modifier.
+     */
+    static ResponseCurve linear(double amplitude, double offset);
+
+    /**
+     * \brief A piecewise-linear curve through a list of control points.
+     *
+     * \param points (input, output) pairs in signal units, with strictly increasing inputs. Inputs
+     * below the first point or above the last take the output of that point.
+     *
+     * Throws std::runtime_error if there are fewer than two points or the inputs are not in order.
+     */
+    static ResponseCurve fromPoints(const std::vector<std::pair<double, double>>& points);
+
+    /**
+     * \brief Zero out small deflections and stretch the rest over the full range.
+     *
+     * \param size Size of the dead zone as a fraction of full deflection, below 1
+     */
+    static ResponseCurve deadzone(double size);
+
+    /**
+     * \brief Raise the fraction of full deflection to a power, keeping its sign.
+     *
+     * Exponents above 1 give finer control near the centre; exponents below 1 give coarser.
+     */
+    static ResponseCurve exponential(double exponent);
+
+    /**
+     * \brief Round each position to one of a number of evenly spaced levels in each direction.
+     */
+    static ResponseCurve steps(int count);
+
+    /**
+     * \brief Whether a value falls within the table.
+     */
+    static bool covers(int value) { return value >= JOYSTICK_MIN && value <= JOYSTICK_MAX; }
+
+    /**
+     * \brief Output of the curve for a value that the table covers.
+     */
+    short apply(short value) const { return table[value - JOYSTICK_MIN]; }
+
+  private:
+    // Build the table from a function of the fraction of full deflection
+    template <typename F> static ResponseCurve normalized(F shape);
+
+    std::array<short, SIZE> table;
+  };
+
+};
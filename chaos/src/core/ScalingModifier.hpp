@@ -24,6 +24,7 @@
 #include "DeviceEvent.hpp"
 #include "Modifier.hpp"
 #include "EngineInterface.hpp"
+#include "ResponseCurve.hpp"
 
 namespace Chaos {
   class Game;
@@ -31,7 +32,8 @@ namespace Chaos {
    * \brief A modifier that modifies incoming signals according to a linear formula.
    *
    * The incoming signal, x, will be transformed to $amplitude * x + offset$ and clipped to the
-   * min/max values of the signal.
+   * min/max values of the signal. The formula is compiled into ResponseCurve tables when the mod
+   * is loaded, and only values outside the 8-bit range of the tables are computed per event.
    * 
    * The TOML syntax defining menu items is described in chaosConfigFiles.md
    */
@@ -40,6 +42,8 @@ namespace Chaos {
     double amplitude;
     double while_amplitude;
     double offset;
+    ResponseCurve curve;
+    ResponseCurve while_curve;
     
   public:
     
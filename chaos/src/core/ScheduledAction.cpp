@@ -0,0 +1,61 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <limits>
+
+#include "ScheduledAction.hpp"
+
+using namespace Chaos;
+
+// std::push_heap keeps the greatest element at the front, so order by "later than"
+bool ScheduledActionQueue::later(const Entry& a, const Entry& b) {
+  if (a.action.when != b.action.when) {
+    return a.action.when > b.action.when;
+  }
+  return a.order > b.order;
+}
+
+void ScheduledActionQueue::push(const ScheduledAction& action) {
+  heap.push_back(Entry{action, pushed++});
+  std::push_heap(heap.begin(), heap.end(), later);
+}
+
+void ScheduledActionQueue::popDue(int64_t now, std::vector<ScheduledAction>& due) {
+  while (!heap.empty() && heap.front().action.when <= now) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    due.push_back(heap.back().action);
+    heap.pop_back();
+  }
+}
+
+size_t ScheduledActionQueue::cancel(const Modifier* source) {
+  const size_t before = heap.size();
+  heap.erase(std::remove_if(heap.begin(), heap.end(),
+                            [source](const Entry& e) { return e.action.source == source; }),
+             heap.end());
+  if (heap.size() != before) {
+    std::make_heap(heap.begin(), heap.end(), later);
+  }
+  return before - heap.size();
+}
+
+int64_t ScheduledActionQueue::nextDeadline() const {
+  return heap.empty() ? std::numeric_limits<int64_t>::max() : heap.front().action.when;
+}
@@ -0,0 +1,102 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <handle.hpp>
+
+namespace Chaos {
+  class GameCommand;
+  class Modifier;
+
+  /**
+   * \brief A change to a game command that a modifier has asked to be made at a set time.
+   */
+  struct ScheduledAction {
+    enum class Kind : uint8_t { VALUE, ON, OFF };
+
+    /**
+     * Clock time, in nanoseconds, at which to make the change.
+     */
+    int64_t when;
+    Kind kind;
+
+    /**
+     * The value to set. Only used for Kind::VALUE.
+     */
+    short value;
+    Handle<GameCommand> command;
+
+    /**
+     * The modifier that scheduled the action, so that its actions can be cancelled together.
+     */
+    const Modifier* source;
+  };
+
+  /**
+   * \brief Scheduled actions ordered by deadline.
+   *
+   * A binary heap. Actions with the same deadline come out in the order they were pushed, so a
+   * release and a press scheduled for the same instant are applied in the order the modifier
+   * intended. The queue does no locking of its own.
+   */
+  class ScheduledActionQueue {
+  public:
+    void push(const ScheduledAction& action);
+
+    /**
+     * \brief Move every action due at or before a time into a vector, earliest first.
+     *
+     * \param now Current clock time in nanoseconds
+     * \param[out] due Receives the due actions. Existing contents are kept.
+     */
+    void popDue(int64_t now, std::vector<ScheduledAction>& due);
+
+    /**
+     * \brief Drop every action scheduled by a modifier.
+     *
+     * \return Number of actions dropped
+     */
+    size_t cancel(const Modifier* source);
+
+    void clear() { heap.clear(); }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    /**
+     * \brief Deadline of the earliest action, or INT64_MAX if the queue is empty.
+     */
+    int64_t nextDeadline() const;
+
+  private:
+    struct Entry {
+      ScheduledAction action;
+      uint64_t order;
+    };
+
+    static bool later(const Entry& a, const Entry& b);
+
+    std::vector<Entry> heap;
+    uint64_t pushed = 0;
+  };
+
+};
@@ -17,7 +17,8 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
-#include <unistd.h>
+#include <algorithm>
+#include <clock.hpp>
 #include <plog/Log.h>
 
 #include "Sequence.hpp"
@@ -29,17 +30,86 @@ using namespace Chaos;
 
 unsigned int Sequence::press_time;
 unsigned int Sequence::release_time;
+std::atomic<uint64_t> Sequence::jitter_steps{0};
+std::atomic<uint64_t> Sequence::jitter_total_ns{0};
+std::atomic<uint64_t> Sequence::jitter_max_ns{0};
 
 Sequence::Sequence(Controller& c, bool allow_during_menu)
     : controller{c}, allow_during_menu_events{allow_during_menu} {}
 
-void Sequence::addEvent(DeviceEvent event) {
+void Sequence::Block::append(const DeviceEvent& event) {
   events.push_back(event);
+  offsets.push_back(duration);
+  duration += event.time;
+}
+
+Sequence::Timeline::Timeline(const std::vector<std::shared_ptr<const Block>>& blocks) {
+  segments.reserve(blocks.size());
+  for (const auto& block : blocks) {
+    if (block->events.empty()) {
+      continue;
+    }
+    segments.push_back(Segment{block, total});
+    total += block->duration;
+    count += block->events.size();
+  }
+}
+
+Sequence::Timeline::Position Sequence::Timeline::firstPending(uint64_t elapsed) const {
+  // Last segment that starts at or before the elapsed time
+  auto seg = std::upper_bound(segments.begin(), segments.end(), elapsed,
+                              [](uint64_t t, const Segment& s) { return t < s.start; });
+  if (seg == segments.begin()) {
+    return Position{0, 0};
+  }
+  --seg;
+  const auto& offsets = seg->block->offsets;
+  size_t i = std::upper_bound(offsets.begin(), offsets.end(), elapsed - seg->start) - offsets.begin();
+  size_t n = seg - segments.begin();
+  if (i == offsets.size()) {
+    return Position{n + 1, 0};
+  }
+  return Position{n, i};
+}
+
+Sequence::Block& Sequence::appendBlock() {
+  // Grow the open block in place only while #blocks holds the sole other reference to it. A copy
+  // of this sequence would share it too.
+  if (!open_block || open_block.use_count() > 2) {
+    open_block = std::make_shared<Block>();
+    blocks.push_back(open_block);
+  }
+  compiled.reset();
+  return *open_block;
+}
+
+void Sequence::addEvent(DeviceEvent event) {
+  appendBlock().append(event);
 }
 
 void Sequence::addSequence(std::shared_ptr<Sequence> seq) {
   assert (seq);
-  events.insert(events.end(), seq->getEvents().begin(), seq->getEvents().end());
+  // Compiling seals the other sequence's blocks, so sharing them is safe
+  std::shared_ptr<const Timeline> other = seq->getTimeline();
+  for (const auto& segment : other->getSegments()) {
+    blocks.push_back(segment.block);
+  }
+  open_block.reset();
+  compiled.reset();
+}
+
+std::shared_ptr<const Sequence::Timeline> Sequence::getTimeline() {
+  if (!compiled) {
+    compiled = std::make_shared<const Timeline>(blocks);
+    open_block.reset();
+  }
+  return compiled;
+}
+
+std::vector<DeviceEvent> Sequence::getEvents() {
+  std::vector<DeviceEvent> events;
+  getTimeline()->forEach([&events](const DeviceEvent& event, uint64_t) { events.push_back(event); });
+  return events;
 }
 
 void Sequence::addPress(std::shared_ptr<ControllerInput> signal, short value) {
@@ -49,8 +119,8 @@ void Sequence::addPress(std::shared_ptr<ControllerInput> signal, short value) {
 
 void Sequence::addHold(std::shared_ptr<ControllerInput> signal, short value, unsigned int hold_time) {
   assert(signal);
-  short int hybrid_value;  
-  unsigned int hybrid_hold;
+  short int hybrid_value = 0;
+  unsigned int hybrid_hold = 0;
   // If a value is passed for a hybrid signal (L2/R2), it applies to the axis signal. The button
   // signal will just use 1.
   if (signal->getType() == ControllerSignalType::HYBRID) {
@@ -65,9 +135,9 @@ void Sequence::addHold(std::shared_ptr<ControllerInput> signal, short value, uns
   }
   PLOG_DEBUG << "Adding hold: " << signal->getName()
     << ":" << value << " for " << hold_time << " microseconds";
-  events.push_back({hold_time, value, (uint8_t) signal->getButtonType(), signal->getID()});
+  addEvent({hold_time, value, (uint8_t) signal->getButtonType(), signal->getID()});
   if (signal->getType() == ControllerSignalType::HYBRID) {
-    events.push_back( {hybrid_hold, hybrid_value, TYPE_AXIS, signal->getHybridAxis()} );
+    addEvent( {hybrid_hold, hybrid_value, TYPE_AXIS, signal->getHybridAxis()} );
     PLOG_DEBUG << "Adding hold: " << signal->getName()
       << "(axis):" << hybrid_value << " for " << hybrid_hold << " microseconds";
   }
@@ -75,79 +145,137 @@ void Sequence::addHold(std::shared_ptr<ControllerInput> signal, short value, uns
 
 void Sequence::addRelease(std::shared_ptr<ControllerInput> signal, unsigned int release_time) {
   assert(signal);
-  unsigned int hybrid_release;
+  unsigned int hybrid_release = 0;
   if (signal->getType() == ControllerSignalType::HYBRID) {
     hybrid_release = release_time;
     release_time = 0;
   }
   PLOG_DEBUG << "Adding release: " << signal->getName()
     << " for " << release_time << " microseconds";
-  events.push_back({release_time, 0, (uint8_t) signal->getButtonType(), signal->getID()});
+  addEvent({release_time, 0, (uint8_t) signal->getButtonType(), signal->getID()});
   if (signal->getType() == ControllerSignalType::HYBRID) {
     PLOG_DEBUG << "Adding release: " << signal->getName()
       << "(axis) for " << hybrid_release << " microseconds";
-    events.push_back( {hybrid_release, JOYSTICK_MIN, TYPE_AXIS, signal->getHybridAxis()} );
+    addEvent( {hybrid_release, JOYSTICK_MIN, TYPE_AXIS, signal->getHybridAxis()} );
   }
 }
 
 void Sequence::addDelay(unsigned int delay) {
   PLOG_DEBUG << "adding delay of " << delay << "usecs";
-  events.push_back( {delay, 0, 255, 255} );
+  addEvent( {delay, 0, 255, 255} );
 }
 
 void Sequence::send() {
   PLOG_DEBUG << "Sending sequence";
-  for (auto& event : events) {
-    PLOG_DEBUG << "Sending event for input " << ControllerInputTable::canonicalEventName(event)
-	       << " value=" << (int) event.value << "; sleeping for " << (int) event.time << " microseconds";
-    controller.dispatchEvent(event, allow_during_menu_events);
-    if (event.time > 0) {
-      usleep(event.time);
+  play(*getTimeline(), controller, allow_during_menu_events);
+}
+
+bool Sequence::play(const Timeline& timeline, Controller& controller,
+                    bool allow_during_menu, const std::atomic<bool>* cancel) {
+  const int64_t start = Clock::now();
+  uint64_t steps = 0;
+  uint64_t total_late = 0;
+  uint64_t max_late = 0;
+  bool completed = true;
+  for (const auto& segment : timeline.getSegments()) {
+    const Block& block = *segment.block;
+    for (size_t i = 0; i < block.events.size(); ++i) {
+      const DeviceEvent& event = block.events[i];
+      if (cancel && cancel->load()) {
+        completed = false;
+        break;
+      }
+      PLOG_DEBUG << "Sending event for input " << ControllerInputTable::canonicalEventName(event)
+	         << " value=" << (int) event.value << "; holding for " << (int) event.time << " microseconds";
+      controller.dispatchEvent(event, allow_during_menu);
+      if (event.time > 0) {
+        const int64_t deadline =
+            start + (int64_t) (segment.start + block.offsets[i] + event.time) * 1000;
+        Clock::sleepUntil(deadline);
+        int64_t late = Clock::now() - deadline;
+        uint64_t late_ns = (late > 0) ? (uint64_t) late : 0;
+        ++steps;
+        total_late += late_ns;
+        max_late = std::max(max_late, late_ns);
+      }
     }
+    if (!completed) {
+      break;
+    }
+  }
+  if (steps > 0) {
+    PLOG_DEBUG << "Sequence timing: " << steps << " timed steps, mean lateness "
+               << total_late / steps / 1000.0 << " us, max " << max_late / 1000.0 << " us";
+    jitter_steps.fetch_add(steps, std::memory_order_relaxed);
+    jitter_total_ns.fetch_add(total_late, std::memory_order_relaxed);
+    uint64_t prior = jitter_max_ns.load(std::memory_order_relaxed);
+    while (max_late > prior &&
+           !jitter_max_ns.compare_exchange_weak(prior, max_late, std::memory_order_relaxed)) {}
   }
+  return completed;
+}
+
+Json::Value Sequence::getJitterStats() {
+  Json::Value stats;
+  uint64_t steps = jitter_steps.load(std::memory_order_relaxed);
+  stats["steps"] = (Json::UInt64) steps;
+  stats["mean_late_us"] = steps ? jitter_total_ns.load(std::memory_order_relaxed) / 1000.0 / steps : 0.0;
+  stats["max_late_us"] = jitter_max_ns.load(std::memory_order_relaxed) / 1000.0;
+  return stats;
+}
+
+void Sequence::resetJitterStats() {
+  jitter_steps.store(0, std::memory_order_relaxed);
+  jitter_total_ns.store(0, std::memory_order_relaxed);
+  jitter_max_ns.store(0, std::memory_order_relaxed);
 }
 
 bool Sequence::sendParallel(double sequenceTime) {
-  unsigned int elapsed = (unsigned int) (sequenceTime * SEC_TO_MICROSEC);
-  while (current_step < events.size()) {
-    DeviceEvent e = events[current_step];
-    if (e.isDelay()) {
-      // pure delay (no attatched event to apply)
-      wait_until += e.time;
-      PLOG_DEBUG << "Delay of " << e.time << "usecs";
-      // Advance past the delay marker so subsequent calls can proceed to the next real event.
-      ++current_step;
-    } else {
-      // return until delay expires, then move to the next step
-      if (elapsed < wait_until) {
-        return false;
-      }
-      // send out events until we hit the next delay
-      PLOG_DEBUG << "Parallel step " << current_step << ": signal = "
-        << ControllerInputTable::canonicalEventName(e) << " value = " << e.value << " next delay = " << e.time <<
-        "; elapsed usec=" << elapsed;
+  const Timeline& timeline = *getTimeline();
+  const uint64_t elapsed = (uint64_t) (sequenceTime * SEC_TO_MICROSEC);
+  const Timeline::Position due = timeline.firstPending(elapsed);
+  const auto& segments = timeline.getSegments();
+  // Send everything between where we left off and the first event not yet due
+  while (next_step.segment < due.segment ||
+         (next_step.segment == due.segment && next_step.event < due.event)) {
+    const Block& block = *segments[next_step.segment].block;
+    const DeviceEvent& e = block.events[next_step.event];
+    // Pure delays have no attached event to apply
+    if (!e.isDelay()) {
+      PLOG_DEBUG << "Parallel step at " << segments[next_step.segment].start + block.offsets[next_step.event]
+                 << " usec: signal = " << ControllerInputTable::canonicalEventName(e)
+                 << " value = " << e.value << " next delay = " << e.time << "; elapsed usec=" << elapsed;
       controller.dispatchEvent(e, allow_during_menu_events);
-      wait_until += e.time;
-      ++current_step;
+    }
+    if (++next_step.event == block.events.size()) {
+      ++next_step.segment;
+      next_step.event = 0;
     }
   }
-  // We're at the end of the sequence. Wait for any final delay from the last step
-  if (elapsed < wait_until) {
+  // We're done once every event is sent and the last one's hold time has passed
+  if (next_step.segment < segments.size() || elapsed < timeline.duration()) {
     return false;
   }
-  // Now we're actually done. Reset the steps and time for the next iteration
+  // Now we're actually done. Reset for the next iteration
   PLOG_DEBUG << "parallel send finished";
-  current_step = 0;
-  wait_until = 0;
+  next_step = Timeline::Position{};
   return true;
 }
 
 void Sequence::clear() {
-    events.clear();
+  blocks.clear();
+  open_block.reset();
+  compiled.reset();
+  next_step = Timeline::Position{};
 }
 
 bool Sequence::empty() {
-  return events.empty();
+  for (const auto& block : blocks) {
+    if (!block->events.empty()) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void Sequence::setPressTime(double time) {
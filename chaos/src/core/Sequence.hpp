@@ -18,8 +18,11 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
+#include <json/json.h>
 #include "DeviceEvent.hpp"
 
 #define SEC_TO_MICROSEC 1000000.0
@@ -37,21 +40,129 @@ namespace Chaos {
    * The valid keys within each sequence step are the following:
    * - event: The type of signal event.
    * - command: The command that should be sent.
+   *
+   * Events are stored in immutable blocks, each of which records the time of every event from the
+   * start of the block. A sequence is a list of blocks: those holding its own events and those of
+   * any predefined sequences it includes, which are shared rather than copied. Before it is played,
+   * the list is compiled into a Timeline that gives each block its start time, so that the events
+   * due at a given moment can be found by binary search.
    * 
    * \todo: Use the chrono library to ensure our time units are consistent
    */
   class Sequence {
+  public:
+    /**
+     * \brief A run of events, with the time of each from the start of the run.
+     *
+     * Blocks are never modified once they belong to a compiled timeline.
+     */
+    struct Block {
+      std::vector<DeviceEvent> events;
+
+      /**
+       * Time in microseconds from the start of the block at which each event is sent
+       */
+      std::vector<uint64_t> offsets;
+
+      /**
+       * Length of the block in microseconds, including the hold time of the last event
+       */
+      uint64_t duration = 0;
+
+      void append(const DeviceEvent& event);
+    };
+
+    /**
+     * \brief The compiled, immutable form of a sequence, with the start time of each block.
+     */
+    class Timeline {
+    public:
+      struct Segment {
+        std::shared_ptr<const Block> block;
+        uint64_t start;
+      };
+
+      /**
+       * \brief Place in a timeline: a segment and an event within it.
+       */
+      struct Position {
+        size_t segment = 0;
+        size_t event = 0;
+      };
+
+      explicit Timeline(const std::vector<std::shared_ptr<const Block>>& blocks);
+
+      const std::vector<Segment>& getSegments() const { return segments; }
+
+      /**
+       * \brief Total length in microseconds.
+       */
+      uint64_t duration() const { return total; }
+
+      /**
+       * \brief Number of events, including delays.
+       */
+      size_t size() const { return count; }
+
+      bool empty() const { return count == 0; }
+
+      /**
+       * \brief Position of the first event that is not yet due a given time after the start.
+       *
+       * \param elapsed Time in microseconds since the timeline started
+       *
+       * An event is due once the elapsed time reaches its start time. Found by binary search over
+       * the segments and then over the event offsets of one block.
+       */
+      Position firstPending(uint64_t elapsed) const;
+
+      /**
+       * \brief Position after the last event.
+       */
+      Position end() const { return Position{segments.size(), 0}; }
+
+      /**
+       * \brief Call a function on every event in order.
+       *
+       * \param f Called with each event and its time in microseconds from the start of the timeline
+       */
+      template <typename F>
+      void forEach(F f) const {
+        for (const auto& seg : segments) {
+          for (size_t i = 0; i < seg.block->events.size(); ++i) {
+            f(seg.block->events[i], seg.start + seg.block->offsets[i]);
+          }
+        }
+      }
+
+    private:
+      std::vector<Segment> segments;
+      uint64_t total = 0;
+      size_t count = 0;
+    };
+
   protected:
-    std::vector<DeviceEvent> events;
+    /**
+     * Blocks making up the sequence, in order
+     */
+    std::vector<std::shared_ptr<const Block>> blocks;
+
+    /**
+     * The last block in #blocks while this sequence is still appending its own events to it.
+     * Reset once the block is compiled into a timeline, so that the timeline never changes.
+     */
+    std::shared_ptr<Block> open_block;
+
+    /**
+     * Timeline compiled from #blocks, or null if the sequence has changed since it was compiled
+     */
+    std::shared_ptr<const Timeline> compiled;
+
     Controller& controller;
     bool allow_during_menu_events;
 
-    // to track current stage for sending the sequence in parallel
-    short current_step = 0;
-
-    // running tracker of elapsed time in microseconds to wait before sending the next sequence
-    // in parallel
-    unsigned int wait_until = 0;
+    // Position in the timeline for sending the sequence in parallel
+    Timeline::Position next_step;
 
     // Time in microseconds to hold down a signal for a button press
     static unsigned int press_time;
@@ -59,6 +170,16 @@ namespace Chaos {
     // Time in microseconds to release a signal for a button press before going on to the next command.
     static unsigned int release_time;
 
+    // How late each timed step of a played sequence woke up relative to its deadline
+    static std::atomic<uint64_t> jitter_steps;
+    static std::atomic<uint64_t> jitter_total_ns;
+    static std::atomic<uint64_t> jitter_max_ns;
+
+    /**
+     * \brief Block that new events of this sequence go into, started if need be.
+     */
+    Block& appendBlock();
+
   public:
     /**
      * \brief Construct an empty sequence bound to a controller.
@@ -132,6 +253,9 @@ namespace Chaos {
      * \brief Append all events from another sequence.
      *
      * \param seq Sequence whose events should be appended.
+     *
+     * The other sequence's blocks are shared, not copied. Later changes to either sequence do not
+     * affect the other.
      */
     void addSequence(std::shared_ptr<Sequence> seq);
 
@@ -143,22 +267,67 @@ namespace Chaos {
      * Send the precomposed sequence of events to the console.
      */
     virtual void send();
+
+    /**
+     * \brief The sequence in compiled form.
+     *
+     * The timeline is built on first use after a change and shared until the next one. Holders of
+     * the timeline may keep it after the sequence is changed or destroyed.
+     */
+    std::shared_ptr<const Timeline> getTimeline();
+
+    /**
+     * \brief Send a timeline, holding each event for its time against absolute deadlines.
+     *
+     * \param timeline The events to send
+     * \param controller Controller that receives the events
+     * \param allow_during_menu Whether the events may be sent during menu navigation
+     * \param cancel If given, playback stops before the next event once this becomes true
+     * \return false if playback was cancelled
+     *
+     * Each step's deadline is the sequence start time plus the step's offset in the timeline, and
+     * we sleep until that deadline on the monotonic clock. Scheduler overshoot on one step is thus
+     * absorbed by the next one instead of accumulating over the sequence. How late each step woke
+     * up is added to the jitter statistics.
+     */
+    static bool play(const Timeline& timeline, Controller& controller,
+                     bool allow_during_menu, const std::atomic<bool>* cancel = nullptr);
+
+    /**
+     * \brief Report how late sequence steps have woken relative to their deadlines.
+     *
+     * Reports the number of timed steps and the mean and maximum lateness in microseconds.
+     */
+    static Json::Value getJitterStats();
+
+    /**
+     * \brief Clear the jitter statistics.
+     */
+    static void resetJitterStats();
     /**
      * Empty the event queue
      */
     void clear();
 
     /**
-     * \brief Access the underlying event list for inspection.
+     * \brief Can this sequence's events be sent while menu navigation blocks other input?
      */
-    std::vector<DeviceEvent>& getEvents() { return events; }
+    bool allowsDuringMenu() const { return allow_during_menu_events; }
 
     /**
-     * \brief Return the nth step in the sequence of events
+     * \brief Copy of the events in order, for inspection.
+     */
+    std::vector<DeviceEvent> getEvents();
+
+    /**
+     * \brief Send the events that have come due since the last call
      * 
-     * \param sequenceTime 
+     * \param sequenceTime Time in seconds since the sequence started
      * \return true if sequence is done
      * \return false if sequence is still in progress
+     *
+     * The position to send up to is found by binary search, so a call costs the same however far
+     * into the sequence it is.
      */
     bool sendParallel(double sequenceTime);
     
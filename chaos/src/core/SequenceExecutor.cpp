@@ -0,0 +1,95 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <plog/Log.h>
+
+#include "SequenceExecutor.hpp"
+#include "Sequence.hpp"
+#include "Controller.hpp"
+
+using namespace Chaos;
+
+SequenceExecutor::SequenceExecutor(Controller& c) : controller{c} {}
+
+SequenceExecutor::~SequenceExecutor() {
+  shutdown();
+}
+
+void SequenceExecutor::submit(Sequence& seq, std::function<void()> on_complete) {
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    queue.push_back(Job{seq.getTimeline(), seq.allowsDuringMenu(), std::move(on_complete)});
+  }
+  queue_changed.notify_all();
+}
+
+bool SequenceExecutor::busy() {
+  std::lock_guard<std::mutex> guard(queue_mutex);
+  return playing || !queue.empty();
+}
+
+void SequenceExecutor::waitUntilIdle() {
+  std::unique_lock<std::mutex> guard(queue_mutex);
+  queue_changed.wait(guard, [this]() { return (!playing && queue.empty()) || stopping.load(); });
+}
+
+void SequenceExecutor::shutdown() {
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    stopping.store(true);
+    queue.clear();
+  }
+  queue_changed.notify_all();
+  WaitForInternalThreadToExit();
+}
+
+void SequenceExecutor::doAction() {
+  Job job;
+  {
+    std::unique_lock<std::mutex> guard(queue_mutex);
+    // Wake periodically so that a stop request is noticed even with nothing queued
+    queue_changed.wait_for(guard, std::chrono::milliseconds(50),
+                           [this]() { return !queue.empty() || stopping.load(); });
+    if (queue.empty() || stopping.load()) {
+      return;
+    }
+    job = std::move(queue.front());
+    queue.pop_front();
+    playing = true;
+  }
+
+  play(job);
+
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    playing = false;
+  }
+  if (!stopping.load() && job.on_complete) {
+    job.on_complete();
+  }
+  queue_changed.notify_all();
+}
+
+void SequenceExecutor::play(Job& job) {
+  PLOG_DEBUG << "Playing sequence of " << job.timeline->size() << " events";
+  if (!Sequence::play(*job.timeline, controller, job.allow_during_menu, &stopping)) {
+    PLOG_DEBUG << "Sequence abandoned on shutdown";
+  }
+}
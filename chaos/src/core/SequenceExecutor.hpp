@@ -0,0 +1,95 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <thread.hpp>
+
+#include "Sequence.hpp"
+
+namespace Chaos {
+  class Controller;
+
+  /**
+   * \brief Plays sequences on a thread of its own so that the caller does not block.
+   *
+   * Sequences are played one at a time, in the order they were submitted, so a menu restore that
+   * is queued behind a menu change always runs after it. Each sequence's compiled timeline is
+   * taken when it is submitted, and the optional completion callback is invoked on the executor
+   * thread once the last event (and its trailing delay) has been sent. Callers that need the callback to run on
+   * another thread must hand it off themselves.
+   */
+  class SequenceExecutor : public Thread {
+  public:
+    /**
+     * \brief Construct an executor that sends its events to the given controller.
+     */
+    SequenceExecutor(Controller& c);
+
+    ~SequenceExecutor();
+
+    /**
+     * \brief Queue a sequence to be played.
+     *
+     * \param seq The sequence to play. Its timeline is shared, not copied, and later changes to
+     * the sequence do not affect it, so the caller may reuse or discard it at once.
+     * \param on_complete Invoked after the sequence has finished playing
+     */
+    void submit(Sequence& seq, std::function<void()> on_complete = nullptr);
+
+    /**
+     * \brief Is a sequence playing or waiting to be played?
+     */
+    bool busy();
+
+    /**
+     * \brief Block until every queued sequence has been played.
+     */
+    void waitUntilIdle();
+
+    /**
+     * \brief Stop the executor thread. Sequences not yet played are discarded.
+     */
+    void shutdown();
+
+  private:
+    struct Job {
+      std::shared_ptr<const Sequence::Timeline> timeline;
+      bool allow_during_menu;
+      std::function<void()> on_complete;
+    };
+
+    Controller& controller;
+    std::mutex queue_mutex;
+    std::condition_variable queue_changed;
+    std::deque<Job> queue;
+    bool playing = false;
+    std::atomic<bool> stopping{false};
+
+    void doAction() override;
+    void play(Job& job);
+  };
+
+};
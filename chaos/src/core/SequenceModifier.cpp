@@ -32,7 +32,7 @@ const std::string SequenceModifier::mod_type = "sequence";
 
 SequenceModifier::SequenceModifier(toml::table& config, EngineInterface* e) {
 
-  TOMLUtils::checkValid(config, std::vector<std::string>{
+  TOMLUtils::checkValid(config, {
       "name", "description", "type", "groups", "begin_sequence", "finish_sequence",
       "block_while_busy", "repeat_sequence", "trigger", "while", "while_operation",
       "start_delay", "cycle_delay", "unlisted"});
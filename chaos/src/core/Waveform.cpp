@@ -0,0 +1,96 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <array>
+#include <cmath>
+
+#include "Waveform.hpp"
+
+using namespace Chaos;
+
+namespace {
+  constexpr double TWO_PI = 2.0 * M_PI;
+  constexpr double Q32 = 4294967296.0;
+
+  const std::array<int16_t, 1 << Waveform::TABLE_BITS>& sineTable() {
+    static const std::array<int16_t, 1 << Waveform::TABLE_BITS> table = []() {
+      std::array<int16_t, 1 << Waveform::TABLE_BITS> t{};
+      for (size_t i = 0; i < t.size(); ++i) {
+        t[i] = static_cast<int16_t>(std::lround(32767.0 * std::sin(TWO_PI * i / t.size())));
+      }
+      return t;
+    }();
+    return table;
+  }
+
+  // Integer division that truncates toward zero, matching a cast of the double formula to int
+  inline int scaleDown(int64_t value, unsigned shift) {
+    return static_cast<int>(value / (int64_t(1) << shift));
+  }
+}
+
+Waveform::Waveform(FormulaTypes t, double amp, size_t slots) :
+  type{t}, amplitude{std::llround(amp * 65536.0)}, slot_phase(slots, 0) {
+  for (size_t i = 0; i < slots; ++i) {
+    if (type == FormulaTypes::EIGHT_CURVE) {
+      slot_phase[i] = phase(1.6 / TWO_PI);
+    } else if (type == FormulaTypes::JANKY) {
+      slot_phase[i] = phase(4.0 * i / TWO_PI);
+    }
+  }
+  // Build the table now rather than on the first update
+  sineTable();
+}
+
+Waveform::Phase Waveform::phase(double periods) {
+  return static_cast<Phase>(std::llround(periods * Q32));
+}
+
+int32_t Waveform::sine(uint32_t angle) {
+  // Round to the nearest table entry. The addition wraps at a full turn, as the angle does.
+  constexpr unsigned shift = 32 - TABLE_BITS;
+  return sineTable()[(angle + (1u << (shift - 1))) >> shift];
+}
+
+int Waveform::offset(size_t slot, Phase p) const {
+  switch (type) {
+  case FormulaTypes::CIRCLE:
+    // amplitude * sin(t) on the first axis of each pair, amplitude * cos(t) on the second
+    return scaleDown(amplitude * ((slot % 2 == 0) ? sine(p) : cosine(p)), 31);
+  case FormulaTypes::EIGHT_CURVE: {
+    // amplitude * sin(4(i+1)(t+1.6)). Integer multiples of the phase wrap cleanly.
+    const uint32_t angle = static_cast<uint32_t>(4 * (slot + 1) * (p + slot_phase[slot]));
+    return scaleDown(amplitude * sine(angle), 31);
+  }
+  case FormulaTypes::JANKY: {
+    // amplitude * (cos(t+4i) + cos(2t)/2) * sin((t+4i)/5) / 2. The division by 5 needs the
+    // whole-period count, so it works on the full 64-bit phase.
+    const Phase shifted = p + slot_phase[slot];
+    const int64_t sum = 2 * cosine(static_cast<uint32_t>(shifted)) +
+                        cosine(static_cast<uint32_t>(2 * p));
+    const int64_t product = sum * sine(static_cast<uint32_t>(shifted / 5));
+    // sum carries a factor of 2, product is Q30, amplitude is Q16, and the formula halves it
+    return scaleDown(amplitude * product, 16 + 30 + 2);
+  }
+  case FormulaTypes::RANDOM_OFFSET:
+  case FormulaTypes::EXPRESSION:
+    break;
+  }
+  return 0;
+}
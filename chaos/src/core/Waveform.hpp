@@ -0,0 +1,100 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Chaos {
+
+  enum class FormulaTypes {
+    CIRCLE, EIGHT_CURVE, JANKY, RANDOM_OFFSET, EXPRESSION
+  };
+
+  /**
+   * \brief Fixed-point evaluation of the built-in formula waveforms.
+   *
+   * Time enters as a phase in 32.32 fixed point: the upper 32 bits count whole periods and the
+   * lower 32 bits are the fraction of the current period. Sines come from a single shared table
+   * in Q15, so an update costs a few integer operations per axis instead of several calls to
+   * std::sin and std::cos. The result agrees with the double-precision formulas to within one
+   * step of an 8-bit axis.
+   *
+   * Random offsets and user-defined expressions are computed by the modifier itself, so those
+   * types always return 0 here.
+   */
+  class Waveform {
+  public:
+    Waveform() = default;
+
+    /**
+     * \brief Phase in periods, in 32.32 fixed point.
+     */
+    using Phase = uint64_t;
+
+    /**
+     * \brief Number of bits used to index the sine table.
+     */
+    static const unsigned TABLE_BITS = 12;
+
+    /**
+     * \brief Build the waveform for a number of axes.
+     *
+     * \param type Formula to evaluate
+     * \param amplitude Peak offset, in axis units
+     * \param slots Number of axes the formula is applied to
+     */
+    Waveform(FormulaTypes type, double amplitude, size_t slots);
+
+    /**
+     * \brief Convert a time measured in periods to a fixed-point phase.
+     */
+    static Phase phase(double periods);
+
+    /**
+     * \brief Offset for one axis at the given phase.
+     *
+     * \param slot Position of the axis in the modifier's list of commands
+     * \param p Phase of the waveform
+     * \return The offset, truncated toward zero as the double-precision formula would be
+     */
+    int offset(size_t slot, Phase p) const;
+
+    /**
+     * \brief Table sine of a fraction of a turn, in Q15.
+     *
+     * \param angle Angle, where 2^32 is one full turn
+     */
+    static int32_t sine(uint32_t angle);
+
+    /**
+     * \brief Table cosine of a fraction of a turn, in Q15.
+     */
+    static int32_t cosine(uint32_t angle) { return sine(angle + (1u << 30)); }
+
+  private:
+    FormulaTypes type = FormulaTypes::RANDOM_OFFSET;
+    // Amplitude in Q16
+    int64_t amplitude = 0;
+    // Per-axis phase offsets: 1.6 rad for the eight curve, 4i rad for the janky pattern
+    std::vector<Phase> slot_phase;
+  };
+
+};
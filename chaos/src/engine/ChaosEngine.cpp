@@ -17,6 +17,7 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <array>
 #include <iostream>
 #include <memory>
 #include <unistd.h>
@@ -24,8 +25,10 @@
 #include <algorithm>
 #include <cctype>
 #include <vector>
+#include <filesystem>
 #include <plog/Log.h>
 #include <toml++/toml.h>
+#include <clock.hpp>
 
 #include "ChaosEngine.hpp"
 #include <ControllerInput.hpp>
@@ -34,17 +37,6 @@
 using namespace Chaos;
 
 namespace {
-  struct ScopedMenuNavigation {
-    std::function<void()> on_exit;
-
-    ScopedMenuNavigation(std::function<void()> on_enter, std::function<void()> on_leave)
-        : on_exit(std::move(on_leave)) {
-      on_enter();
-    }
-
-    ~ScopedMenuNavigation() { on_exit(); }
-  };
-
   bool looksLikeAbsoluteUri(const std::string& value) {
     std::string trimmed = value;
     trimmed.erase(trimmed.begin(),
@@ -88,11 +80,8 @@ namespace {
   }
 }
 
-bool ChaosEngine::dispatchControllerEvent(const DeviceEvent& event,
-                                          const std::function<void(const DeviceEvent&)>& apply,
-                                          bool allow_during_menu) {
+bool ChaosEngine::acquireControllerDispatch(bool allow_during_menu) {
   if (allow_during_menu) {
-    apply(event);
     return true;
   }
 
@@ -108,13 +97,44 @@ bool ChaosEngine::dispatchControllerEvent(const DeviceEvent& event,
     controller_dispatch_inflight.fetch_sub(1, std::memory_order_acq_rel);
     return false;
   }
+  return true;
+}
+
+void ChaosEngine::releaseControllerDispatch(bool allow_during_menu) {
+  if (!allow_during_menu) {
+    controller_dispatch_inflight.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
 
+bool ChaosEngine::dispatchControllerEvent(const DeviceEvent& event,
+                                          FunctionRef<void(const DeviceEvent&)> apply,
+                                          bool allow_during_menu) {
+  if (!acquireControllerDispatch(allow_during_menu)) {
+    return false;
+  }
   apply(event);
-  controller_dispatch_inflight.fetch_sub(1, std::memory_order_acq_rel);
+  releaseControllerDispatch(allow_during_menu);
+  return true;
+}
+
+bool ChaosEngine::dispatchControllerEvents(const std::vector<DeviceEvent>& events,
+                                           FunctionRef<void(const std::vector<DeviceEvent>&)> apply,
+                                           bool allow_during_menu) {
+  if (!acquireControllerDispatch(allow_during_menu)) {
+    return false;
+  }
+  apply(events);
+  releaseControllerDispatch(allow_during_menu);
   return true;
 }
 
+// Menu sequences can queue up behind one another (e.g., a menu mod that sets several items).
+// Gameplay input stays blocked from the first until the last has played. Both this and
+// endMenuNavigation() run on the engine thread.
 void ChaosEngine::beginMenuNavigation() {
+  if (menu_sequences_pending.fetch_add(1) > 0) {
+    return;
+  }
   menu_navigation_transitioning.store(true, std::memory_order_release);
   clearPendingInjectedEventsForMenu();
   while (controller_dispatch_inflight.load(std::memory_order_acquire) != 0) {
@@ -125,14 +145,54 @@ void ChaosEngine::beginMenuNavigation() {
 }
 
 void ChaosEngine::endMenuNavigation() {
-  menu_navigation_active.store(false, std::memory_order_release);
+  if (menu_sequences_pending.fetch_sub(1) == 1) {
+    menu_navigation_active.store(false, std::memory_order_release);
+  }
+}
+
+void ChaosEngine::playSequence(Sequence& seq, std::function<void()> on_complete) {
+  if (Clock::isVirtual()) {
+    // A replay drives everything from one thread, so play inline to keep the result repeatable.
+    // Waits within the sequence advance the virtual clock.
+    Sequence::play(*seq.getTimeline(), controller, seq.allowsDuringMenu());
+    if (on_complete) {
+      std::lock_guard<std::mutex> guard(completed_sequences_mutex);
+      completed_sequences.push_back(on_complete);
+    }
+    return;
+  }
+  if (!on_complete) {
+    sequencer.submit(seq);
+    return;
+  }
+  // Hand the callback back to the engine thread rather than running it on the executor
+  sequencer.submit(seq, [this, on_complete]() {
+    std::lock_guard<std::mutex> guard(completed_sequences_mutex);
+    completed_sequences.push_back(on_complete);
+  });
+}
+
+void ChaosEngine::runCompletedSequenceCallbacks() {
+  std::vector<std::function<void()>> callbacks;
+  {
+    std::lock_guard<std::mutex> guard(completed_sequences_mutex);
+    callbacks.swap(completed_sequences);
+  }
+  for (auto& callback : callbacks) {
+    callback();
+  }
 }
 
 ChaosEngine::ChaosEngine(Controller& c, const std::string& listener_endpoint,
                          const std::string& talker_endpoint, bool enable_interface,
                          const std::string& default_mod_list_uri_base) :
-  controller{c}, game{c}, pause{true}
+  controller{c}, game{c}, sequencer{c},
+  scheduler{[this](const ScheduledAction& action) { applyScheduled(action); },
+            [this]() { return pause.load() || hold_scheduled.load(); }},
+  pause{true}
 {
+  sequencer.start();
+  scheduler.start();
   time.initialize();
   jsonReader = jsonReaderBuilder.newCharReader();
   controller.addInjector(this);
@@ -148,6 +208,12 @@ ChaosEngine::ChaosEngine(Controller& c, const std::string& listener_endpoint,
   }
 }
 
+ChaosEngine::~ChaosEngine() {
+  WaitForInternalThreadToExit();
+  scheduler.shutdown();
+  sequencer.shutdown();
+}
+
 void ChaosEngine::setAvailableGames(const std::vector<std::pair<std::string, std::string>>& games) {
   Json::Value payload(Json::arrayValue);
   std::unordered_map<std::string, std::string> discovered_configs;
@@ -205,10 +271,13 @@ bool ChaosEngine::setGame(const std::string& name) {
   lock();
   mods_to_finish.assign(modifiers.begin(), modifiers.end());
   modifiers.clear();
+  rebuildPipeline();
   modifiersThatNeedToStart.clear();
   modifiersThatNeedToStop.clear();
+  scheduler.clear();
 
   bool loaded = game.loadConfigFile(name, this);
+  flight_recorder.setModifierNames(game.getModNames());
   current_game_mod_list_uri = loaded ? resolveModListUri(game.getModListLocation()) : "";
   current_game_config_path = name;
   bool playable = loaded && (game.getErrors() == 0);
@@ -239,16 +308,36 @@ bool ChaosEngine::setGame(const std::string& name) {
 
 void ChaosEngine::newCommand(const std::string& command) {
   PLOG_DEBUG << "Received command: " << command;
-	
-  Json::Value root;
+
+  PendingCommand cmd;
+  cmd.received = std::chrono::steady_clock::now();
   std::string errs;
-  bool parsingSuccessful = jsonReader->parse(command.c_str(), command.c_str() + command.length(), &root, &errs);
+  bool parsingSuccessful = jsonReader->parse(command.c_str(), command.c_str() + command.length(), &cmd.root, &errs);
 	
   if (!parsingSuccessful) {
     PLOG_ERROR << "Json parsing failed: " << errs << "; command = " << command;
     return;
   }
-  std::string command_id = root.isMember("command_id") ? root["command_id"].asString() : "";
+  cmd.text = command;
+  cmd.command_id = cmd.root.isMember("command_id") ? cmd.root["command_id"].asString() : "";
+  commands.post(std::move(cmd));
+}
+
+// Runs on the engine thread, outside the engine lock
+void ChaosEngine::applyCommand(PendingCommand& cmd) {
+  uint64_t latency = (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - cmd.received).count();
+  command_count.fetch_add(1, std::memory_order_relaxed);
+  command_latency_total_ns.fetch_add(latency, std::memory_order_relaxed);
+  uint64_t worst = command_latency_max_ns.load(std::memory_order_relaxed);
+  while (latency > worst &&
+         !command_latency_max_ns.compare_exchange_weak(worst, latency, std::memory_order_relaxed)) {
+  }
+  PLOG_DEBUG << "Applying command " << cmd.text << " after " << latency / 1000 << " us";
+
+  const Json::Value& root = cmd.root;
+  const std::string& command = cmd.text;
+  const std::string& command_id = cmd.command_id;
 
   if (root.isMember("pause")) {
     bool should_pause = root["pause"].asBool();
@@ -286,9 +375,13 @@ void ChaosEngine::newCommand(const std::string& command) {
       }
       // Remove stale queue entries first.
       modifiersThatNeedToStart.remove(mod);
-      modifiersThatNeedToStop.remove(mod);
+      auto active = modifiers.find(mod);
+      bool already_active = (active != modifiers.end());
+      if (already_active) {
+        modifiersThatNeedToStop.remove(active.id());
+      }
 
-      bool already_active = (std::find(modifiers.begin(), modifiers.end(), mod) != modifiers.end());
+      winner_ok = true;
       if (already_active) {
         double extended_lifespan = mod->lifetime() + time_active;
         mod->setLifespan(extended_lifespan);
@@ -299,9 +392,13 @@ void ChaosEngine::newCommand(const std::string& command) {
         winner_message = "modifier_applied";
         PLOG_INFO << "Adding Modifier: " << mod->getName() << " lifespan = " << time_active;
         mod->setLifespan(time_active);
-        modifiersThatNeedToStart.push_back(mod);
+        if (!modifiersThatNeedToStart.push_back(mod).valid()) {
+          winner_ok = false;
+          winner_message = "modifier_queue_full";
+          PLOG_WARNING << "Cannot queue " << mod->getName() << ": " << MAX_ACTIVE_MODIFIERS
+                       << " modifiers are already waiting to start";
+        }
       }
-      winner_ok = true;
     } else {
       PLOG_ERROR << "ERROR: Modifier not found: " << command;
     }
@@ -319,18 +416,13 @@ void ChaosEngine::newCommand(const std::string& command) {
     std::shared_ptr<Modifier> mod = game.getModifier(requested_remove);
     if (mod != nullptr) {
       resolved_remove = mod->getName();
-      bool pending_start = (std::find(modifiersThatNeedToStart.begin(), modifiersThatNeedToStart.end(), mod)
-                            != modifiersThatNeedToStart.end());
       PLOG_INFO << "Manually removing modifier '" << mod->getName();
       // If queued to start, cancel that pending start.
-      modifiersThatNeedToStart.remove(mod);
+      bool pending_start = modifiersThatNeedToStart.remove(mod);
       // Queue active mod removal for processing on the engine thread.
-      bool active = (std::find(modifiers.begin(), modifiers.end(), mod) != modifiers.end());
-      bool already_queued = (std::find(modifiersThatNeedToStop.begin(), modifiersThatNeedToStop.end(), mod)
-                             != modifiersThatNeedToStop.end());
-      if (active && !already_queued) {
-        modifiersThatNeedToStop.push_back(mod);
-      }
+      auto it = modifiers.find(mod);
+      bool active = (it != modifiers.end());
+      bool already_queued = active && !requestStop(it);
       if (pending_start) {
         remove_ok = true;
         remove_message = "modifier_pending_start_removed";
@@ -352,12 +444,8 @@ void ChaosEngine::newCommand(const std::string& command) {
   if (root.isMember("reset")) {
     lock();
     modifiersThatNeedToStart.clear();
-    for (auto& mod : modifiers) {
-      bool already_queued = (std::find(modifiersThatNeedToStop.begin(), modifiersThatNeedToStop.end(), mod)
-                             != modifiersThatNeedToStop.end());
-      if (!already_queued) {
-        modifiersThatNeedToStop.push_back(mod);
-      }
+    for (auto it = modifiers.begin(); it != modifiers.end(); ++it) {
+      requestStop(it);
     }
     unlock();
     reportCommandResult("reset", true, "modifiers_reset_requested", command_id);
@@ -385,6 +473,15 @@ void ChaosEngine::newCommand(const std::string& command) {
     reportEngineStatus();
   }
 
+  if (root.isMember("flight_recorder")) {
+    flight_recorder.setEnabled(root["flight_recorder"].asBool());
+    PLOG_INFO << "Flight recorder " << (flight_recorder.isEnabled() ? "enabled" : "disabled");
+  }
+
+  if (root.isMember("dump_recorder")) {
+    dumpFlightRecorder(root, command_id);
+  }
+
   if (root.isMember("select_game")) {
     std::string requested_game = root["select_game"].asString();
     std::string resolved_config = resolveGameConfig(requested_game);
@@ -427,6 +524,8 @@ void ChaosEngine::newCommand(const std::string& command) {
     int nmods = root["nummods"].asInt();
     if (nmods < 1) {
       PLOG_ERROR << "Number of active modifiers must be at least one";
+    } else if (nmods > (int) MAX_ACTIVE_MODIFIERS) {
+      PLOG_ERROR << "Number of active modifiers cannot be more than " << MAX_ACTIVE_MODIFIERS;
     } else {
       lock();
       game.setNumActiveMods(nmods);
@@ -489,10 +588,67 @@ void ChaosEngine::reportEngineStatus() {
   Json::Value msg;
   lock();
   msg["engine_status"] = currentEngineStatusLocked();
+  msg["modifier_costs"] = modifierCostsLocked();
+  msg["sequence_jitter"] = Sequence::getJitterStats();
+  msg["command_latency"] = getCommandLatency();
   unlock();
   chaosInterface.sendMessage(Json::writeString(jsonWriterBuilder, msg));
 }
 
+Json::Value ChaosEngine::getCommandLatency() const {
+  Json::Value stats;
+  uint64_t count = command_count.load(std::memory_order_relaxed);
+  stats["count"] = (Json::UInt64) count;
+  stats["mean_us"] = count ? command_latency_total_ns.load(std::memory_order_relaxed) / 1000.0 / count : 0.0;
+  stats["max_us"] = command_latency_max_ns.load(std::memory_order_relaxed) / 1000.0;
+  return stats;
+}
+
+// Per-mod CPU cost for every mod that has run since the game was loaded
+Json::Value ChaosEngine::modifierCostsLocked() {
+  Json::Value costs(Json::objectValue);
+  for (auto const& [name, mod] : game.getModifierMap()) {
+    if (mod && !mod->getProfile().empty()) {
+      costs[name] = mod->getProfile().toJson();
+    }
+  }
+  return costs;
+}
+
+void ChaosEngine::logModifierCosts() {
+  auto now = std::chrono::steady_clock::now();
+  if (now < next_cost_summary) {
+    return;
+  }
+  next_cost_summary = now + COST_SUMMARY_INTERVAL;
+  lock();
+  for (auto& mod : modifiers) {
+    if (!mod->getProfile().empty()) {
+      PLOG_INFO << "Modifier cost for '" << mod->getName() << "': " << mod->getProfile().summary();
+    }
+  }
+  unlock();
+}
+
+// Write the last N seconds of the flight recorder to the log directory. Only a bare file name is
+// accepted from the interface so that a command can't write outside that directory.
+void ChaosEngine::dumpFlightRecorder(const Json::Value& root, const std::string& command_id) {
+  double seconds = root["dump_recorder"].asDouble();
+  std::string file_name;
+  if (root.isMember("file")) {
+    file_name = std::filesystem::path(root["file"].asString()).filename().string();
+  }
+  if (file_name.empty()) {
+    auto stamp = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    file_name = "flight_" + std::to_string(stamp) + ".tcr";
+  }
+  std::string path = (std::filesystem::path(recording_directory) / file_name).string();
+  long written = flight_recorder.dump(path, seconds);
+  reportCommandResult("dump_recorder", written >= 0,
+                      written >= 0 ? "recording_written" : "recording_failed", command_id, path);
+}
+
 void ChaosEngine::reportCommandResult(const std::string& kind, bool ok, const std::string& message,
                                       const std::string& command_id, const std::string& target) {
   if (!interface_enabled) {
@@ -531,29 +687,40 @@ std::string ChaosEngine::currentEngineStatusLocked() {
 
 void ChaosEngine::doAction() {
   usleep(500);	// sleep .5 milliseconds
+  tick();
+}
+
+void ChaosEngine::tick() {
+  runCompletedSequenceCallbacks();
+
+  // Apply commands from the interface at a point where we hold no locks
+  commands.drain([this](PendingCommand&& cmd) { applyCommand(cmd); });
 
   // Drain pending removals even while paused so reset/remove commands take effect
-  // immediately regardless of interface/login state.
-  std::vector<std::shared_ptr<Modifier>> mods_to_finish;
+  // immediately regardless of interface/login state. Removed mods are moved into a fixed buffer
+  // so that the tick neither allocates nor touches reference counts.
+  std::array<std::shared_ptr<Modifier>, MAX_ACTIVE_MODIFIERS> mods_to_finish;
+  size_t num_to_finish = 0;
   lock();
-  while (!modifiersThatNeedToStop.empty()) {
-    std::shared_ptr<Modifier> mod = modifiersThatNeedToStop.front();
-    modifiersThatNeedToStop.pop_front();
-    assert(mod);
-    modifiersThatNeedToStart.remove(mod);
-    auto it = std::find(modifiers.begin(), modifiers.end(), mod);
-    if (it != modifiers.end()) {
-      PLOG_INFO << "Removing '" << mod->getName() << "' from active mod list";
-      PLOG_DEBUG << "Lifetime = " << mod->lifetime() << " of lifespan = " << mod->lifespan();
-      modifiers.erase(it);
-      mods_to_finish.push_back(mod);
+  for (const ActiveModifiers::Id& id : modifiersThatNeedToStop) {
+    // Requests for mods that already left the active list no longer resolve.
+    auto it = modifiers.locate(id);
+    if (it == modifiers.end()) {
+      continue;
     }
+    PLOG_INFO << "Removing '" << (*it)->getName() << "' from active mod list";
+    PLOG_DEBUG << "Lifetime = " << (*it)->lifetime() << " of lifespan = " << (*it)->lifespan();
+    mods_to_finish[num_to_finish++] = modifiers.take(it);
+  }
+  modifiersThatNeedToStop.clear();
+  if (num_to_finish > 0) {
+    rebuildPipeline();
   }
   unlock();
 
-  for (auto& mod : mods_to_finish) {
-    assert(mod);
-    mod->_finish();
+  for (size_t i = 0; i < num_to_finish; ++i) {
+    assert(mods_to_finish[i]);
+    mods_to_finish[i]->_finish();
   }
 
   bool should_announce_games = false;
@@ -593,60 +760,86 @@ void ChaosEngine::doAction() {
   // Update timers/states of modifiers
   if (pause.load()) {
     pausedPrior = true;
+    hold_scheduled.store(true);
     return;    
   }
   if (pausedPrior) {
     PLOG_DEBUG << "Resuming after pause";
   }
   // Initialize and update active mods. Run callbacks outside the engine lock so
-  // callbacks can legally inject pipelined events.
-  std::vector<std::shared_ptr<Modifier>> mods_to_begin;
-  std::vector<std::shared_ptr<Modifier>> mods_to_update;
-  std::shared_ptr<Modifier> mod_to_remove;
+  // callbacks can legally inject pipelined events. Only this thread removes mods from the active
+  // list or replaces the game, so plain pointers stay valid until the end of the tick.
+  std::array<Modifier*, MAX_ACTIVE_MODIFIERS> mods_to_begin;
+  std::array<Modifier*, MAX_ACTIVE_MODIFIERS> mods_to_update;
+  size_t num_to_begin = 0;
+  size_t num_to_update = 0;
+  Modifier* mod_to_remove = nullptr;
   lock();
   if (pause.load()) {
     unlock();
     pausedPrior = true;
+    hold_scheduled.store(true);
     return;
   }
-  while(!modifiersThatNeedToStart.empty()) {
-    std::shared_ptr<Modifier> mod = modifiersThatNeedToStart.front();
+  // Mods that don't fit wait in the queue until an active one expires
+  while (!modifiersThatNeedToStart.empty() && !modifiers.full()) {
+    std::shared_ptr<Modifier> mod = modifiersThatNeedToStart.take(modifiersThatNeedToStart.begin());
     assert(mod);
-    modifiersThatNeedToStart.pop_front();
-    if (std::find(modifiers.begin(), modifiers.end(), mod) != modifiers.end()) {
+    if (modifiers.contains(mod)) {
       continue;
     }
     PLOG_DEBUG << "Initializing modifier " << mod->getName() << " lifespan = " << mod->lifespan();
-    modifiers.push_back(mod);
-    mods_to_begin.push_back(mod);
+    mods_to_begin[num_to_begin++] = mod.get();
+    modifiers.push_back(std::move(mod));
+  }
+  for (auto& mod : modifiers) {
+    mods_to_update[num_to_update++] = mod.get();
   }
-  mods_to_update.assign(modifiers.begin(), modifiers.end());
   unlock();
 
-  for (auto& mod : mods_to_begin) {
-    assert(mod);
-    mod->_begin();
+  // One clock read serves every modifier timer this tick
+  const int64_t tick_time = Clock::now();
+  for (size_t i = 0; i < num_to_begin; ++i) {
+    mods_to_begin[i]->_begin(tick_time);
   }
-  for (auto& mod : mods_to_update) {
-    assert(mod);
-    mod->_update(pausedPrior);
+  // New mods join the event pipeline once they have begun and chosen any children
+  if (num_to_begin > 0) {
+    lock();
+    rebuildPipeline();
+    unlock();
+  }
+  for (size_t i = 0; i < num_to_update; ++i) {
+    mods_to_update[i]->_update(pausedPrior, tick_time);
+  }
+  for (const ChildEntry& child : active_children) {
+    // Children wait for their parent's begin sequence, just as the parent's own update does
+    if (!child.owner->isBeginPending()) {
+      child.mod->_update(pausedPrior, tick_time);
+    }
   }
   pausedPrior = false;
+  if (hold_scheduled.exchange(false)) {
+    scheduler.wake();
+  }
+  if (Clock::isVirtual()) {
+    // Without a scheduler thread, changes land on the first tick at or after their deadline
+    scheduler.runDue(tick_time);
+  }
+  logModifierCosts();
 
   lock();
   // If we have too many mods, remove the oldest one
   if (modifiers.size() > game.getNumActiveMods()) {
-    mod_to_remove = modifiers.front();
     for (auto& mod : modifiers) {
-      if (mod_to_remove->lifetime() < mod->lifetime()) {
-        mod_to_remove = mod;
+      if (!mod_to_remove || mod_to_remove->lifetime() < mod->lifetime()) {
+        mod_to_remove = mod.get();
       }
     }
   } else {
     // Check remaining mods for expiration.
     for (auto& mod : modifiers) {
       if (mod->lifetime() > mod->lifespan()) {
-        mod_to_remove = mod;
+        mod_to_remove = mod.get();
         // Mods are added one at a time, so we can stop searching on the first expired mod
         break;
       }
@@ -663,44 +856,49 @@ void ChaosEngine::doAction() {
 // going beyond the specified modifier count.
 void ChaosEngine::removeOldestMod() {
   PLOG_DEBUG << "Looking for oldest mod";
-  std::shared_ptr<Modifier> oldest;
   lock();
-  if (modifiers.size() > 0) {
-    oldest = modifiers.front();
-    for (auto& mod : modifiers) {
-      if (oldest->lifetime() < mod->lifetime()) {
-        oldest = mod;
-      }
+  auto oldest = modifiers.end();
+  for (auto it = modifiers.begin(); it != modifiers.end(); ++it) {
+    if (oldest == modifiers.end() || (*oldest)->lifetime() < (*it)->lifetime()) {
+      oldest = it;
     }
   }
-  if (oldest) {
-    modifiersThatNeedToStart.remove(oldest);
-    bool already_queued = (std::find(modifiersThatNeedToStop.begin(), modifiersThatNeedToStop.end(), oldest)
-                           != modifiersThatNeedToStop.end());
-    if (!already_queued) {
-      modifiersThatNeedToStop.push_back(oldest);
-    }
+  if (oldest != modifiers.end()) {
+    modifiersThatNeedToStart.remove(*oldest);
+    requestStop(oldest);
   }
   unlock();
 }
 
-void ChaosEngine::removeMod(std::shared_ptr<Modifier> to_remove) {
+// Queue an active mod for removal on the engine thread. Must be called with the engine lock held.
+bool ChaosEngine::requestStop(ActiveModifiers::iterator mod) {
+  ActiveModifiers::Id id = mod.id();
+  if (modifiersThatNeedToStop.contains(id)) {
+    return false;
+  }
+  modifiersThatNeedToStop.push_back(id);
+  return true;
+}
+
+void ChaosEngine::removeMod(Modifier* to_remove) {
   assert(to_remove);
 
   lock();
-  auto it = std::find(modifiers.begin(), modifiers.end(), to_remove);
+  auto it = modifiers.find_if([to_remove](const std::shared_ptr<Modifier>& m) { return m.get() == to_remove; });
   if (it == modifiers.end()) {
     unlock();
     return;
   }
   PLOG_INFO << "Removing '" << to_remove->getName() << "' from active mod list";
   PLOG_DEBUG << "Lifetime = " << to_remove->lifetime() << " of lifespan = " << to_remove->lifespan();
-  modifiers.erase(it);
+  modifiersThatNeedToStop.remove(it.id());
+  std::shared_ptr<Modifier> removed = modifiers.take(it);
+  rebuildPipeline();
   unlock();
 
   // Do cleanup for this mod, if necessary.
   // This callback may inject events, so it must run outside the lock.
-  to_remove->_finish();
+  removed->_finish();
 }
 
 // Tweak the event based on modifiers
@@ -711,6 +909,14 @@ bool ChaosEngine::sniffify(const DeviceEvent& input, DeviceEvent& output) {
   if (menu_navigation_active.load() || menu_navigation_transitioning.load()) {
     return false;
   }
+
+  const bool recording = flight_recorder.isEnabled();
+  uint32_t serial = 0;
+  if (recording) {
+    serial = flight_recorder.nextSerial();
+    flight_recorder.record(serial, FlightRecorder::Stage::INPUT, FlightRecorder::NO_MODIFIER,
+                           input, input);
+  }
   
   lock();
   // The options button pauses the chaos engine
@@ -765,16 +971,28 @@ bool ChaosEngine::sniffify(const DeviceEvent& input, DeviceEvent& output) {
   if (!pause.load()) {
     lock();
     // First call all remaps to translate the incoming signal 
-    for (auto& mod : modifiers) {
-      valid = mod->remap(output);
+    for (const PipelineEntry& entry : pipeline) {
+      Modifier* mod = entry.mod;
+      DeviceEvent before = output;
+      valid = mod->_remap(output);
+      if (recording) {
+        flight_recorder.record(serial, FlightRecorder::Stage::REMAP, mod->getTableIndex(),
+                               before, output, valid);
+      }
       if (!valid) {
         break;
       }
     }
     // Now pass to the regular tweak routines, which always see the fully remapped event
     if (valid) {
-      for (auto& mod : modifiers) {
+      for (const PipelineEntry& entry : pipeline) {
+        Modifier* mod = entry.mod;
+        DeviceEvent before = output;
 	      valid = mod->_tweak(output);
+        if (recording) {
+          flight_recorder.record(serial, FlightRecorder::Stage::TWEAK, mod->getTableIndex(),
+                                 before, output, valid);
+        }
 	      if (!valid) {
 	        break;
 	      }
@@ -783,11 +1001,93 @@ bool ChaosEngine::sniffify(const DeviceEvent& input, DeviceEvent& output) {
     unlock();
   }
   if (menu_navigation_active.load() || menu_navigation_transitioning.load()) {
-    return false;
+    valid = false;
+  }
+  if (recording) {
+    flight_recorder.record(serial, FlightRecorder::Stage::OUTPUT, FlightRecorder::NO_MODIFIER,
+                           input, output, valid);
+  }
+  return valid;
+}
+
+// Pass an injected event through the mods from 'first' to the end of the active list, keeping
+// the flight record. Must be called with the engine lock held.
+bool ChaosEngine::tweakInjectedEvent(DeviceEvent& event, const std::shared_ptr<Modifier>& sourceMod,
+                                     size_t first) {
+  bool valid = true;
+  if (!flight_recorder.isEnabled()) {
+    for (size_t i = first; i < pipeline.size(); ++i) {
+      valid = pipeline[i].mod->_tweak(event);
+      if (!valid) {
+        break;
+      }
+    }
+    return valid;
+  }
+
+  const DeviceEvent injected = event;
+  uint32_t serial = flight_recorder.nextSerial();
+  flight_recorder.record(serial, FlightRecorder::Stage::INJECT,
+                         sourceMod ? sourceMod->getTableIndex() : FlightRecorder::NO_MODIFIER,
+                         injected, injected);
+  for (size_t i = first; i < pipeline.size(); ++i) {
+    Modifier* mod = pipeline[i].mod;
+    DeviceEvent before = event;
+    valid = mod->_tweak(event);
+    flight_recorder.record(serial, FlightRecorder::Stage::TWEAK, mod->getTableIndex(),
+                           before, event, valid);
+    if (!valid) {
+      break;
+    }
   }
+  flight_recorder.record(serial, FlightRecorder::Stage::OUTPUT, FlightRecorder::NO_MODIFIER,
+                         injected, event, valid);
   return valid;
 }
 
+// Index of the first pipeline entry after those belonging to a source mod. Children inject events
+// in the name of their parent, so this skips the whole parent. If the source is not active (e.g.,
+// called from finish()), the event runs through the whole pipeline. Must be called with the
+// engine lock held.
+size_t ChaosEngine::pipelineAfter(const Modifier* source) const {
+  if (source) {
+    for (size_t i = pipeline.size(); i > 0; --i) {
+      if (pipeline[i - 1].owner == source || pipeline[i - 1].mod == source) {
+        return i;
+      }
+    }
+  }
+  return 0;
+}
+
+// Lay out the active mods in activation order, with the children of each parent in its place.
+// Must be called with the engine lock held.
+void ChaosEngine::rebuildPipeline() {
+  pipeline.clear();
+  active_children.clear();
+  for (auto& mod : modifiers) {
+    addToPipeline(mod.get(), mod.get());
+  }
+}
+
+void ChaosEngine::addToPipeline(Modifier* mod, Modifier* owner) {
+  child_scratch.clear();
+  mod->getChildren(child_scratch);
+  if (child_scratch.empty()) {
+    pipeline.push_back(PipelineEntry{mod, owner});
+    return;
+  }
+  const size_t first_child = active_children.size();
+  for (Modifier* child : child_scratch) {
+    active_children.push_back(ChildEntry{child, owner});
+  }
+  const size_t last_child = active_children.size();
+  // Children that are parents themselves are flattened too, after their own parent
+  for (size_t i = first_child; i < last_child; ++i) {
+    addToPipeline(active_children[i].mod, owner);
+  }
+}
+
 // This function is called by modifiers to inject a fake event into the event pipeline.
 // Because the event can be modified by other mods, we find the location of the modifier
 // and feed the fake event through the rest of the modifiers, in order.
@@ -804,26 +1104,12 @@ void ChaosEngine::fakePipelinedEvent(DeviceEvent& event, std::shared_ptr<Modifie
       unlock();
       return;
     }
-    // Find the modifier that sent the fake event in the modifier list
-    auto mod = std::find_if(modifiers.begin(), modifiers.end(),
-                            [&sourceMod](const auto& p) { return p == sourceMod; } );
-    
-    // Iterate from the next element till the end and apply any tweaks. If the
-    // source mod is not active (e.g., called from finish()), run through all mods.
-    if (mod != modifiers.end()) {
-      for (mod++; mod != modifiers.end(); mod++) {
-        valid = (*mod)->_tweak(event);
-        if (!valid) {
-		      break;
-        }
-      }
-    } else {
-      for (auto& m : modifiers) {
-        valid = m->_tweak(event);
-        if (!valid) {
-          break;
-        }
-      }
+    // Apply the tweaks of every mod after the one that sent the fake event
+    const bool profiling = sourceMod && ModifierProfile::isEnabled();
+    int64_t fan_out_start = profiling ? ModifierProfile::now() : 0;
+    valid = tweakInjectedEvent(event, sourceMod, pipelineAfter(sourceMod.get()));
+    if (profiling) {
+      sourceMod->getProfile().add(ModifierProfile::INJECT, ModifierProfile::now() - fan_out_start);
     }
     unlock();
   }
@@ -833,6 +1119,38 @@ void ChaosEngine::fakePipelinedEvent(DeviceEvent& event, std::shared_ptr<Modifie
   }
 }
 
+// Batched form of fakePipelinedEvent. The whole batch goes through the downstream mods under a
+// single lock, and whatever survives is applied to the controller in one update so that paired
+// signals (e.g., LX/LY) change together.
+void ChaosEngine::fakePipelinedEvents(std::vector<DeviceEvent>& events, std::shared_ptr<Modifier> sourceMod) {
+  if (events.empty() || menu_navigation_active.load() || menu_navigation_transitioning.load()) {
+    return;
+  }
+
+  if (!pause.load()) {
+    lock();
+    if (pause.load() || menu_navigation_active.load() || menu_navigation_transitioning.load()) {
+      unlock();
+      return;
+    }
+    const size_t first = pipelineAfter(sourceMod.get());
+    const bool profiling = sourceMod && ModifierProfile::isEnabled();
+    int64_t fan_out_start = profiling ? ModifierProfile::now() : 0;
+    size_t kept = 0;
+    for (auto& event : events) {
+      if (tweakInjectedEvent(event, sourceMod, first)) {
+        events[kept++] = event;
+      }
+    }
+    if (profiling) {
+      sourceMod->getProfile().add(ModifierProfile::INJECT, ModifierProfile::now() - fan_out_start);
+    }
+    unlock();
+    events.resize(kept);
+  }
+  controller.dispatchEvents(events);
+}
+
 void ChaosEngine::sendInterfaceMessage(const std::string& msg) {
   chaosInterface.sendMessage(msg);
 }
@@ -854,47 +1172,55 @@ void ChaosEngine::clearPendingInjectedEventsForMenu() {
   }
 }
 
+// Menu navigation is composed here but played on the sequence executor. Gameplay input stays
+// blocked until the sequence finishes, but the engine thread keeps updating the other mods.
 void ChaosEngine::setMenuState(std::shared_ptr<MenuItem> item, unsigned int new_val) {
-  ScopedMenuNavigation navigation_guard(
-      [this]() { beginMenuNavigation(); }, [this]() { endMenuNavigation(); });
-  game.getMenu().setState(item, new_val, false, controller);
+  Sequence seq{controller, true};
+  beginMenuNavigation();
+  game.getMenu().composeState(item, new_val, false, controller, seq);
+  playSequence(seq, [this]() { endMenuNavigation(); });
 }
 
 void ChaosEngine::restoreMenuState(std::shared_ptr<MenuItem> item) {
-  ScopedMenuNavigation navigation_guard(
-      [this]() { beginMenuNavigation(); }, [this]() { endMenuNavigation(); });
-  game.getMenu().restoreState(item, controller);
+  Sequence seq{controller, true};
+  beginMenuNavigation();
+  if (game.getMenu().composeRestore(item, controller, seq)) {
+    playSequence(seq, [this]() { endMenuNavigation(); });
+  } else {
+    endMenuNavigation();
+  }
 }
 
-bool ChaosEngine::eventMatches(const DeviceEvent& event, std::shared_ptr<GameCommand> command) { 
-  std::shared_ptr<ControllerInput> signal = command->getInput();
+bool ChaosEngine::eventMatches(const DeviceEvent& event, Handle<GameCommand> command) { 
+  Handle<ControllerInput> signal = command->getInput();
   return signal ? signal->matches(event) : false;
 }
 
-void ChaosEngine::setOff(std::shared_ptr<GameCommand> command) {
+void ChaosEngine::setOff(Handle<GameCommand> command) {
   if (menu_navigation_active.load() || menu_navigation_transitioning.load()) {
     return;
   }
-  std::shared_ptr<ControllerInput> signal = command->getInput();
-  controller.setOff(signal);
+  controller.setOff(command->getInput());
 }
     
-void ChaosEngine::setOn(std::shared_ptr<GameCommand> command) {
+void ChaosEngine::setOn(Handle<GameCommand> command) {
   if (menu_navigation_active.load() || menu_navigation_transitioning.load()) {
     return;
   }
-  std::shared_ptr<ControllerInput> signal = command->getInput();
-  controller.setOn(signal);
+  controller.setOn(command->getInput());
 }
 
-void ChaosEngine::setValue(std::shared_ptr<GameCommand> command, short value) {
+void ChaosEngine::setValue(Handle<GameCommand> command, short value) {
   if (menu_navigation_active.load() || menu_navigation_transitioning.load()) {
     return;
   }
-  std::shared_ptr<ControllerInput> signal = command->getInput();
-  controller.setValue(signal, value);
+  controller.setValue(command->getInput(), value);
 }
 
 void ChaosEngine::applyEvent(const DeviceEvent& event) {
   controller.dispatchEvent(event);
 }
+
+void ChaosEngine::applyEvents(const std::vector<DeviceEvent>& events) {
+  controller.dispatchEvents(events);
+}
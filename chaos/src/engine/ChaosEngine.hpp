@@ -20,6 +20,7 @@
 #pragma once
 #include <thread.hpp>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <list>
 #include <string>
@@ -27,13 +28,19 @@
 #include <utility>
 #include <vector>
 #include <chrono>
+#include <functional>
+#include <mutex>
 #include <json/json.h>
+#include <mailbox.hpp>
 #include <timer.hpp>
 
 #include "ChaosInterface.hpp"
 #include "Controller.hpp"
+#include "FlightRecorder.hpp"
 #include "Modifier.hpp"
 #include "Game.hpp"
+#include "EventScheduler.hpp"
+#include "SequenceExecutor.hpp"
 
 namespace Chaos {
 
@@ -57,21 +64,104 @@ namespace Chaos {
     Game game;
 
     /**
-     * The list of currently active modifiers
+     * Plays begin/finish and menu sequences so that the engine thread keeps ticking meanwhile.
      */
-    std::list<std::shared_ptr<Modifier>> modifiers;
+    SequenceExecutor sequencer;
 
     /**
-     * List of modifiers that have been selected but not yet initialized.
+     * Applies command changes that modifiers have scheduled for set times.
      */
-    std::list<std::shared_ptr<Modifier>> modifiersThatNeedToStart;
+    EventScheduler scheduler;
 
     /**
-     * List of active modifiers that have been requested for removal.
+     * Completion callbacks of played sequences, waiting to be run on the engine thread.
+     */
+    std::mutex completed_sequences_mutex;
+    std::vector<std::function<void()>> completed_sequences;
+
+    /**
+     * Number of menu sequences submitted but not yet finished playing.
+     */
+    std::atomic<unsigned int> menu_sequences_pending{0};
+
+    /**
+     * \brief A command from the interface, parsed and waiting to be applied on the engine thread.
+     */
+    struct PendingCommand {
+      Json::Value root;
+      std::string text;
+      std::string command_id;
+      std::chrono::steady_clock::time_point received;
+    };
+
+    /**
+     * Commands posted by the listener thread. Drained at the top of each engine tick.
+     */
+    Mailbox<PendingCommand> commands;
+
+    /**
+     * Time from receipt of a command to when the engine thread applied it
+     */
+    std::atomic<uint64_t> command_count{0};
+    std::atomic<uint64_t> command_latency_total_ns{0};
+    std::atomic<uint64_t> command_latency_max_ns{0};
+
+    /**
+     * The currently active modifiers, in the order they were activated
+     */
+    ActiveModifiers modifiers;
+
+    /**
+     * \brief A modifier in the event pipeline, tagged with the active modifier it belongs to.
+     *
+     * For an ordinary modifier the owner is the modifier itself. The children of a parent modifier
+     * stand in the pipeline in place of their parent, with the parent as their owner.
+     */
+    struct PipelineEntry {
+      Modifier* mod;
+      Modifier* owner;
+    };
+
+    /**
+     * \brief The modifiers that remap and tweak events, in order.
      *
-     * Removal requests are drained on the engine thread to avoid update/finish overlap.
+     * Rebuilt from #modifiers, with the engine lock held, whenever the active list changes. Only the
+     * engine thread rebuilds it, so that thread may read it without the lock.
      */
-    std::list<std::shared_ptr<Modifier>> modifiersThatNeedToStop;
+    std::vector<PipelineEntry> pipeline;
+
+    /**
+     * \brief A child of an active parent, together with the active mod it belongs to.
+     */
+    struct ChildEntry {
+      Modifier* mod;
+      Modifier* owner;
+    };
+
+    /**
+     * Every child of an active parent, including children that are parents themselves, with each
+     * parent ahead of its own children. The engine updates these after the active modifiers, but
+     * not while their owner's begin sequence is still playing.
+     */
+    std::vector<ChildEntry> active_children;
+
+    /**
+     * Scratch list for collecting a parent's children while the pipeline is rebuilt.
+     */
+    std::vector<Modifier*> child_scratch;
+
+    /**
+     * Modifiers that have been selected but not yet initialized.
+     */
+    ActiveModifiers modifiersThatNeedToStart;
+
+    /**
+     * Active modifiers that have been requested for removal, by their slot in #modifiers.
+     *
+     * Removal requests are drained on the engine thread to avoid update/finish overlap. A request
+     * for a mod that has since left the active list no longer resolves and is skipped.
+     */
+    SlotArray<ActiveModifiers::Id, MAX_ACTIVE_MODIFIERS> modifiersThatNeedToStop;
 	
     std::atomic<bool> keep_going{true};
     std::atomic<bool> pause{true};
@@ -84,6 +174,11 @@ namespace Chaos {
     std::atomic<unsigned int> controller_dispatch_inflight{0};
     bool pausePrimer = false;
     bool pausedPrior = false;
+    /**
+     * Set from the start of a pause until the modifiers have had their first update after it, so
+     * that the scheduler does not apply actions that the modifiers have yet to move past the pause.
+     */
+    std::atomic<bool> hold_scheduled{false};
     int primary_mods = 0;
     bool interface_enabled{true};
     std::string default_mod_list_path;
@@ -91,14 +186,36 @@ namespace Chaos {
     std::string current_game_mod_list_uri;
     std::unordered_map<std::string, std::string> available_game_configs;
     Json::Value available_games_payload{Json::arrayValue};
+
+    /**
+     * Record of recent pipeline decisions, dumped on request from the interface.
+     */
+    FlightRecorder flight_recorder;
+    std::string recording_directory{"."};
     std::chrono::steady_clock::time_point next_game_announcement{};
+
+    /**
+     * How often the CPU cost of the active mods is written to the log
+     */
+    static constexpr std::chrono::seconds COST_SUMMARY_INTERVAL{60};
+    std::chrono::steady_clock::time_point next_cost_summary{};
     std::atomic<bool> awaiting_available_games_ack{false};
     
     // overridden from ControllerInjector
     bool sniffify(const DeviceEvent& input, DeviceEvent& output);
     bool dispatchControllerEvent(const DeviceEvent& event,
-                                 const std::function<void(const DeviceEvent&)>& apply,
+                                 FunctionRef<void(const DeviceEvent&)> apply,
                                  bool allow_during_menu = false) override;
+    bool dispatchControllerEvents(const std::vector<DeviceEvent>& events,
+                                  FunctionRef<void(const std::vector<DeviceEvent>&)> apply,
+                                  bool allow_during_menu = false) override;
+    bool acquireControllerDispatch(bool allow_during_menu);
+    bool tweakInjectedEvent(DeviceEvent& event, const std::shared_ptr<Modifier>& sourceMod,
+                            size_t first);
+    size_t pipelineAfter(const Modifier* source) const;
+    void rebuildPipeline();
+    void addToPipeline(Modifier* mod, Modifier* owner);
+    void releaseControllerDispatch(bool allow_during_menu);
     bool prefersRawPassthrough() const override { return pause.load(); }
 
     // overridden from Thread
@@ -111,17 +228,23 @@ namespace Chaos {
     void reportGameStatus();
     void reportAvailableGames();
     void reportEngineStatus();
+    void dumpFlightRecorder(const Json::Value& root, const std::string& command_id);
     void reportCommandResult(const std::string& kind, bool ok, const std::string& message,
                              const std::string& command_id = "",
                              const std::string& target = "");
     std::string currentEngineStatusLocked();
+    Json::Value modifierCostsLocked();
+    void logModifierCosts();
     std::string resolveGameConfig(const std::string& selection);
     std::string resolveModListUri(const std::string& configured_uri) const;
     void clearPendingInjectedEventsForMenu();
     void beginMenuNavigation();
     void endMenuNavigation();
+    void runCompletedSequenceCallbacks();
+    void applyCommand(PendingCommand& cmd);
 
-    void removeMod(std::shared_ptr<Modifier> mod);
+    bool requestStop(ActiveModifiers::iterator mod);
+    void removeMod(Modifier* mod);
 
   public:
     /**
@@ -136,6 +259,11 @@ namespace Chaos {
     ChaosEngine(Controller& c, const std::string& listener_endpoint,
                 const std::string& talker_endpoint, bool enable_interface = true,
                 const std::string& default_mod_list_uri_base = "");
+
+    /**
+     * \brief Stop the engine thread and the sequence executor.
+     */
+    ~ChaosEngine();
     
     /**
      * \brief Send a serialized message to the external interface.
@@ -151,6 +279,16 @@ namespace Chaos {
      */
     void setAvailableGames(const std::vector<std::pair<std::string, std::string>>& games);
 
+    /**
+     * \brief Set the directory where flight recorder dumps are written.
+     */
+    void setRecordingDirectory(const std::string& dir) { recording_directory = dir; }
+
+    /**
+     * \brief Access the recorder that tracks each event's trip through the active mods.
+     */
+    FlightRecorder& getFlightRecorder() { return flight_recorder; }
+
     /**
      * \brief Broadcast the currently available game list to the interface.
      */
@@ -166,9 +304,9 @@ namespace Chaos {
     /**
      * \brief Get the list of mods that are currently active
      * 
-     * \return std::list<std::shared_ptr<Modifier>> 
+     * \return ActiveModifiers&
      */
-    std::list<std::shared_ptr<Modifier>>& getActiveMods() { return modifiers; }
+    ActiveModifiers& getActiveMods() { return modifiers; }
 
     /**
      * \brief Insert a new event into the event queue
@@ -181,6 +319,17 @@ namespace Chaos {
      */
     void fakePipelinedEvent(DeviceEvent& event, std::shared_ptr<Modifier> sourceMod);
 
+    /**
+     * \brief Insert a batch of new events into the event queue
+     * 
+     * \param events The fake events to insert. Events dropped by a downstream mod are removed.
+     * \param sourceMod The modifier that inserted the events
+     * 
+     * All events pass through the downstream mods under one lock, and the survivors are applied
+     * to the controller together.
+     */
+    void fakePipelinedEvents(std::vector<DeviceEvent>& events, std::shared_ptr<Modifier> sourceMod) override;
+
     /**
      * \brief Remove mod with the least time remaining
      * 
@@ -196,28 +345,43 @@ namespace Chaos {
     /**
      * \brief Is the event an instance of the specified input command?
      */
-    bool eventMatches(const DeviceEvent& event, std::shared_ptr<GameCommand> command);
+    bool eventMatches(const DeviceEvent& event, Handle<GameCommand> command);
 
     /**
      * \brief Force a command to its "off" state on the controller.
      */
-    void setOff(std::shared_ptr<GameCommand> command);
+    void setOff(Handle<GameCommand> command);
     
     /**
      * \brief Force a command to its "on" state on the controller.
      */
-    void setOn(std::shared_ptr<GameCommand> command);
+    void setOn(Handle<GameCommand> command);
 
     /**
      * \brief Set a command to an explicit value on the controller.
      */
-    void setValue(std::shared_ptr<GameCommand> command, short value);
+    void setValue(Handle<GameCommand> command, short value);
+
+    /**
+     * \brief Queue a command change for the scheduler thread to make at its deadline.
+     */
+    void scheduleAction(const ScheduledAction& action) override { scheduler.schedule(action); }
+
+    /**
+     * \brief Drop the pending scheduled changes from a modifier.
+     */
+    void cancelScheduled(const Modifier* source) override { scheduler.cancel(source); }
 
     /**
      * \brief Apply a raw event directly to controller output.
      */
     void applyEvent(const DeviceEvent& event) override;
 
+    /**
+     * \brief Apply a batch of raw events directly to controller output as one update.
+     */
+    void applyEvents(const std::vector<DeviceEvent>& events) override;
+
     /**
      * \brief Lookup a modifier by name from the loaded game.
      */
@@ -232,6 +396,11 @@ namespace Chaos {
       return game.getModifierMap();
     }
 
+    /**
+     * \brief Access the group and type index of the game's modifiers.
+     */
+    const ModifierIndex* getModifierIndex() override { return &game.getModifierIndex(); }
+
     /**
      * \brief Lookup a menu item by name from the loaded game.
      */
@@ -248,6 +417,18 @@ namespace Chaos {
     */
     void setMenuState(std::shared_ptr<MenuItem> item, unsigned int new_val) override;
 
+    /**
+     * \brief Play a sequence on the sequence executor
+     * \param seq The sequence to play. Its events are copied.
+     * \param on_complete Run on the engine thread once the sequence has finished playing
+     */
+    void playSequence(Sequence& seq, std::function<void()> on_complete = nullptr) override;
+
+    /**
+     * \brief Block until all submitted sequences have finished playing.
+     */
+    void waitForSequences() { sequencer.waitUntilIdle(); }
+
     /**
      * \brief Restores a menu to its default state
      * \param item The menu item to restore
@@ -322,10 +503,24 @@ namespace Chaos {
      * 
      * \param command A string containing the Json object received from the interface
      * 
-     * This routine processes all incoming commands from the interface.
+     * Called on the listener thread. The command is parsed here and posted to a mailbox; the
+     * engine thread applies it at the start of its next tick.
      */
     void newCommand(const std::string& command);
 
+    /**
+     * \brief Count, mean and worst time from receipt to application of interface commands.
+     */
+    Json::Value getCommandLatency() const;
+
+    /**
+     * \brief Run one pass of the engine loop.
+     *
+     * The engine thread calls this every half millisecond. A replay harness running on the
+     * virtual clock (see Clock) calls it directly instead of starting the thread.
+     */
+    void tick();
+
     /**
      * \brief Is the engine paused
      * 
@@ -335,6 +530,11 @@ namespace Chaos {
      */
     bool isPaused() { return pause.load(); }
 
+    /**
+     * \brief The engine updates, remaps and tweaks the children of active parents itself.
+     */
+    bool runsChildModifiers() override { return true; }
+
     /**
      * \brief Test helper to override interface health state.
      */
@@ -26,10 +26,12 @@
 #include <vector>
 #include <plog/Log.h>
 #include <plog/Initializers/RollingFileInitializer.h>
+#include <random.hpp>
 
 #include "config.hpp"
 #include "enumerations.hpp"
 #include "Configuration.hpp"
+#include "GameMetadataCache.hpp"
 #include "GameCommand.hpp"
 #include "Modifier.hpp"
 #include "GameMenu.hpp"
@@ -116,6 +118,20 @@ Configuration::Configuration(const std::string& fname) {
   listener_port = configuration["listener_port"].value_or(5555);
   PLOG_VERBOSE << "chaosface listen endpoint: " << getListenerAddress();
 
+  // A fixed seed makes random modifier choices repeatable from one run to the next
+  std::optional<int64_t> random_seed = configuration["random_seed"].value<int64_t>();
+  if (random_seed) {
+    Random::seed(static_cast<uint64_t>(*random_seed));
+    PLOG_INFO << "Using fixed random seed " << *random_seed;
+  }
+
+  // Per-modifier CPU accounting is for diagnosing slow mods and is off by default
+  bool profile_modifiers = configuration["profile_modifiers"].value_or(false);
+  ModifierProfile::setEnabled(profile_modifiers);
+  if (profile_modifiers) {
+    PLOG_INFO << "Per-modifier cost accounting enabled";
+  }
+
   default_mod_list_path = configuration["default_mod_list_path"].value_or("");
   if (default_mod_list_path.empty()) {
     // Backward-compatible alias for a previous typo in documentation.
@@ -138,6 +154,11 @@ Configuration::Configuration(const std::string& fname) {
     PLOG_ERROR << "Game directory '" << game_directory.string() << "' is not a directory!";
     game_directory = ".";
   }
+  // Metadata of the game configs, so that startup only reads the files that have changed
+  game_cache = configuration["game_cache"].value_or("game_metadata.cache");
+  if (!game_cache.empty() && !game_cache.has_parent_path()) {
+    game_cache = log_path / game_cache;
+  }
   discoverAvailableGames();
 
   // If the game configuration file doesn't specify a path, use the default games directory
@@ -161,6 +182,8 @@ void Configuration::discoverAvailableGames() {
 
   std::vector<std::pair<std::string, std::string>> discovered;
   std::unordered_set<std::string> seen_game_names;
+  GameMetadataCache cache(game_cache);
+  cache.load();
 
   for (const std::filesystem::directory_entry& entry : dir_iter) {
     if (!entry.is_regular_file()) {
@@ -170,36 +193,39 @@ void Configuration::discoverAvailableGames() {
       continue;
     }
 
-    toml::table config;
-    try {
-      config = toml::parse_file(entry.path().string());
-    } catch (const toml::parse_error& err) {
-      PLOG_WARNING << "Skipping invalid TOML file '" << entry.path().string()
-                   << "': " << err;
+    const GameMetadataCache::Entry meta = cache.lookup(entry.path());
+    if (meta.role != "main") {
       continue;
     }
 
-    std::optional<std::string_view> role = config["chaos_toml"].value<std::string_view>();
-    if (!role || *role != "main") {
-      continue;
-    }
-
-    std::optional<std::string> game_name = config["game"].value<std::string>();
-    if (!game_name || game_name->empty()) {
+    if (meta.game.empty()) {
       PLOG_ERROR << "Skipping '" << entry.path().string()
                  << "': main game configs must define a non-empty 'game' string.";
       continue;
     }
 
-    if (seen_game_names.find(*game_name) != seen_game_names.end()) {
-      PLOG_ERROR << "Duplicate game name '" << *game_name << "' found in '"
+    if (seen_game_names.find(meta.game) != seen_game_names.end()) {
+      PLOG_ERROR << "Duplicate game name '" << meta.game << "' found in '"
                  << entry.path().string() << "'. Ignoring duplicate.";
       continue;
     }
-    seen_game_names.insert(*game_name);
+    seen_game_names.insert(meta.game);
+
+    if (!meta.input_file.empty()) {
+      std::filesystem::path template_path(meta.input_file);
+      if (!template_path.is_absolute()) {
+        template_path = entry.path().parent_path() / template_path;
+      }
+      if (!std::filesystem::exists(template_path)) {
+        PLOG_WARNING << "Game '" << meta.game << "' uses template '" << template_path.string()
+                     << "', which does not exist.";
+      }
+    }
 
-    discovered.emplace_back(*game_name, entry.path().lexically_normal().string());
+    discovered.emplace_back(meta.game, entry.path().lexically_normal().string());
   }
+  PLOG_DEBUG << "Scanned " << cache.scanned() << " changed game configuration files.";
+  cache.save();
 
   std::sort(discovered.begin(), discovered.end(),
             [](const std::pair<std::string, std::string>& a,
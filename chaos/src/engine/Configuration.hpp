@@ -49,6 +49,7 @@ namespace Chaos {
     std::filesystem::path game_directory;
     std::filesystem::path game_config;
     std::filesystem::path log_path;
+    std::filesystem::path game_cache;
     unsigned int usleep_interval;
     std::string interface_addr;
     unsigned int interface_port;
@@ -109,6 +110,13 @@ namespace Chaos {
      */
     std::string getListenerAddress() { return "tcp://*:" + std::to_string(listener_port); }
 
+    /**
+     * \brief Get the directory where log files are written
+     *
+     * Flight recorder dumps requested by the interface are also written here.
+     */
+    std::string getLogDirectory() { return log_path.string(); }
+
     /**
      * \brief Get the default base URI used to resolve relative per-game mod-list links.
      */
@@ -0,0 +1,203 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+#include <plog/Log.h>
+#include <toml++/toml.h>
+
+#include "GameMetadataCache.hpp"
+
+using namespace Chaos;
+
+namespace {
+  // Fields are separated by tabs and entries by newlines, so values containing either can't be
+  // stored. Such files are simply scanned every time.
+  bool storable(const std::string& value) {
+    return value.find_first_of("\t\n\r") == std::string::npos;
+  }
+
+  bool statFile(const std::filesystem::path& path, uintmax_t& size, int64_t& mtime) {
+    std::error_code err;
+    size = std::filesystem::file_size(path, err);
+    if (err) {
+      return false;
+    }
+    auto time = std::filesystem::last_write_time(path, err);
+    if (err) {
+      return false;
+    }
+    mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+  }
+
+  bool isTableHeader(const std::string& line) {
+    size_t first = line.find_first_not_of(" \t");
+    return first != std::string::npos && line[first] == '[';
+  }
+}
+
+GameMetadataCache::GameMetadataCache(std::filesystem::path cache_file)
+  : file{std::move(cache_file)} {}
+
+void GameMetadataCache::load() {
+  entries.clear();
+  used.clear();
+  scan_count = 0;
+  dirty = false;
+  if (file.empty()) {
+    return;
+  }
+  std::ifstream in(file);
+  std::string line;
+  if (!in || !std::getline(in, line) || line != HEADER) {
+    return;
+  }
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string path, size, mtime;
+    Entry entry;
+    if (!std::getline(fields, path, '\t') || !std::getline(fields, size, '\t') ||
+        !std::getline(fields, mtime, '\t') || !std::getline(fields, entry.role, '\t') ||
+        !std::getline(fields, entry.game, '\t')) {
+      continue;
+    }
+    std::getline(fields, entry.input_file);
+    entry.valid = true;
+    try {
+      entry.size = std::stoull(size);
+      entry.mtime = std::stoll(mtime);
+    } catch (const std::exception&) {
+      continue;
+    }
+    entries[path] = std::move(entry);
+  }
+  PLOG_DEBUG << "Loaded " << entries.size() << " entries from " << file;
+}
+
+bool GameMetadataCache::save() {
+  if (file.empty()) {
+    return false;
+  }
+  if (!dirty && used.size() == entries.size()) {
+    return true;
+  }
+  // Write a temporary file and move it into place so a crash never leaves a half-written cache
+  std::filesystem::path tmp = file;
+  tmp += ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) {
+      PLOG_WARNING << "Cannot write game metadata cache " << tmp;
+      return false;
+    }
+    out << HEADER << '\n';
+    for (const auto& [path, entry] : used) {
+      if (!storable(path) || !storable(entry.role) || !storable(entry.game) ||
+          !storable(entry.input_file)) {
+        continue;
+      }
+      out << path << '\t' << entry.size << '\t' << entry.mtime << '\t' << entry.role << '\t'
+          << entry.game << '\t' << entry.input_file << '\n';
+    }
+    if (!out) {
+      PLOG_WARNING << "Failed writing game metadata cache " << tmp;
+      return false;
+    }
+  }
+  std::error_code err;
+  std::filesystem::rename(tmp, file, err);
+  if (err) {
+    PLOG_WARNING << "Cannot replace game metadata cache " << file << ": " << err.message();
+    std::filesystem::remove(tmp, err);
+    return false;
+  }
+  entries = used;
+  dirty = false;
+  return true;
+}
+
+GameMetadataCache::Entry GameMetadataCache::lookup(const std::filesystem::path& path) {
+  const std::string key = path.lexically_normal().string();
+  uintmax_t size = 0;
+  int64_t mtime = 0;
+  const bool have_stat = statFile(path, size, mtime);
+
+  auto it = entries.find(key);
+  if (have_stat && it != entries.end() && it->second.size == size && it->second.mtime == mtime) {
+    return used[key] = it->second;
+  }
+
+  ++scan_count;
+  Entry entry = scan(path);
+  if (!entry.valid) {
+    return entry;
+  }
+  dirty = true;
+  // Stat before scanning, so a file that changes during the scan looks stale next time
+  entry.size = size;
+  entry.mtime = have_stat ? mtime : 0;
+  return used[key] = std::move(entry);
+}
+
+GameMetadataCache::Entry GameMetadataCache::scan(const std::filesystem::path& path) {
+  Entry entry;
+  std::ifstream in(path);
+  if (!in) {
+    PLOG_WARNING << "Cannot read '" << path.string() << "'";
+    return entry;
+  }
+  std::string header;
+  std::string line;
+  bool complete = false;
+  while (std::getline(in, line)) {
+    if (isTableHeader(line)) {
+      complete = true;
+      break;
+    }
+    header += line;
+    header += '\n';
+  }
+  in.close();
+
+  toml::table config;
+  try {
+    config = toml::parse(header);
+  } catch (const toml::parse_error&) {
+    if (!complete) {
+      PLOG_WARNING << "Skipping invalid TOML file '" << path.string() << "'";
+      return entry;
+    }
+    // The header scan stopped inside a value. Fall back to reading the whole file.
+    try {
+      config = toml::parse_file(path.string());
+    } catch (const toml::parse_error& err) {
+      PLOG_WARNING << "Skipping invalid TOML file '" << path.string() << "': " << err;
+      return entry;
+    }
+  }
+  entry.role = config["chaos_toml"].value_or<std::string>("");
+  entry.game = config["game"].value_or<std::string>("");
+  entry.input_file = config["input_file"].value_or<std::string>("");
+  entry.valid = true;
+  return entry;
+}
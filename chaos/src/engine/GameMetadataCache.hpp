@@ -0,0 +1,106 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+namespace Chaos {
+
+  /**
+   * \brief Remembers the identifying keys of the game configuration files on disk.
+   *
+   * Finding the playable games only needs a few top-level keys from each file in the game
+   * directory, but the configs run to thousands of lines. This cache stores, for each file, the
+   * role, game name, and template dependency, keyed by the file's path and validated against its
+   * size and modification time. Files that are new or have changed since the last run are read
+   * only as far as their first table header, since TOML puts all the top-level keys before it.
+   *
+   * The cache is kept in a small text file between runs. A missing or unreadable cache file just
+   * means every config is scanned again.
+   */
+  class GameMetadataCache {
+  public:
+    /**
+     * \brief What the cache knows about one configuration file.
+     */
+    struct Entry {
+      uintmax_t size = 0;
+      int64_t mtime = 0;
+      /// False if the file could not be read or parsed
+      bool valid = false;
+      /// Value of chaos_toml, or empty if the file is not a TCC config
+      std::string role;
+      std::string game;
+      /// Template the file is layered on (input_file), if any
+      std::string input_file;
+    };
+
+    /**
+     * \param cache_file Where to keep the cache between runs. An empty path disables saving.
+     */
+    explicit GameMetadataCache(std::filesystem::path cache_file);
+
+    /**
+     * \brief Read the saved cache, if there is one.
+     */
+    void load();
+
+    /**
+     * \brief Write the cache if anything has changed since it was loaded.
+     *
+     * Only the files looked up since the last load are kept, so entries for deleted files are
+     * dropped.
+     */
+    bool save();
+
+    /**
+     * \brief Metadata for a config file, scanning the file if the cached copy is missing or stale.
+     *
+     * Files that fail to scan are not cached, so they are scanned, and the failure logged, on
+     * every lookup.
+     */
+    Entry lookup(const std::filesystem::path& path);
+
+    /**
+     * \brief Number of files scanned by lookup() since the cache was loaded.
+     */
+    size_t scanned() const { return scan_count; }
+
+    /**
+     * \brief Read the top-level keys of a config file.
+     *
+     * Only the text before the first table header is parsed. If that fails, e.g. because a
+     * multi-line value contains a line beginning with '[', the whole file is parsed instead.
+     */
+    static Entry scan(const std::filesystem::path& path);
+
+  private:
+    static constexpr const char* HEADER = "chaos-game-metadata 1";
+
+    std::filesystem::path file;
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<std::string, Entry> used;
+    size_t scan_count = 0;
+    bool dirty = false;
+  };
+
+};
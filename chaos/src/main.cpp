@@ -54,6 +54,7 @@ int main(int argc, char** argv) {
                                            chaos_config.getDefaultModListPath());
 
     engine->setAvailableGames(chaos_config.getAvailableGames());
+    engine->setRecordingDirectory(chaos_config.getLogDirectory());
     if (!configfile.empty()) {
       // Keep engine running/listening even if the game file is invalid, but remain paused until a
       // valid game config is loaded.
@@ -22,7 +22,7 @@
 
 using namespace Chaos;
 
-bool TOMLUtils::checkValid(const toml::table& config, const std::vector<std::string>& goodKeys,
+bool TOMLUtils::checkValid(const toml::table& config, std::initializer_list<std::string_view> goodKeys,
           const std::string& name) {
   bool ret = true;
   for (auto&& [k, v] : config) {
@@ -34,9 +34,15 @@ bool TOMLUtils::checkValid(const toml::table& config, const std::vector<std::str
   return ret;
 }
 
-bool TOMLUtils::checkValid(const toml::table& config, const std::vector<std::string>& goodKeys) {
-  std::string cname = config["name"].value_or("??");
-  return checkValid(config, goodKeys, cname);    
+bool TOMLUtils::checkValid(const toml::table& config, std::initializer_list<std::string_view> goodKeys) {
+  // Only look up the name if there is something to report
+  for (auto&& [k, v] : config) {
+    if (std::find(goodKeys.begin(), goodKeys.end(), k) == goodKeys.end()) {
+      std::string cname = config["name"].value_or("??");
+      return checkValid(config, goodKeys, cname);
+    }
+  }
+  return true;
 }
 
 
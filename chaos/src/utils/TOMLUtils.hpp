@@ -17,7 +17,9 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <toml++/toml.h>
@@ -29,33 +31,33 @@ namespace Chaos {
   public:
   
   /**
-   * \brief Test if the table contains any keys other than those listed in the vector.
+   * \brief Test if the table contains any keys other than those listed.
 
    * \param config TOML table to test
-   * \param goodKeys Vector of strings that are legal keys for this table
+   * \param goodKeys Legal keys for this table
 
    * \return true if all keys are good
-   * \return false if any keys do not match an entry in the vector
+   * \return false if any keys do not match an entry in the list
    *
    * The identity of unknown keys will also be logged. For reporting errors, this version assumes
    * that the table contains a key 'name' that identifies the table.
    */
-  static bool checkValid(const toml::table& config, const std::vector<std::string>& goodKeys);
+  static bool checkValid(const toml::table& config, std::initializer_list<std::string_view> goodKeys);
 
   /**
-   * \brief Test if the table contains any keys other than those listed in the vector.
+   * \brief Test if the table contains any keys other than those listed.
    *
    * \param config TOML table to test
-   * \param goodKeys Vector of strings that are legal keys for this table
+   * \param goodKeys Legal keys for this table
    * \param name Name of the table (for logging warnings)
    *
    * \return true if all keys are good
-   * \return false if any keys do not match an entry in the vector
+   * \return false if any keys do not match an entry in the list
    *
    * The identity of unknown keys will also be logged. Call this version if #config does not
    * contain a "name" field.
    */
-  static bool checkValid(const toml::table& config, const std::vector<std::string>& goodKeys,
+  static bool checkValid(const toml::table& config, std::initializer_list<std::string_view> goodKeys,
                   const std::string& name);
 
   
@@ -0,0 +1,62 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "clock.hpp"
+#include <cerrno>
+#include <time.h>
+
+using namespace Chaos;
+
+std::atomic<bool> Clock::virtual_mode{false};
+std::atomic<int64_t> Clock::virtual_now{0};
+
+int64_t Clock::now() {
+  if (isVirtual()) {
+    return virtual_now.load(std::memory_order_relaxed);
+  }
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+void Clock::sleepUntil(int64_t deadline) {
+  if (isVirtual()) {
+    advanceTo(deadline);
+    return;
+  }
+  struct timespec ts;
+  ts.tv_sec = deadline / NSEC_PER_SEC;
+  ts.tv_nsec = deadline % NSEC_PER_SEC;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+}
+
+void Clock::useVirtual(int64_t start) {
+  virtual_now.store(start, std::memory_order_relaxed);
+  virtual_mode.store(true, std::memory_order_relaxed);
+}
+
+void Clock::useSystem() {
+  virtual_mode.store(false, std::memory_order_relaxed);
+}
+
+void Clock::advanceTo(int64_t time) {
+  int64_t current = virtual_now.load(std::memory_order_relaxed);
+  while (time > current &&
+         !virtual_now.compare_exchange_weak(current, time, std::memory_order_relaxed)) {}
+}
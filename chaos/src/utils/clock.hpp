@@ -0,0 +1,82 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace Chaos {
+
+  /**
+   * \brief Source of time for the engine's timers and sequences.
+   *
+   * Normally this reads the system's monotonic clock. A replay harness can switch it to a virtual
+   * clock that only moves when told to, so that a long session can be replayed as fast as the
+   * engine can process it and gives the same result every time. The virtual clock is meant to be
+   * driven from a single thread.
+   *
+   * All times are in nanoseconds.
+   */
+  class Clock {
+  public:
+    static const int64_t NSEC_PER_SEC = 1000000000;
+
+    /**
+     * \brief Get the current time.
+     */
+    static int64_t now();
+
+    /**
+     * \brief Block until the clock reaches the deadline.
+     *
+     * On the virtual clock, this advances the clock to the deadline instead of sleeping.
+     */
+    static void sleepUntil(int64_t deadline);
+
+    /**
+     * \brief Switch to the virtual clock.
+     *
+     * \param start Time the virtual clock starts at
+     */
+    static void useVirtual(int64_t start = 0);
+
+    /**
+     * \brief Switch back to the system clock.
+     */
+    static void useSystem();
+
+    /**
+     * \brief Is the virtual clock in use?
+     */
+    static bool isVirtual() { return virtual_mode.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Move the virtual clock forward to the given time.
+     *
+     * The clock never runs backwards, so earlier times are ignored. Has no effect on the system
+     * clock.
+     */
+    static void advanceTo(int64_t time);
+
+  private:
+    static std::atomic<bool> virtual_mode;
+    static std::atomic<int64_t> virtual_now;
+  };
+
+};
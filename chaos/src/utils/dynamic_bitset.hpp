@@ -0,0 +1,145 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Chaos {
+
+  /**
+   * \brief Set of small integers stored as a bitset whose size is chosen at run time.
+   *
+   * Used to hold sets of ids, such as the modifiers in a group, where the number of possible
+   * members is only known once a configuration has been loaded. Sets of different sizes can be
+   * combined; bits past the end of the shorter set count as clear.
+   */
+  class DynamicBitset {
+  public:
+    DynamicBitset() = default;
+    explicit DynamicBitset(size_t bits) : nbits{bits}, words((bits + 63) / 64, 0) {}
+
+    size_t size() const { return nbits; }
+
+    void set(size_t i) { words[i / 64] |= bit(i); }
+    void reset(size_t i) { words[i / 64] &= ~bit(i); }
+    bool test(size_t i) const { return i < nbits && (words[i / 64] & bit(i)) != 0; }
+
+    /**
+     * \brief Set every bit from 0 to size() - 1.
+     */
+    void fill() {
+      for (auto& w : words) {
+        w = ~uint64_t{0};
+      }
+      if (nbits % 64) {
+        words.back() = bit(nbits) - 1;
+      }
+    }
+
+    void clear() {
+      for (auto& w : words) {
+        w = 0;
+      }
+    }
+
+    /**
+     * \brief Number of bits that are set.
+     */
+    size_t count() const {
+      size_t n = 0;
+      for (auto w : words) {
+        n += std::bitset<64>(w).count();
+      }
+      return n;
+    }
+
+    bool none() const {
+      for (auto w : words) {
+        if (w) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * \brief Position of the n-th set bit, counting from zero.
+     *
+     * \return The position, or size() if fewer than n + 1 bits are set
+     */
+    size_t nth(size_t n) const {
+      for (size_t i = 0; i < words.size(); ++i) {
+        size_t in_word = std::bitset<64>(words[i]).count();
+        if (n >= in_word) {
+          n -= in_word;
+          continue;
+        }
+        uint64_t w = words[i];
+        for (; n > 0; --n) {
+          w &= w - 1;
+        }
+        return i * 64 + lowest(w);
+      }
+      return nbits;
+    }
+
+    DynamicBitset& operator|=(const DynamicBitset& other) {
+      for (size_t i = 0; i < words.size() && i < other.words.size(); ++i) {
+        words[i] |= other.words[i];
+      }
+      return *this;
+    }
+
+    DynamicBitset& operator&=(const DynamicBitset& other) {
+      for (size_t i = 0; i < words.size(); ++i) {
+        words[i] &= (i < other.words.size()) ? other.words[i] : 0;
+      }
+      return *this;
+    }
+
+    /**
+     * \brief Remove every member of another set.
+     */
+    DynamicBitset& operator-=(const DynamicBitset& other) {
+      for (size_t i = 0; i < words.size() && i < other.words.size(); ++i) {
+        words[i] &= ~other.words[i];
+      }
+      return *this;
+    }
+
+  private:
+    static uint64_t bit(size_t i) { return uint64_t{1} << (i % 64); }
+
+    static size_t lowest(uint64_t w) {
+      size_t pos = 0;
+      while (!(w & 1)) {
+        w >>= 1;
+        ++pos;
+      }
+      return pos;
+    }
+
+    size_t nbits = 0;
+    std::vector<uint64_t> words;
+  };
+
+};
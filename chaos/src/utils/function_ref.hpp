@@ -0,0 +1,59 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Chaos {
+
+  template <typename Signature>
+  class FunctionRef;
+
+  /**
+   * \brief Non-owning reference to a callable.
+   *
+   * A FunctionRef holds a pointer to the callable and a pointer to a function that invokes it. It
+   * never allocates and costs one indirect call, which makes it a cheaper parameter type than
+   * std::function for callbacks that are only used during the call they are passed to.
+   *
+   * The reference must not outlive the callable. Don't store one, and don't build one from a
+   * temporary that will be gone by the time it is called.
+   */
+  template <typename R, typename... Args>
+  class FunctionRef<R(Args...)> {
+  public:
+    template <typename F, typename = std::enable_if_t<
+                            !std::is_same_v<std::decay_t<F>, FunctionRef> &&
+                            std::is_invocable_r_v<R, F&, Args...>>>
+    FunctionRef(F&& f) noexcept
+      : object{const_cast<void*>(static_cast<const void*>(std::addressof(f)))},
+        invoke{[](void* obj, Args... args) -> R {
+          return (*static_cast<std::remove_reference_t<F>*>(obj))(std::forward<Args>(args)...);
+        }} {}
+
+    R operator()(Args... args) const { return invoke(object, std::forward<Args>(args)...); }
+
+  private:
+    void* object;
+    R (*invoke)(void*, Args...);
+  };
+
+};
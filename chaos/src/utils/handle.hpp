@@ -0,0 +1,57 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstddef>
+#include <memory>
+
+namespace Chaos {
+
+  /**
+   * \brief Non-owning reference to an object whose lifetime is managed elsewhere.
+   *
+   * Game commands, controller inputs, and game conditions are owned through std::shared_ptr by the
+   * Game that defines them and live as long as the game stays loaded. Passing those pointers by
+   * value on every event costs an atomic reference-count update each time. A Handle is a plain
+   * pointer that can be built from the owning shared_ptr, so per-event and per-tick code can use it
+   * without touching the count.
+   *
+   * A Handle must not outlive the object's owner.
+   */
+  template <typename T>
+  class Handle {
+  public:
+    Handle() = default;
+    Handle(std::nullptr_t) {}
+    Handle(T* p) : ptr{p} {}
+    Handle(const std::shared_ptr<T>& p) : ptr{p.get()} {}
+
+    T* get() const { return ptr; }
+    T* operator->() const { return ptr; }
+    T& operator*() const { return *ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
+
+    bool operator==(const Handle& other) const { return ptr == other.ptr; }
+    bool operator!=(const Handle& other) const { return ptr != other.ptr; }
+
+  private:
+    T* ptr = nullptr;
+  };
+
+};
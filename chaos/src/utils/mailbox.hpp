@@ -0,0 +1,99 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace Chaos {
+
+  /**
+   * \brief Lock-free multiple-producer, single-consumer queue.
+   *
+   * Any number of threads may post messages. One thread takes them all at once with drain(), which
+   * hands them over in the order they were posted. Neither side ever blocks the other: posting is
+   * a single compare-and-swap, and draining is a single exchange.
+   */
+  template <typename T>
+  class Mailbox {
+  public:
+    Mailbox() = default;
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    ~Mailbox() {
+      drain([](T&&) {});
+    }
+
+    /**
+     * \brief Add a message to the mailbox. Safe to call from any thread.
+     */
+    void post(T message) {
+      Node* node = new Node{std::move(message), head.load(std::memory_order_relaxed)};
+      while (!head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+      }
+    }
+
+    /**
+     * \brief Hand every waiting message to a function, oldest first.
+     *
+     * Only one thread may drain the mailbox.
+     *
+     * \param receive Called once for each message, with the message moved into it
+     * \return The number of messages received
+     */
+    template <typename F>
+    size_t drain(F&& receive) {
+      Node* node = head.exchange(nullptr, std::memory_order_acquire);
+      // The list comes off newest-first. Reverse it to restore posting order.
+      Node* oldest = nullptr;
+      while (node) {
+        Node* next = node->next;
+        node->next = oldest;
+        oldest = node;
+        node = next;
+      }
+      size_t count = 0;
+      while (oldest) {
+        Node* next = oldest->next;
+        receive(std::move(oldest->message));
+        delete oldest;
+        oldest = next;
+        ++count;
+      }
+      return count;
+    }
+
+    /**
+     * \brief Is the mailbox currently empty?
+     */
+    bool empty() const { return head.load(std::memory_order_acquire) == nullptr; }
+
+  private:
+    struct Node {
+      T message;
+      Node* next;
+    };
+
+    std::atomic<Node*> head{nullptr};
+  };
+
+};
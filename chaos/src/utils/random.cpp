@@ -20,40 +20,137 @@
  * This file contains code derived from the mogillc/nico library by Matt Bunting, Copyright 2016 by
  * Mogi, LLC and distributed under the LGPL library version 2 license.
  * The original version can be found here: https://github.com/mogillc/nico
- * 
- * TO DO: Replace this with something from the C++ <random> library
 */
-#include <math.h>
-#include <time.h>
+#include <atomic>
+#include <cmath>
+#include <random>
 #include "random.hpp"
 
 using namespace Chaos;
 
-Random::Random() {
-	srand(time(NULL));
+namespace {
+
+  // Incremented whenever the seed changes, so each thread knows to reseed its generator
+  std::atomic<uint64_t> seed_epoch{1};
+  std::atomic<bool> seed_fixed{false};
+  std::atomic<uint64_t> seed_value{0};
+  // Order in which threads have seeded their generators since the last seed change
+  std::atomic<uint64_t> stream_count{0};
+
+  uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  // xoshiro256** by David Blackman and Sebastiano Vigna (public domain)
+  struct Xoshiro256 {
+    uint64_t s[4] = {0, 0, 0, 0};
+    uint64_t epoch = 0;
+    bool have_spare = false;
+    double spare = 0;
+
+    void reseed() {
+      uint64_t x;
+      if (seed_fixed.load(std::memory_order_acquire)) {
+        x = seed_value.load(std::memory_order_relaxed) +
+            0x632BE59BD9B4E019ULL * stream_count.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        std::random_device rd;
+        x = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+      }
+      for (auto& word : s) {
+        word = splitmix64(x);
+      }
+      have_spare = false;
+    }
+
+    uint64_t next() {
+      const uint64_t current = seed_epoch.load(std::memory_order_acquire);
+      if (epoch != current) {
+        epoch = current;
+        reseed();
+      }
+      const uint64_t result = rotl(s[1] * 5, 7) * 9;
+      const uint64_t t = s[1] << 17;
+      s[2] ^= s[0];
+      s[3] ^= s[1];
+      s[1] ^= s[2];
+      s[0] ^= s[3];
+      s[2] ^= t;
+      s[3] = rotl(s[3], 45);
+      return result;
+    }
+  };
+
+  thread_local Xoshiro256 generator;
+
+  // Uniform double in [0, 1) from the top 53 bits
+  double unit() {
+    return (generator.next() >> 11) * 0x1.0p-53;
+  }
 }
 
-double Random::uniform(double min, double max) {
-	return (max - min) * ((double) rand() / (double) RAND_MAX) + min;
+void Random::seed(uint64_t value) {
+  seed_value.store(value, std::memory_order_relaxed);
+  stream_count.store(0, std::memory_order_relaxed);
+  seed_fixed.store(true, std::memory_order_release);
+  seed_epoch.fetch_add(1, std::memory_order_acq_rel);
 }
 
-double Random::normal(double mean, double variance) {
-	// from http://en.wikipedia.org/wiki/Box–Muller_transform
-	static bool haveSpare = false;
-	static double rand1, rand2;
+void Random::seedRandomly() {
+  seed_fixed.store(false, std::memory_order_release);
+  seed_epoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
+uint64_t Random::next() {
+  return generator.next();
+}
+
+uint64_t Random::below(uint64_t n) {
+  if (n == 0) {
+    return 0;
+  }
+  // Reject the values at the bottom of the range that would make some results more likely
+  const uint64_t threshold = (0 - n) % n;
+  uint64_t x;
+  do {
+    x = generator.next();
+  } while (x < threshold);
+  return x % n;
+}
 
-	if (haveSpare) {
-		haveSpare = false;
-		return sqrt(variance * rand1) * sin(rand2) + mean;
-	}
+int64_t Random::between(int64_t min, int64_t max) {
+  if (max <= min) {
+    return min;
+  }
+  return min + static_cast<int64_t>(below(static_cast<uint64_t>(max - min) + 1));
+}
 
-	haveSpare = true;
+double Random::uniform(double min, double max) {
+  return (max - min) * unit() + min;
+}
+
+double Random::normal(double mean, double variance) {
+  // from http://en.wikipedia.org/wiki/Box–Muller_transform
+  if (generator.have_spare) {
+    generator.have_spare = false;
+    return std::sqrt(variance) * generator.spare + mean;
+  }
 
-	rand1 = rand() / ((double) RAND_MAX);
-	if (rand1 < 1e-100)
-		rand1 = 1e-100;
-	rand1 = -2 * log(rand1);
-	rand2 = (rand() / ((double) RAND_MAX)) * 2 * M_PI;
+  double rand1 = unit();
+  if (rand1 < 1e-100) {
+    rand1 = 1e-100;
+  }
+  rand1 = std::sqrt(-2 * std::log(rand1));
+  const double rand2 = unit() * 2 * M_PI;
 
-	return sqrt(variance * rand1) * cos(rand2) + mean;
+  generator.spare = rand1 * std::sin(rand2);
+  generator.have_spare = true;
+  return std::sqrt(variance) * rand1 * std::cos(rand2) + mean;
 }
@@ -20,22 +20,57 @@
  * This file contains code derived from the mogillc/nico library by Matt Bunting, Copyright 2016 by
  * Mogi, LLC and distributed under the LGPL library version 2 license.
  * The original version can be found here: https://github.com/mogillc/nico
- * 
- * TO DO: Replace this with something from the C++ <random> library
  */
 #pragma once
+#include <cstddef>
+#include <cstdint>
 
 namespace Chaos {
 
+  /**
+   * \brief Fast random numbers for modifier selection and randomized effects.
+   *
+   * Each thread draws from its own xoshiro256** generator, so there is no shared state or lock.
+   * Random objects are only a view onto the calling thread's generator, and constructing one is
+   * free; it does not reseed anything.
+   *
+   * The generators are seeded from std::random_device unless seed() has been called. With a fixed
+   * seed, each thread's generator is derived from the seed and the order in which threads first
+   * draw from it, so a single-threaded run such as a replay repeats exactly.
+   */
   class Random {
   public:
     /**
-     * \brief Construct the random-number generator wrapper.
+     * \brief Set the seed for every thread's generator.
+     *
+     * Generators that have already been used are reseeded on their next draw.
+     */
+    static void seed(uint64_t value);
+
+    /**
+     * \brief Go back to seeding from std::random_device.
+     */
+    static void seedRandomly();
+
+    /**
+     * \brief Next raw 64-bit value from this thread's generator.
+     */
+    uint64_t next();
+
+    /**
+     * \brief Draw an integer uniformly from [0, n). Returns 0 if n is 0.
+     *
+     * Unlike scaling a floating-point sample, every value is equally likely.
+     */
+    uint64_t below(uint64_t n);
+
+    /**
+     * \brief Draw an integer uniformly from [min, max].
      */
-    Random();
+    int64_t between(int64_t min, int64_t max);
 
     /**
-     * \brief Draw a uniform sample in [min, max].
+     * \brief Draw a uniform sample in [min, max).
      */
     double uniform(double min, double max);
 
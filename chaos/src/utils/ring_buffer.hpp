@@ -0,0 +1,92 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Chaos {
+
+  /**
+   * \brief First-in, first-out queue with a fixed capacity.
+   *
+   * All storage is allocated when the buffer is created, so pushing and popping never touch the
+   * heap. When the buffer is full, push() discards the oldest element to make room.
+   *
+   * The buffer does no locking of its own.
+   */
+  template <typename T>
+  class RingBuffer {
+  public:
+    explicit RingBuffer(size_t capacity = 0) : slots(capacity) {}
+
+    size_t capacity() const { return slots.size(); }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == slots.size(); }
+
+    T& front() { return slots[head]; }
+    const T& front() const { return slots[head]; }
+
+    /**
+     * \brief Add an element at the back.
+     *
+     * \return false if the buffer was full and the oldest element was discarded to make room
+     */
+    bool push(T value) {
+      if (slots.empty()) {
+        return false;
+      }
+      bool kept_all = true;
+      if (full()) {
+        pop();
+        kept_all = false;
+      }
+      size_t tail = head + count;
+      if (tail >= slots.size()) {
+        tail -= slots.size();
+      }
+      slots[tail] = std::move(value);
+      ++count;
+      return kept_all;
+    }
+
+    /**
+     * \brief Remove the front element.
+     */
+    void pop() {
+      if (++head == slots.size()) {
+        head = 0;
+      }
+      --count;
+    }
+
+    void clear() {
+      head = 0;
+      count = 0;
+    }
+
+  private:
+    std::vector<T> slots;
+    size_t head = 0;
+    size_t count = 0;
+  };
+
+};
@@ -0,0 +1,240 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+namespace Chaos {
+
+  /**
+   * \brief Ordered container with a fixed capacity and generation-tagged slots.
+   *
+   * Elements live in a fixed array of slots, so adding and removing them never touches the heap.
+   * A separate index array keeps the elements in the order they were added, and iteration follows
+   * that order.
+   *
+   * Each slot carries a generation number that changes whenever the slot is emptied. An Id taken
+   * when an element was added therefore stops resolving once that element has been removed, even
+   * if the slot has since been reused.
+   *
+   * The container is meant for the handful of elements the engine juggles every tick. Removal
+   * shifts the index array, which costs O(N) but N is small.
+   */
+  template <typename T, size_t N>
+  class SlotArray {
+    static_assert(N > 0 && N < 0xFFFF, "SlotArray capacity out of range");
+
+  public:
+    /**
+     * \brief Generation-tagged reference to an element.
+     */
+    struct Id {
+      uint16_t index = 0xFFFF;
+      uint16_t generation = 0;
+
+      bool valid() const { return index != 0xFFFF; }
+      bool operator==(const Id& other) const {
+        return index == other.index && generation == other.generation;
+      }
+    };
+
+    template <typename C, typename V>
+    class Iterator {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = V*;
+      using reference = V&;
+
+      Iterator() = default;
+      Iterator(C* c, size_t p) : container{c}, position{p} {}
+
+      reference operator*() const { return container->slots[container->order[position]].value; }
+      pointer operator->() const { return &**this; }
+      Iterator& operator++() { ++position; return *this; }
+      Iterator operator++(int) { Iterator old = *this; ++position; return old; }
+      bool operator==(const Iterator& other) const { return position == other.position; }
+      bool operator!=(const Iterator& other) const { return position != other.position; }
+
+      /**
+       * \brief Generation-tagged reference to the element at this position.
+       */
+      Id id() const {
+        uint16_t index = container->order[position];
+        return Id{index, container->slots[index].generation};
+      }
+
+    private:
+      friend class SlotArray;
+      C* container = nullptr;
+      size_t position = 0;
+    };
+
+    using iterator = Iterator<SlotArray, T>;
+    using const_iterator = Iterator<const SlotArray, const T>;
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    T& front() { return slots[order[0]].value; }
+
+    /**
+     * \brief Add an element after the existing ones.
+     *
+     * \return The element's Id, or an invalid Id if the array is full.
+     */
+    Id push_back(T value) {
+      if (full()) {
+        return Id{};
+      }
+      uint16_t index = free_list[N - 1 - count];
+      Slot& slot = slots[index];
+      slot.value = std::move(value);
+      slot.used = true;
+      order[count++] = index;
+      return Id{index, slot.generation};
+    }
+
+    /**
+     * \brief Remove the element at a position, keeping the order of the rest.
+     *
+     * \return The moved-out element
+     */
+    T take(iterator it) {
+      uint16_t index = order[it.position];
+      for (size_t i = it.position + 1; i < count; ++i) {
+        order[i - 1] = order[i];
+      }
+      --count;
+      Slot& slot = slots[index];
+      T value = std::move(slot.value);
+      slot.value = T{};
+      slot.used = false;
+      ++slot.generation;
+      free_list[N - 1 - count] = index;
+      return value;
+    }
+
+    void erase(iterator it) { take(it); }
+
+    /**
+     * \brief Remove the first element equal to value.
+     *
+     * \return true if an element was removed
+     */
+    bool remove(const T& value) {
+      iterator it = find(value);
+      if (it == end()) {
+        return false;
+      }
+      erase(it);
+      return true;
+    }
+
+    void clear() {
+      while (!empty()) {
+        erase(iterator(this, count - 1));
+      }
+    }
+
+    iterator find(const T& value) {
+      return find_if([&value](const T& v) { return v == value; });
+    }
+
+    template <typename P>
+    iterator find_if(P&& pred) {
+      for (size_t i = 0; i < count; ++i) {
+        if (pred(slots[order[i]].value)) {
+          return iterator(this, i);
+        }
+      }
+      return end();
+    }
+
+    bool contains(const T& value) const {
+      for (size_t i = 0; i < count; ++i) {
+        if (slots[order[i]].value == value) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /**
+     * \brief Look up an element by Id.
+     *
+     * \return The element, or nullptr if it has been removed since the Id was taken
+     */
+    T* get(Id id) {
+      if (id.index >= N || !slots[id.index].used || slots[id.index].generation != id.generation) {
+        return nullptr;
+      }
+      return &slots[id.index].value;
+    }
+
+    /**
+     * \brief Position of an element by Id, or end() if it is no longer present.
+     */
+    iterator locate(Id id) {
+      if (!get(id)) {
+        return end();
+      }
+      for (size_t i = 0; i < count; ++i) {
+        if (order[i] == id.index) {
+          return iterator(this, i);
+        }
+      }
+      return end();
+    }
+
+    SlotArray() {
+      // Hand out slots from the back of the free list so that a fresh array fills slot 0 first.
+      for (size_t i = 0; i < N; ++i) {
+        free_list[i] = static_cast<uint16_t>(N - 1 - i);
+      }
+    }
+
+  private:
+    struct Slot {
+      T value{};
+      uint16_t generation = 0;
+      bool used = false;
+    };
+
+    std::array<Slot, N> slots{};
+    // Slot indices in insertion order. The first 'count' entries are live.
+    std::array<uint16_t, N> order{};
+    // Stack of unused slot indices. The first N - count entries are free.
+    std::array<uint16_t, N> free_list{};
+    size_t count = 0;
+  };
+
+};
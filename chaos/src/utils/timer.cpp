@@ -23,38 +23,42 @@
  * 
  */
 #include "timer.hpp"
-#include <sys/time.h>
+#include "clock.hpp"
 
 using namespace Chaos;
 
 Timer::Timer() {}
 
 void Timer::initialize() {
-	// timecycle = chr::time_point_cast<usec>(chr::steady_clock::now());
-  gettimeofday(&tv, nullptr); // Grab the current time (simply an initialization)
-	timecycle = tv.tv_sec + tv.tv_usec * 1e-6; // Compute the current time, in seconds
-	runningtime = 0;
-  // runningtime = usec::zero();
+  initialize(Clock::now());
+}
+
+void Timer::initialize(int64_t now) {
+  timecycle = now;
+  oldtimecycle = now;
+  dtime = 0;
+  runningtime = 0;
 }
 
 void Timer::update() {
-	oldtimecycle = timecycle;  // Store the old time
-  gettimeofday(&tv, nullptr);   // Grab the current time
-	timecycle = tv.tv_sec + tv.tv_usec * 1e-6; // Compute the current time, in seconds  // Store the old time
-  // Grab the current time
-	// timecycle = chr::time_point_cast<usec>(chr::steady_clock::now());
-	dtime = timecycle - oldtimecycle;
+  update(Clock::now());
+}
+
+void Timer::update(int64_t now) {
+  oldtimecycle = timecycle;  // Store the old time
+  timecycle = now;
+  dtime = timecycle - oldtimecycle;
   runningtime += dtime;
 }
 
 void Timer::reset() {
-	initialize();
+  initialize();
 }
 
 usec Timer::runningTime() {
-	return runningtime;
+  return runningtime * 1e-9;
 }
 
 usec Timer::dTime() {
-	return dtime;
+  return dtime * 1e-9;
 }
@@ -23,31 +23,28 @@
  * 
  */
 #pragma once
-//#include <chrono>
-#include <sys/time.h>
-
-//namespace chr = std::chrono;
+#include <cstdint>
 
 namespace Chaos {
 
-  //using usec = std::chrono::microseconds;
   using usec = double;
 
   /**
    * \brief Keeps track of time
    * 
    * This keeps track of time such as running time and change in loop time. This is the Time class
-   * from the Mogi librar re-implemented to use chrono.
+   * from the Mogi library, re-implemented to count integer nanoseconds on the monotonic Clock.
+   *
+   * Times can be supplied by the caller. The engine reads the clock once per tick and hands the
+   * same timestamp to every modifier, so a tick costs one clock read no matter how many timers it
+   * advances.
    */
   class Timer {
   private:
-    struct timeval tv;
-    double timecycle;
-    // chr::time_point<chr::steady_clock, std::chrono::microseconds> timecycle;
-    double oldtimecycle;
-    // chr::time_point<chr::steady_clock, std::chrono::microseconds> oldtimecycle;
-    usec dtime;
-    usec runningtime;
+    int64_t timecycle = 0;
+    int64_t oldtimecycle = 0;
+    int64_t dtime = 0;
+    int64_t runningtime = 0;
   public:
     /**
      * \brief Construct a timer and initialize internal state.
@@ -67,6 +64,13 @@ namespace Chaos {
      */
     void update();  // updates to get new time values
 
+    /**
+     * \brief Updates the measured components using a time already read from the Clock.
+     *
+     * \param now Current time in nanoseconds, as returned by Clock::now()
+     */
+    void update(int64_t now);
+
     /**
      * \brief Starts the internal time measurement.
      * 
@@ -75,9 +79,16 @@ namespace Chaos {
      */
     void initialize();  // self explanatory
 
+    /**
+     * \brief Starts the internal time measurement from a time already read from the Clock.
+     *
+     * \param now Current time in nanoseconds, as returned by Clock::now()
+     */
+    void initialize(int64_t now);
+
     /**
      * \brief Get the running time since initialization.
-     * \return The time since initialize() was called.
+     * \return The time since initialize() was called, in seconds.
      */
     usec runningTime();
 
@@ -85,9 +96,14 @@ namespace Chaos {
      * \brief Returns the last computed difference in time between the most recent update() and the
      * update() prior to that.
      *
-     * \return The delta time between the previous two update() calls.
+     * \return The delta time between the previous two update() calls, in seconds.
      */
     usec dTime();
+
+    /**
+     * \brief Clock time of the most recent initialize() or update(), in nanoseconds.
+     */
+    int64_t lastTime() const { return timecycle; }
   };
 
 };
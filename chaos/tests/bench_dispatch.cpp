@@ -0,0 +1,164 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <clock.hpp>
+#include <ChaosEngine.hpp>
+#include <Controller.hpp>
+#include <DeviceEvent.hpp>
+#include <signals.hpp>
+
+using namespace Chaos;
+
+// Measures the cost of passing controller events through the active modifiers. Prints the cost
+// of a whole event, from the controller through the engine pipeline to the output, and the cost
+// of a single modifier tweak call.
+//
+// Usage: bench_dispatch [events]
+
+namespace {
+
+const char* CONFIG = R"(
+config_file_ver = "1.0"
+chaos_toml = "main"
+game = "Dispatch Benchmark"
+
+[mod_defaults]
+active_modifiers = 4
+time_per_modifier = 3600.0
+
+[controller]
+button_press_time = 0.01
+button_release_time = 0.01
+
+[menu]
+use_menu = false
+
+[[command]]
+name = "MOVE_X"
+binding = "LX"
+
+[[command]]
+name = "MOVE_Y"
+binding = "LY"
+
+[[command]]
+name = "CAMERA_Y"
+binding = "RY"
+
+[[command]]
+name = "JUMP"
+binding = "X"
+
+[[modifier]]
+name = "Inverted"
+type = "scaling"
+applies_to = [ "CAMERA_Y" ]
+amplitude = -1
+
+[[modifier]]
+name = "Moonwalk"
+type = "scaling"
+applies_to = [ "MOVE_Y" ]
+amplitude = -1
+
+[[modifier]]
+name = "Drunk"
+type = "scaling"
+applies_to = [ "MOVE_X" ]
+amplitude = 0.5
+
+[[modifier]]
+name = "No Jumping"
+type = "disable"
+applies_to = [ "JUMP" ]
+)";
+
+const std::vector<std::string> MODS = {"Inverted", "Moonwalk", "Drunk", "No Jumping"};
+
+class BenchController : public Controller {
+public:
+  void inject(const DeviceEvent& event) { handleNewDeviceEvent(event); }
+};
+
+// Axis events with a changing value, so that no modifier sees the same event twice in a row
+DeviceEvent nextEvent(long n) {
+  static const uint8_t axes[] = {AXIS_LX, AXIS_LY, AXIS_RY};
+  return DeviceEvent{0, static_cast<short>(n % 255 - 127), TYPE_AXIS, axes[n % 3]};
+}
+
+double nsPer(std::chrono::steady_clock::time_point start, long count) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         static_cast<double>(count);
+}
+
+}
+
+int main(int argc, char** argv) {
+  using clock = std::chrono::steady_clock;
+  const long events = (argc > 1) ? std::atol(argv[1]) : 2000000;
+
+  char path[] = "/tmp/chaos_bench_XXXXXX.toml";
+  int fd = mkstemps(path, 5);
+  if (fd < 0) {
+    std::cerr << "Cannot create a temporary config file\n";
+    return EXIT_FAILURE;
+  }
+  close(fd);
+  std::ofstream(path) << CONFIG;
+
+  // Tick the engine by hand, as chaos_replay does, so no threads compete with the measurement
+  Clock::useVirtual(0);
+  BenchController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const bool loaded = engine.setGame(path);
+  std::remove(path);
+  if (!loaded) {
+    std::cerr << "Benchmark config did not load\n";
+    return EXIT_FAILURE;
+  }
+  controller.inject(DeviceEvent{0, 1, TYPE_BUTTON, BUTTON_SHARE});
+  controller.inject(DeviceEvent{0, 0, TYPE_BUTTON, BUTTON_SHARE});
+  for (const auto& name : MODS) {
+    engine.newCommand("{\"winner\":\"" + name + "\"}");
+    engine.tick();
+  }
+
+  std::vector<Modifier*> mods;
+  for (const auto& name : MODS) {
+    mods.push_back(engine.getModifier(name).get());
+  }
+  // Accumulate the outputs so the compiler can't drop the work
+  long sink = 0;
+
+  auto start = clock::now();
+  for (long n = 0; n < events; ++n) {
+    controller.inject(nextEvent(n));
+  }
+  const double pipeline_ns = nsPer(start, events);
+  sink += engine.getState(AXIS_LY, TYPE_AXIS);
+
+  start = clock::now();
+  for (long n = 0; n < events; ++n) {
+    DeviceEvent event = nextEvent(n);
+    for (Modifier* mod : mods) {
+      if (!mod->_tweak(event)) {
+        break;
+      }
+    }
+    sink += event.value;
+  }
+  const double tweak_ns = nsPer(start, events * static_cast<long>(mods.size()));
+
+  std::cout << mods.size() << " active mods: " << pipeline_ns << " ns/event through the engine; "
+            << "tweak " << tweak_ns << " ns/call (checksum " << sink << ")\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <Waveform.hpp>
+
+using namespace Chaos;
+
+// Compares the table-driven formula waveforms against the double-precision formulas they
+// replaced. Prints the cost per axis update and the largest difference seen.
+//
+// Usage: bench_formula [samples]
+
+namespace {
+
+const int AXES = 4;
+const double AMPLITUDE = 127.0;
+const double PERIOD = 1.7;
+const int64_t TICK_NS = 500000;
+
+int reference(FormulaTypes type, double t, int i) {
+  switch (type) {
+  case FormulaTypes::CIRCLE:
+    return (i % 2 == 0) ? static_cast<int>(AMPLITUDE * std::sin(t))
+                        : static_cast<int>(AMPLITUDE * std::cos(t));
+  case FormulaTypes::EIGHT_CURVE:
+    return static_cast<int>(AMPLITUDE * std::sin(4.0*(i+1)*(t+1.6)));
+  case FormulaTypes::JANKY:
+    return static_cast<int>(AMPLITUDE * (std::cos(t+4.0*i) + std::cos(2.0*t)/2.0) *
+                            std::sin((t+4.0*i)/5.0)/2.0);
+  default:
+    return 0;
+  }
+}
+
+void run(const std::string& name, FormulaTypes type, long samples) {
+  using clock = std::chrono::steady_clock;
+  Waveform waveform(type, AMPLITUDE, AXES);
+  // Accumulate the outputs so the compiler can't drop the work
+  long sink = 0;
+
+  auto start = clock::now();
+  for (long n = 0; n < samples; ++n) {
+    const double t = n * TICK_NS * 1e-9 * 2.0 * M_PI / PERIOD;
+    for (int i = 0; i < AXES; ++i) {
+      sink += reference(type, t, i);
+    }
+  }
+  const double double_ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+  start = clock::now();
+  for (long n = 0; n < samples; ++n) {
+    const Waveform::Phase p = Waveform::phase(n * TICK_NS * 1e-9 / PERIOD);
+    for (int i = 0; i < AXES; ++i) {
+      sink -= waveform.offset(i, p);
+    }
+  }
+  const double table_ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+  int worst = 0;
+  for (long n = 0; n < samples; ++n) {
+    const double seconds = n * TICK_NS * 1e-9;
+    const Waveform::Phase p = Waveform::phase(seconds / PERIOD);
+    for (int i = 0; i < AXES; ++i) {
+      const int diff = std::abs(waveform.offset(i, p) - reference(type, seconds * 2.0 * M_PI / PERIOD, i));
+      worst = std::max(worst, diff);
+    }
+  }
+
+  const double updates = static_cast<double>(samples) * AXES;
+  std::cout << name << ": double " << double_ns / updates << " ns/axis, table "
+            << table_ns / updates << " ns/axis, max difference " << worst
+            << " (checksum " << sink << ")\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+  // Default: one hour of engine ticks
+  const long samples = (argc > 1) ? std::atol(argv[1]) : 7200000;
+  run("circle", FormulaTypes::CIRCLE, samples);
+  run("eight_curve", FormulaTypes::EIGHT_CURVE, samples);
+  run("janky", FormulaTypes::JANKY, samples);
+  return 0;
+}
@@ -1,7 +1,9 @@
 #include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <fcntl.h>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -16,6 +18,8 @@
 #include <Modifier.hpp>
 #include <Controller.hpp>
 #include <DeviceEvent.hpp>
+#include <FlightRecorder.hpp>
+#include <GameMetadataCache.hpp>
 #include <signals.hpp>
 
 using namespace Chaos;
@@ -23,6 +27,21 @@ using namespace Chaos;
 class TestController : public Controller {
 public:
   void inject(const DeviceEvent& event) { handleNewDeviceEvent(event); }
+
+  // While the gate is closed, anything that presses R2 (e.g., a sequence) stalls until it opens
+  std::atomic<bool> r2_gate_closed{false};
+  std::atomic<bool> r2_gate_reached{false};
+
+  void applyEvent(const DeviceEvent& event) override {
+    if ((event.type == TYPE_BUTTON && event.id == BUTTON_R2) ||
+        (event.type == TYPE_AXIS && event.id == AXIS_R2)) {
+      while (r2_gate_closed.load()) {
+        r2_gate_reached.store(true);
+        usleep(1000);
+      }
+    }
+    Controller::applyEvent(event);
+  }
 };
 
 struct IpcEndpoint {
@@ -113,6 +132,25 @@ std::atomic<bool> RaceModifier::block_updates{false};
 std::atomic<bool> RaceModifier::finish_called{false};
 std::atomic<bool> RaceModifier::overlap{false};
 
+class CountingModifier : public Modifier::Registrar<CountingModifier> {
+public:
+  static const std::string mod_type;
+  std::atomic<int> updates{0};
+
+  CountingModifier(toml::table& config, EngineInterface* e) { initialize(config, e); }
+
+  const std::string& getModType() override { return mod_type; }
+
+  void update() override { updates.fetch_add(1); }
+};
+
+const std::string CountingModifier::mod_type = "test_counting";
+
+static int updateCount(ChaosEngine& engine, const std::string& name) {
+  auto mod = std::dynamic_pointer_cast<CountingModifier>(engine.getModifier(name));
+  return mod ? mod->updates.load() : -1;
+}
+
 static bool check(bool condition, const std::string& msg) {
   if (!condition) {
     std::cerr << "FAIL: " << msg << "\n";
@@ -186,10 +224,35 @@ type = "scaling"
 applies_to = [ "MOVE_Y" ]
 amplitude = -1
 
+[[modifier]]
+# Runs of spaces in a modifier name are collapsed
+name = "Upside   Down"
+type = "parent"
+children = [ "Inverted", "Moonwalk" ]
+
 [[modifier]]
 name = "SEQ_AXIS_CLIP"
 type = "sequence"
 begin_sequence = [ { event = "hold", command = "MOVE_Y", value = 128 } ]
+
+[[modifier]]
+name = "COUNTER"
+type = "test_counting"
+
+[[modifier]]
+name = "GATED_BEGIN"
+type = "test_counting"
+begin_sequence = [ { event = "hold", command = "FIRE" } ]
+
+[[modifier]]
+name = "CHILD_COUNTER"
+type = "test_counting"
+
+[[modifier]]
+name = "GATED_PARENT"
+type = "parent"
+children = [ "CHILD_COUNTER" ]
+begin_sequence = [ { event = "hold", command = "FIRE" } ]
 )";
 
   char path_template[] = "/tmp/chaos_engine_lifecycle_XXXXXX.toml";
@@ -630,6 +693,203 @@ static bool testScalingInvertedAndMoonwalkAffectExpectedAxes() {
   return ok;
 }
 
+static bool testBatchedInjectionPassesDownstreamModsTogether() {
+  bool ok = true;
+
+  TestController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const std::string config_path = writeConfigFile();
+  ok &= check(engine.setGame(config_path), "test config should load");
+
+  engine.start();
+  unpauseEngine(controller);
+  ok &= check(waitFor([&]() { return !engine.isPaused(); }),
+              "engine should be running before batched injection test");
+
+  engine.newCommand("{\"winner\":\"Moonwalk\"}");
+  ok &= check(waitFor([&]() { return activeCount(engine) == 1; }),
+              "Moonwalk should become active");
+
+  std::vector<DeviceEvent> batch = {{0, 50, TYPE_AXIS, AXIS_LX}, {0, 40, TYPE_AXIS, AXIS_LY}};
+  engine.fakePipelinedEvents(batch, nullptr);
+  ok &= check(batch.size() == 2, "batched events should all survive the scaling mod");
+  ok &= check(engine.getState(AXIS_LX, TYPE_AXIS) == 50,
+              "batched LX should be applied unchanged");
+  ok &= check(engine.getState(AXIS_LY, TYPE_AXIS) == -40,
+              "batched LY should pass through Moonwalk before being applied");
+
+  engine.stop();
+  engine.WaitForInternalThreadToExit();
+  std::remove(config_path.c_str());
+  return ok;
+}
+
+static bool testFlightRecorderCapturesModifierDecisions() {
+  bool ok = true;
+
+  TestController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const std::string config_path = writeConfigFile();
+  ok &= check(engine.setGame(config_path), "test config should load");
+
+  engine.start();
+  unpauseEngine(controller);
+  ok &= check(waitFor([&]() { return !engine.isPaused(); }),
+              "engine should be running before flight recorder test");
+
+  engine.newCommand("{\"winner\":\"Moonwalk\"}");
+  ok &= check(waitFor([&]() { return activeCount(engine) == 1; }),
+              "Moonwalk should become active");
+
+  controller.inject({0, 30, TYPE_AXIS, AXIS_LY});
+  ok &= check(waitFor([&]() { return engine.getState(AXIS_LY, TYPE_AXIS) == -30; }),
+              "Moonwalk should flip LY before the recording is dumped");
+
+  char path_template[] = "/tmp/chaos_flight_XXXXXX.tcr";
+  int fd = mkstemps(path_template, 4);
+  ok &= check(fd >= 0, "temporary recording file should be created");
+  close(fd);
+  ok &= check(engine.getFlightRecorder().dump(path_template, 5.0) > 0,
+              "dump should write the recorded events");
+
+  std::vector<std::string> names;
+  std::vector<FlightRecorder::Record> records;
+  std::ifstream in(path_template, std::ios::binary);
+  ok &= check(FlightRecorder::load(in, names, records), "dump should load back");
+
+  bool saw_rewrite = false;
+  bool saw_output = false;
+  for (const auto& rec : records) {
+    if (rec.in_type != TYPE_AXIS || rec.in_id != AXIS_LY || rec.in_value != 30) {
+      continue;
+    }
+    if (rec.stage == FlightRecorder::Stage::TWEAK && rec.modifier < names.size() &&
+        names[rec.modifier] == "Moonwalk") {
+      saw_rewrite = (rec.decision == FlightRecorder::Decision::REWRITE && rec.out_value == -30);
+    }
+    if (rec.stage == FlightRecorder::Stage::OUTPUT) {
+      saw_output = (rec.decision == FlightRecorder::Decision::REWRITE && rec.out_value == -30);
+    }
+  }
+  ok &= check(saw_rewrite, "recording should show Moonwalk rewriting LY");
+  ok &= check(saw_output, "recording should show the rewritten LY going to the console");
+
+  engine.stop();
+  engine.WaitForInternalThreadToExit();
+  std::remove(path_template);
+  std::remove(config_path.c_str());
+  return ok;
+}
+
+static bool testParentChildrenRunInEnginePipeline() {
+  bool ok = true;
+
+  TestController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const std::string config_path = writeConfigFile();
+  ok &= check(engine.setGame(config_path), "test config should load");
+
+  engine.start();
+  unpauseEngine(controller);
+  ok &= check(waitFor([&]() { return !engine.isPaused(); }),
+              "engine should be running before parent pipeline test");
+
+  engine.newCommand("{\"winner\":\"Upside Down\"}");
+  ok &= check(waitFor([&]() { return activeCount(engine) == 1; }),
+              "the parent should count as a single active mod");
+
+  controller.inject({0, -64, TYPE_AXIS, AXIS_RY});
+  ok &= check(waitFor([&]() { return engine.getState(AXIS_RY, TYPE_AXIS) == 64; }),
+              "the first child should tweak events while its parent is active");
+  controller.inject({0, 30, TYPE_AXIS, AXIS_LY});
+  ok &= check(waitFor([&]() { return engine.getState(AXIS_LY, TYPE_AXIS) == -30; }),
+              "the second child should tweak events while its parent is active");
+
+  char path_template[] = "/tmp/chaos_flight_XXXXXX.tcr";
+  int fd = mkstemps(path_template, 4);
+  close(fd);
+  engine.getFlightRecorder().dump(path_template, 5.0);
+  std::vector<std::string> names;
+  std::vector<FlightRecorder::Record> records;
+  std::ifstream in(path_template, std::ios::binary);
+  ok &= check(FlightRecorder::load(in, names, records), "dump should load back");
+  bool saw_child = false;
+  bool saw_parent = false;
+  for (const auto& rec : records) {
+    if (rec.stage != FlightRecorder::Stage::TWEAK || rec.modifier >= names.size()) {
+      continue;
+    }
+    saw_child |= (names[rec.modifier] == "Moonwalk");
+    saw_parent |= (names[rec.modifier] == "Upside Down");
+  }
+  ok &= check(saw_child && !saw_parent,
+              "children should sit in the pipeline in place of their parent");
+
+  engine.newCommand("{\"remove\":\"Upside Down\"}");
+  ok &= check(waitFor([&]() { return activeCount(engine) == 0; }),
+              "the parent should be removable");
+  controller.inject({0, 20, TYPE_AXIS, AXIS_LY});
+  ok &= check(waitFor([&]() { return engine.getState(AXIS_LY, TYPE_AXIS) == 20; }),
+              "children should leave the pipeline when their parent finishes");
+
+  engine.stop();
+  engine.WaitForInternalThreadToExit();
+  std::remove(path_template);
+  std::remove(config_path.c_str());
+  return ok;
+}
+
+static bool testModifierCostsAreCounted() {
+  bool ok = true;
+  ModifierProfile::setEnabled(true);
+
+  TestController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const std::string config_path = writeConfigFile();
+  ok &= check(engine.setGame(config_path), "test config should load");
+
+  engine.start();
+  unpauseEngine(controller);
+  ok &= check(waitFor([&]() { return !engine.isPaused(); }),
+              "engine should be running before cost accounting test");
+
+  engine.newCommand("{\"winner\":\"Moonwalk\"}");
+  ok &= check(waitFor([&]() { return activeCount(engine) == 1; }),
+              "Moonwalk should become active");
+  controller.inject({0, 25, TYPE_AXIS, AXIS_LY});
+  ok &= check(waitFor([&]() { return engine.getState(AXIS_LY, TYPE_AXIS) == -25; }),
+              "Moonwalk should process LY");
+
+  Json::Value costs = engine.getModifier("Moonwalk")->getProfile().toJson();
+  ok &= check(costs.isMember("begin") && costs["begin"]["calls"].asUInt64() == 1,
+              "begin should be counted once");
+  ok &= check(costs.isMember("update") && costs["update"]["calls"].asUInt64() >= 1,
+              "update calls should be counted");
+  ok &= check(costs.isMember("tweak") && costs["tweak"]["calls"].asUInt64() >= 1,
+              "tweak calls should be counted");
+  ok &= check(!costs.isMember("finish"), "finish should not be counted while the mod is active");
+  Json::UInt64 bucketed = 0;
+  for (const auto& bucket : costs["tweak"]["histogram"]) {
+    bucketed += bucket.asUInt64();
+  }
+  ok &= check(bucketed == costs["tweak"]["calls"].asUInt64(),
+              "every tweak call should land in one histogram bucket");
+  ok &= check(engine.getModifier("Inverted")->getProfile().empty(),
+              "inactive mods should have no recorded cost");
+
+  ModifierProfile::setEnabled(false);
+  controller.inject({0, 35, TYPE_AXIS, AXIS_LY});
+  ok &= check(waitFor([&]() { return engine.getState(AXIS_LY, TYPE_AXIS) == -35; }),
+              "Moonwalk should process LY with accounting off");
+  ok &= check(engine.getModifier("Moonwalk")->getProfile().toJson()["tweak"]["calls"] ==
+              costs["tweak"]["calls"], "no calls should be counted with accounting off");
+
+  engine.stop();
+  engine.WaitForInternalThreadToExit();
+  std::remove(config_path.c_str());
+  return ok;
+}
+
 static bool testSequenceBeginClipsOutOfRangeAxisValue() {
   bool ok = true;
 
@@ -655,6 +915,194 @@ static bool testSequenceBeginClipsOutOfRangeAxisValue() {
   return ok;
 }
 
+static bool testEngineKeepsTickingWhileSequencePlays() {
+  bool ok = true;
+
+  TestController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const std::string config_path = writeConfigFile();
+  ok &= check(engine.setGame(config_path), "test config should load");
+
+  engine.start();
+  unpauseEngine(controller);
+  ok &= check(waitFor([&]() { return !engine.isPaused(); }),
+              "engine should be running before sequence executor test");
+
+  // The begin sequence cannot finish until the gate opens, however long the test takes
+  controller.r2_gate_closed.store(true);
+  engine.newCommand("{\"winner\":\"GATED_BEGIN\"}");
+  ok &= check(waitFor([&]() { return controller.r2_gate_reached.load(); }),
+              "the begin sequence should start playing");
+  engine.newCommand("{\"winner\":\"COUNTER\"}");
+  ok &= check(waitFor([&]() { return activeCount(engine) == 2; }),
+              "a second mod should start while the first one's begin sequence is still playing");
+  ok &= check(waitFor([&]() { return updateCount(engine, "COUNTER") >= 3; }),
+              "the engine should keep ticking during the sequence");
+  engine.newCommand("{\"winner\":\"Moonwalk\"}");
+  ok &= check(waitFor([&]() { return activeCount(engine) == 3; }),
+              "a third mod should start while the begin sequence is still playing");
+  controller.inject({0, 20, TYPE_AXIS, AXIS_LY});
+  ok &= check(waitFor([&]() { return engine.getState(AXIS_LY, TYPE_AXIS) == -20; }),
+              "other mods should keep processing events during the sequence");
+  ok &= check(updateCount(engine, "GATED_BEGIN") == 0,
+              "a mod should not update until its own begin sequence has played");
+
+  controller.r2_gate_closed.store(false);
+  ok &= check(waitFor([&]() { return updateCount(engine, "GATED_BEGIN") > 0; }),
+              "the mod should start updating once its begin sequence completes");
+
+  engine.stop();
+  engine.WaitForInternalThreadToExit();
+  std::remove(config_path.c_str());
+  return ok;
+}
+
+static bool testChildrenWaitForParentBeginSequence() {
+  bool ok = true;
+
+  TestController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const std::string config_path = writeConfigFile();
+  ok &= check(engine.setGame(config_path), "test config should load");
+
+  engine.start();
+  unpauseEngine(controller);
+  ok &= check(waitFor([&]() { return !engine.isPaused(); }),
+              "engine should be running before parent begin-sequence test");
+
+  controller.r2_gate_closed.store(true);
+  engine.newCommand("{\"winner\":\"GATED_PARENT\"}");
+  ok &= check(waitFor([&]() { return controller.r2_gate_reached.load(); }),
+              "the parent's begin sequence should start playing");
+  engine.newCommand("{\"winner\":\"COUNTER\"}");
+  ok &= check(waitFor([&]() { return updateCount(engine, "COUNTER") >= 3; }),
+              "the engine should keep ticking during the parent's begin sequence");
+  ok &= check(updateCount(engine, "CHILD_COUNTER") == 0,
+              "a child should not update until its parent's begin sequence has played");
+
+  controller.r2_gate_closed.store(false);
+  ok &= check(waitFor([&]() { return updateCount(engine, "CHILD_COUNTER") > 0; }),
+              "the child should start updating once the parent's begin sequence completes");
+
+  engine.stop();
+  engine.WaitForInternalThreadToExit();
+  std::remove(config_path.c_str());
+  return ok;
+}
+
+static bool testCommandsApplyInOrderOnEngineThread() {
+  bool ok = true;
+  RaceModifier::reset();
+
+  TestController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const std::string config_path = writeConfigFile();
+  ok &= check(engine.setGame(config_path), "test config should load");
+
+  // Nothing is applied until the engine thread drains the mailbox
+  engine.newCommand("{\"winner\":\"RACE\"}");
+  engine.newCommand("{\"remove\":\"RACE\"}");
+  ok &= check(engine.getCommandLatency()["count"].asUInt64() == 0,
+              "commands should wait in the mailbox until the engine runs");
+
+  engine.start();
+  unpauseEngine(controller);
+  ok &= check(waitFor([&]() { return engine.getCommandLatency()["count"].asUInt64() == 2; }),
+              "engine thread should apply both queued commands");
+  usleep(20000);
+  ok &= check(activeCount(engine) == 0,
+              "remove should apply after the winner it follows");
+  ok &= check(engine.getCommandLatency()["max_us"].asDouble() > 0.0,
+              "receive-to-apply latency should be measured");
+
+  engine.stop();
+  engine.WaitForInternalThreadToExit();
+  std::remove(config_path.c_str());
+  return ok;
+}
+
+static bool testActiveSlotsAreReusedAfterRemoval() {
+  bool ok = true;
+  RaceModifier::reset();
+
+  TestController controller;
+  ChaosEngine engine(controller, "", "", false);
+  const std::string config_path = writeConfigFile();
+  ok &= check(engine.setGame(config_path), "test config should load");
+
+  engine.start();
+  unpauseEngine(controller);
+
+  for (int round = 0; round < 3; ++round) {
+    engine.newCommand("{\"winner\":\"RACE\"}");
+    ok &= check(waitFor([&]() { return activeCount(engine) == 1; }),
+                "mod should become active in its slot");
+    engine.newCommand("{\"remove\":\"RACE\"}");
+    ok &= check(waitFor([&]() { return activeCount(engine) == 0; }),
+                "removed mod should free its slot");
+  }
+  // A winner that arrives with a pending removal cancels the removal
+  engine.newCommand("{\"winner\":\"RACE\"}");
+  ok &= check(waitFor([&]() { return activeCount(engine) == 1; }), "mod should be active again");
+  engine.newCommand("{\"remove\":\"RACE\"}");
+  engine.newCommand("{\"winner\":\"RACE\"}");
+  usleep(20000);
+  ok &= check(activeCount(engine) == 1, "refreshed mod should stay active");
+
+  engine.stop();
+  engine.WaitForInternalThreadToExit();
+  std::remove(config_path.c_str());
+  return ok;
+}
+
+static bool testGameMetadataCacheSkipsUnchangedFiles() {
+  bool ok = true;
+  char dir_template[] = "/tmp/chaos_games_XXXXXX";
+  const std::filesystem::path dir = mkdtemp(dir_template);
+  const std::filesystem::path cache_file = dir / "metadata.cache";
+  const std::filesystem::path main_file = dir / "game.toml";
+  const std::filesystem::path late_file = dir / "late.toml";
+  const std::filesystem::path broken_file = dir / "broken.toml";
+
+  std::ofstream(main_file) << "config_file_ver = \"1.0\"\nchaos_toml = \"main\"\n"
+                              "game = \"Cached Game\"\ninput_file = \"common.toml\"\n\n"
+                              "[[command]]\nname = \"[not a key]\"\n";
+  // A line inside a top-level array looks like a table header, so the header scan must fall back
+  std::ofstream(late_file) << "chaos_toml = \"main\"\nlayout = [\n[1, 2],\n]\n"
+                              "game = \"Late Name\"\n";
+  std::ofstream(broken_file) << "chaos_toml = \"main\"\ngame = \"Broken\n";
+
+  {
+    GameMetadataCache cache(cache_file);
+    cache.load();
+    const auto& meta = cache.lookup(main_file);
+    ok &= check(meta.role == "main" && meta.game == "Cached Game" &&
+                meta.input_file == "common.toml",
+                "the header scan should read the top-level keys");
+    ok &= check(cache.lookup(late_file).game == "Late Name",
+                "a scan stopped inside a value should fall back to a full parse");
+    ok &= check(!cache.lookup(broken_file).valid, "a file that fails to parse should be invalid");
+    ok &= check(cache.scanned() == 3, "new files should be scanned");
+    ok &= check(cache.save(), "the cache should be saved");
+  }
+  {
+    GameMetadataCache cache(cache_file);
+    cache.load();
+    ok &= check(cache.lookup(main_file).game == "Cached Game",
+                "unchanged files should come from the cache");
+    ok &= check(cache.scanned() == 0, "unchanged files should not be read again");
+    ok &= check(!cache.lookup(broken_file).valid && cache.scanned() == 1,
+                "a file that failed to parse should not be cached");
+
+    std::ofstream(late_file, std::ios::app) << "# edited\n";
+    ok &= check(cache.lookup(late_file).game == "Late Name" && cache.scanned() == 2,
+                "a file whose size changed should be scanned again");
+  }
+
+  std::filesystem::remove_all(dir);
+  return ok;
+}
+
 int main() {
   bool ok = true;
   ok &= testFirstUnpauseKeepsHybridTriggersReleased();
@@ -669,7 +1117,16 @@ int main() {
   ok &= testSelectGameReloadForcesSameGameReload();
   ok &= testResetRemovesActiveModsWhilePaused();
   ok &= testScalingInvertedAndMoonwalkAffectExpectedAxes();
+  ok &= testBatchedInjectionPassesDownstreamModsTogether();
+  ok &= testFlightRecorderCapturesModifierDecisions();
+  ok &= testParentChildrenRunInEnginePipeline();
+  ok &= testModifierCostsAreCounted();
   ok &= testSequenceBeginClipsOutOfRangeAxisValue();
+  ok &= testEngineKeepsTickingWhileSequencePlays();
+  ok &= testChildrenWaitForParentBeginSequence();
+  ok &= testCommandsApplyInOrderOnEngineThread();
+  ok &= testActiveSlotsAreReusedAfterRemoval();
+  ok &= testGameMetadataCacheSkipsUnchangedFiles();
   if (!ok) {
     return 1;
   }
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -10,6 +11,7 @@
 #include <MenuItem.hpp>
 #include <Sequence.hpp>
 #include <SequenceTable.hpp>
+#include <signals.hpp>
 
 using namespace Chaos;
 
@@ -484,6 +486,33 @@ static bool testSetStateFlushesPendingInputEvents() {
   return ok;
 }
 
+static bool testSendHoldsToAbsoluteDeadlines() {
+  bool ok = true;
+  TrackingController controller;
+  Sequence seq{controller};
+  const int steps = 25;
+  const unsigned int hold_us = 2000;
+  for (int i = 0; i < steps; ++i) {
+    seq.addEvent({hold_us, (short) (i % 2), TYPE_BUTTON, BUTTON_X});
+  }
+
+  Sequence::resetJitterStats();
+  auto start = std::chrono::steady_clock::now();
+  seq.send();
+  double elapsed_us = std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - start).count();
+
+  Json::Value stats = Sequence::getJitterStats();
+  const double nominal_us = steps * hold_us;
+  ok &= check(stats["steps"].asUInt64() == steps, "every timed step should be measured");
+  ok &= check(elapsed_us >= nominal_us, "sequence should hold each step for its full time");
+  // With absolute deadlines only the last step's lateness shows up in the total; per-step
+  // overshoot does not accumulate.
+  ok &= check(elapsed_us - nominal_us <= stats["max_late_us"].asDouble() + 1000.0,
+              "sequence playback should not drift by more than one step's lateness");
+  return ok;
+}
+
 int main() {
   bool ok = true;
   ok &= testSelectUsesCorrectedOffset();
@@ -498,6 +527,7 @@ int main() {
   ok &= testInitialHiddenAndRevealCounterUpdates();
   ok &= testConfirmSelectionSkipsReverseNavigation();
   ok &= testSetStateFlushesPendingInputEvents();
+  ok &= testSendHoldsToAbsoluteDeadlines();
 
   if (!ok) {
     return 1;
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <list>
 #include <memory>
@@ -16,10 +18,12 @@
 #include <ControllerInput.hpp>
 #include <ControllerInputTable.hpp>
 #include <CooldownModifier.hpp>
+#include <CurveModifier.hpp>
 #include <DelayModifier.hpp>
 #include <DisableModifier.hpp>
 #include <DeviceEvent.hpp>
 #include <EngineInterface.hpp>
+#include <Expression.hpp>
 #include <FormulaModifier.hpp>
 #include <GameCommand.hpp>
 #include <GameCondition.hpp>
@@ -27,13 +31,17 @@
 #include <MenuInterface.hpp>
 #include <MenuItem.hpp>
 #include <MenuModifier.hpp>
+#include <ModifierIndex.hpp>
 #include <RemapModifier.hpp>
 #include <ParentModifier.hpp>
 #include <RepeatModifier.hpp>
+#include <ResponseCurve.hpp>
 #include <ScalingModifier.hpp>
 #include <Sequence.hpp>
 #include <SequenceModifier.hpp>
 #include <signals.hpp>
+#include <clock.hpp>
+#include <random.hpp>
 
 using namespace Chaos;
 
@@ -65,7 +73,7 @@ public:
   std::unordered_map<std::string, std::shared_ptr<GameCommand>> command_map;
   std::unordered_map<std::string, std::shared_ptr<GameCondition>> condition_map;
   std::unordered_map<std::string, std::shared_ptr<Modifier>> modifier_map;
-  std::list<std::shared_ptr<Modifier>> active_mods;
+  ActiveModifiers active_mods;
 
   std::vector<DeviceEvent> pipelined_events;
   std::vector<std::string> set_off_calls;
@@ -118,10 +126,10 @@ public:
   }
 
   short getState(uint8_t id, uint8_t type) override { return controller.getState(id, type); }
-  bool eventMatches(const DeviceEvent& event, std::shared_ptr<GameCommand> command) override {
+  bool eventMatches(const DeviceEvent& event, Handle<GameCommand> command) override {
     return command && command->getInput() && command->getInput()->matches(event);
   }
-  void setOff(std::shared_ptr<GameCommand> command) override {
+  void setOff(Handle<GameCommand> command) override {
     if (command) {
       set_off_calls.push_back(command->getName());
       auto input = command->getInput();
@@ -132,7 +140,7 @@ public:
       }
     }
   }
-  void setOn(std::shared_ptr<GameCommand> command) override {
+  void setOn(Handle<GameCommand> command) override {
     if (command) {
       set_on_calls.push_back(command->getName());
       auto input = command->getInput();
@@ -143,7 +151,7 @@ public:
       }
     }
   }
-  void setValue(std::shared_ptr<GameCommand> command, short value) override {
+  void setValue(Handle<GameCommand> command, short value) override {
     if (command) {
       set_value_calls.push_back({command->getName(), value});
       auto input = command->getInput();
@@ -155,6 +163,19 @@ public:
   }
   void applyEvent(const DeviceEvent& event) override { controller.applyEvent(event); }
 
+  // Scheduled changes are made when the test calls runScheduled(), standing in for the engine's
+  // scheduler thread
+  ScheduledActionQueue scheduled;
+  void scheduleAction(const ScheduledAction& action) override { scheduled.push(action); }
+  void cancelScheduled(const Modifier* source) override { scheduled.cancel(source); }
+  void runScheduled() {
+    std::vector<ScheduledAction> due;
+    scheduled.popDue(Clock::now(), due);
+    for (const auto& action : due) {
+      applyScheduled(action);
+    }
+  }
+
   std::shared_ptr<Modifier> getModifier(const std::string& name) override {
     auto it = modifier_map.find(name);
     if (it != modifier_map.end()) {
@@ -165,7 +186,7 @@ public:
   std::unordered_map<std::string, std::shared_ptr<Modifier>>& getModifierMap() override {
     return modifier_map;
   }
-  std::list<std::shared_ptr<Modifier>>& getActiveMods() override { return active_mods; }
+  ActiveModifiers& getActiveMods() override { return active_mods; }
 
   std::shared_ptr<MenuItem> getMenuItem(const std::string& name) override {
     return menu_iface.getMenuItem(name);
@@ -426,6 +447,40 @@ static bool testGameDefaultsToNoErrorsBeforeLoad() {
   return ok;
 }
 
+static bool testGameConditionCachesUntilInputsChange() {
+  MockEngine engine;
+  auto movement = engine.condition_map["movement"];
+  auto gun = std::make_shared<GameCondition>(*engine.condition_map["gun_selected"]);
+  bool ok = true;
+
+  ok &= check(!movement->inCondition(), "movement should start false");
+  const uint64_t before = engine.controller.changeCount();
+  engine.applyEvent(commandEvent(engine, "JUMP", 1));
+  ok &= check(engine.controller.changeCount() == before + 1, "a state change should advance the change count");
+  ok &= check(!movement->inCondition(), "unrelated signal should leave movement false");
+  engine.applyEvent(commandEvent(engine, "MOVE_X", JOYSTICK_MAX));
+  ok &= check(movement->inCondition(), "changed input should recompute movement");
+  engine.applyEvent(commandEvent(engine, "MOVE_X", JOYSTICK_MAX));
+  ok &= check(engine.controller.changeCount() == before + 2, "repeating a value should not count as a change");
+  engine.applyEvent(commandEvent(engine, "MOVE_X", 0));
+  ok &= check(!movement->inCondition(), "released input should recompute movement");
+
+  // With the clear_on signal already held, setting the persistent state must not be cached: the
+  // next check clears it even though no signal has changed.
+  engine.applyEvent(commandEvent(engine, "GET_CONSUMABLE", 1));
+  engine.applyEvent(commandEvent(engine, "GET_GUN", 1));
+  ok &= check(gun->inCondition(), "persistent condition should set on its while signal");
+  ok &= check(!gun->inCondition(), "persistent condition should clear on the next check");
+  engine.applyEvent(commandEvent(engine, "GET_CONSUMABLE", 0));
+  ok &= check(gun->inCondition(), "persistent condition should set again once clear_on is released");
+  engine.applyEvent(commandEvent(engine, "GET_GUN", 0));
+  ok &= check(gun->inCondition(), "persistent condition should hold after its while signal is released");
+  ok &= check(gun->inCondition(), "persistent condition should hold while nothing changes");
+  engine.applyEvent(commandEvent(engine, "GET_CONSUMABLE", 1));
+  ok &= check(!gun->inCondition(), "persistent condition should clear on its clear_on signal");
+  return ok;
+}
+
 static bool testCooldownModifierBlocksAfterTrigger() {
   MockEngine engine;
   auto mod = makeMod<CooldownModifier>(
@@ -746,23 +801,23 @@ static bool testDelayModifierReplaysMultipleSequentialEvents() {
   MockEngine engine;
   auto mod = makeMod<DelayModifier>(
       R"(
-name = "Delay Camera X Multiple"
+name = "Delay Jump Multiple"
 type = "delay"
-applies_to = [ "CAMERA_X" ]
+applies_to = [ "JUMP" ]
 delay = 0.01
 )",
       engine);
   mod->_begin();
 
-  auto camera_x = commandInput(engine, "CAMERA_X");
+  auto jump = commandInput(engine, "JUMP");
   bool ok = true;
-  ok &= check(camera_x != nullptr, "delay-multi test input should exist");
-  if (!camera_x) {
+  ok &= check(jump != nullptr, "delay-multi test input should exist");
+  if (!jump) {
     return false;
   }
 
-  DeviceEvent first = commandEvent(engine, "CAMERA_X", 100);
-  DeviceEvent second = commandEvent(engine, "CAMERA_X", -80);
+  DeviceEvent first = commandEvent(engine, "JUMP", 1);
+  DeviceEvent second = commandEvent(engine, "JUMP", 0);
   ok &= check(!mod->tweak(first), "first delayed event should be queued and blocked");
   ok &= check(!mod->tweak(second), "second delayed event should be queued and blocked");
 
@@ -771,18 +826,71 @@ delay = 0.01
   ok &= check(engine.pipelined_events.size() == 2,
               "delay modifier should replay multiple queued events");
   if (engine.pipelined_events.size() == 2) {
-    ok &= check(engine.pipelined_events[0].id == camera_x->getID() &&
-                    engine.pipelined_events[0].type == camera_x->getButtonType() &&
-                    engine.pipelined_events[0].value == 100,
+    ok &= check(engine.pipelined_events[0].id == jump->getID() &&
+                    engine.pipelined_events[0].type == jump->getButtonType() &&
+                    engine.pipelined_events[0].value == 1,
                 "first replayed delayed event should preserve ordering");
-    ok &= check(engine.pipelined_events[1].id == camera_x->getID() &&
-                    engine.pipelined_events[1].type == camera_x->getButtonType() &&
-                    engine.pipelined_events[1].value == -80,
+    ok &= check(engine.pipelined_events[1].id == jump->getID() &&
+                    engine.pipelined_events[1].type == jump->getButtonType() &&
+                    engine.pipelined_events[1].value == 0,
                 "second replayed delayed event should preserve ordering");
   }
   return ok;
 }
 
+static bool testDelayModifierCoalescesAxesAndCapsQueue() {
+  MockEngine engine;
+  auto mod = makeMod<DelayModifier>(
+      R"(
+name = "Delay Capped"
+type = "delay"
+applies_to = [ "CAMERA_X", "JUMP" ]
+delay = 0.01
+queue_limit = 4
+)",
+      engine);
+  mod->_begin();
+
+  bool ok = true;
+  DeviceEvent first = commandEvent(engine, "CAMERA_X", 100);
+  DeviceEvent press = commandEvent(engine, "JUMP", 1);
+  DeviceEvent second = commandEvent(engine, "CAMERA_X", -80);
+  mod->tweak(first);
+  mod->tweak(press);
+  mod->tweak(second);
+
+  usleep(13000);
+  mod->_update(false);
+  ok &= check(engine.pipelined_events.size() == 2,
+              "only the latest value of an axis should replay in one update");
+  if (engine.pipelined_events.size() == 2) {
+    ok &= check(engine.pipelined_events[0].value == 1 && engine.pipelined_events[1].value == -80,
+                "coalesced replay should keep buttons and the latest axis value in order");
+  }
+  ok &= check(mod->coalescedEvents() == 1, "coalesced axis events should be counted");
+
+  // Six events into a queue of four: the two oldest go
+  engine.pipelined_events.clear();
+  for (short value = 1; value <= 6; ++value) {
+    DeviceEvent evt = commandEvent(engine, "JUMP", value % 2);
+    mod->tweak(evt);
+  }
+  ok &= check(mod->droppedEvents() == 2, "events beyond the queue limit should be counted as dropped");
+  usleep(13000);
+  mod->_update(false);
+  ok &= check(engine.pipelined_events.size() == 4, "the newest events should survive a full queue");
+
+  bool threw = false;
+  try {
+    makeMod<DelayModifier>("name = \"Bad\"\ntype = \"delay\"\napplies_to = [ \"JUMP\" ]\n"
+                           "delay = 1\nqueue_limit = 0\n", engine);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  ok &= check(threw, "a queue limit of zero should be rejected");
+  return ok;
+}
+
 static bool testDelayModifierDelaysHybridButtonAndAxis() {
   MockEngine engine;
   auto mod = makeMod<DelayModifier>(
@@ -987,20 +1095,35 @@ delay = 0.002
     }
   }
 
-  for (int poll = 0; poll < 100 && engine.pipelined_events.size() < expected.size(); ++poll) {
+  // Axis events that come due together are coalesced to the newest value per axis, so every
+  // queued event is either replayed or counted as superseded.
+  auto accounted = [&]() { return engine.pipelined_events.size() + mod->coalescedEvents(); };
+  for (int poll = 0; poll < 100 && accounted() < expected.size(); ++poll) {
     usleep(1500);
     mod->_update(false);
   }
 
-  ok &= check(engine.pipelined_events.size() == expected.size(),
-              "joystick stress should replay all delayed joystick events");
-  if (engine.pipelined_events.size() == expected.size()) {
-    for (size_t i = 0; i < expected.size(); ++i) {
-      const auto& replay = engine.pipelined_events[i];
-      const auto& original = expected[i];
-      ok &= check(replay.id == original.id && replay.type == original.type && replay.value == original.value,
-                  "joystick stress replay should preserve event identity and ordering");
+  ok &= check(accounted() == expected.size(),
+              "joystick stress should replay or coalesce every delayed joystick event");
+  // Replayed events must be an ordered subsequence of the originals
+  size_t next = 0;
+  for (const auto& replay : engine.pipelined_events) {
+    while (next < expected.size() &&
+           !(expected[next].id == replay.id && expected[next].type == replay.type &&
+             expected[next].value == replay.value)) {
+      ++next;
+    }
+    ok &= check(next < expected.size(), "joystick stress replay should preserve event identity and ordering");
+    ++next;
+  }
+  // The newest value of each axis is never dropped
+  for (size_t i = expected.size() - 4; i < expected.size(); ++i) {
+    bool found = false;
+    for (const auto& replay : engine.pipelined_events) {
+      found |= replay.id == expected[i].id && replay.type == expected[i].type &&
+               replay.value == expected[i].value;
     }
+    ok &= check(found, "joystick stress should replay the final value of each axis");
   }
   return ok;
 }
@@ -1718,6 +1841,147 @@ period_length = 1.0
   return ok;
 }
 
+// The double-precision formulas the table-driven waveforms replaced
+static int referenceFormulaOffset(const std::string& type, double amplitude, double t, int i) {
+  if (type == "circle") {
+    return (i % 2 == 0) ? static_cast<int>(amplitude * std::sin(t))
+                        : static_cast<int>(amplitude * std::cos(t));
+  }
+  if (type == "eight_curve") {
+    return static_cast<int>(amplitude * std::sin(4.0*(i+1)*(t+1.6)));
+  }
+  return static_cast<int>(amplitude * (std::cos(t+4.0*i) + std::cos(2.0*t)/2.0) *
+                          std::sin((t+4.0*i)/5.0)/2.0);
+}
+
+static bool testFormulaWaveformsMatchReferenceFormulas() {
+  bool ok = true;
+  for (const std::string type : {"circle", "eight_curve", "janky"}) {
+    MockEngine engine;
+    auto mod = makeMod<FormulaModifier>(
+        "name = \"Formula Accuracy\"\n"
+        "type = \"formula\"\n"
+        "applies_to = [ \"CAMERA_X\", \"CAMERA_Y\", \"MOVE_X\", \"MOVE_Y\" ]\n"
+        "formula_type = \"" + type + "\"\n"
+        "amplitude = 1.0\n"
+        "period_length = 1.7\n",
+        engine);
+    const char* names[] = {"CAMERA_X", "CAMERA_Y", "MOVE_X", "MOVE_Y"};
+    for (const char* name : names) {
+      engine.applyEvent(commandEvent(engine, name, 0));
+    }
+
+    // Step at an irregular interval through several of the janky pattern's 5-period cycles
+    int worst = 0;
+    mod->_begin(0);
+    for (int64_t now = 0; now < 60000000000LL; now += 7919777) {
+      engine.pipelined_events.clear();
+      mod->_update(false, now);
+      const double t = now * 1e-9 * 2.0 * M_PI / 1.7;
+      for (int i = 0; i < 4; ++i) {
+        const int expected = referenceFormulaOffset(type, JOYSTICK_MAX, t, i);
+        worst = std::max(worst, std::abs(engine.pipelined_events[i].value - expected));
+      }
+    }
+    ok &= check(worst <= 1, type + " waveform should stay within 1 of the double-precision formula");
+  }
+  return ok;
+}
+
+static bool testFormulaExpressionsCompileAndFold() {
+  bool ok = true;
+  Expression::Resolver resolve = [](const std::string& name) { return name == "x" ? 0 : -1; };
+
+  Expression folded("2 * (3 + 4) - clamp(10, 0, 5) / 5", resolve);
+  ok &= check(folded.isConstant() && folded.evaluate(nullptr) == 13.0,
+              "constant subexpressions should fold to a single value");
+
+  Expression mixed("x * (1 + 1) + max(-x, 2 * pi / pi)", resolve);
+  const double x = 3.0;
+  ok &= check(mixed.size() == 8 && mixed.evaluate(&x) == 8.0,
+              "expression should evaluate with folded constants around variables");
+
+  for (const char* bad : {"sin(x", "x +", "y * 2", "tan(x)", "min(x)", "x $ 2"}) {
+    bool threw = false;
+    try {
+      Expression broken(bad, resolve);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    ok &= check(threw, std::string("malformed formula should be rejected: ") + bad);
+  }
+
+  const std::string nested = std::string(100000, '(') + "x" + std::string(100000, ')');
+  std::string chain = "x";
+  for (int i = 0; i < 100000; ++i) {
+    chain += " + x";
+  }
+  for (const std::string& deep : {nested, chain}) {
+    bool threw = false;
+    try {
+      Expression broken(deep, resolve);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    ok &= check(threw, "formulas nested past the limit should be rejected");
+  }
+
+  ok &= check(Expression::noise(std::nan("")) == 0.0 && Expression::noise(HUGE_VAL) == 0.0 &&
+              Expression::noise(-HUGE_VAL) == 0.0,
+              "noise of a non-finite value should be zero");
+  const double far = Expression::noise(1e30);
+  ok &= check(far >= -1.0 && far <= 1.0, "noise of a huge value should stay in range");
+  return ok;
+}
+
+static bool testFormulaExpressionDrivesAxes() {
+  MockEngine engine;
+  auto mod = makeMod<FormulaModifier>(
+      R"toml(
+name = "Formula Expression"
+type = "formula"
+applies_to = [ "CAMERA_X", "CAMERA_Y" ]
+formula = [ "sin(t)", "cos(t) * 0.5 + LX" ]
+amplitude = 1.0
+period_length = 2.0
+)toml",
+      engine);
+
+  bool ok = true;
+  engine.applyEvent(commandEvent(engine, "CAMERA_X", -20));
+  engine.applyEvent(commandEvent(engine, "CAMERA_Y", 0));
+  engine.applyEvent(DeviceEvent{0, 0, TYPE_AXIS, AXIS_LX});
+  mod->_begin(0);
+  // A quarter period in: sin(t) = 1, cos(t) = 0
+  mod->_update(false, 500000000);
+  ok &= check(engine.pipelined_events.size() == 2, "expression formula should emit each axis");
+  if (engine.pipelined_events.size() == 2) {
+    ok &= check(engine.pipelined_events[0].value == -20 + JOYSTICK_MAX,
+                "first axis should follow its own expression");
+    ok &= check(engine.pipelined_events[1].value == 0, "second axis should follow its own expression");
+  }
+
+  // Push LX halfway: the second axis adds half the axis range
+  engine.applyEvent(DeviceEvent{0, 64, TYPE_AXIS, AXIS_LX});
+  engine.pipelined_events.clear();
+  mod->_update(false, 500000000);
+  ok &= check(engine.pipelined_events.size() == 2 &&
+                  engine.pipelined_events[1].value == 64,
+              "expression should read the current state of a named signal");
+
+  bool threw = false;
+  try {
+    makeMod<FormulaModifier>(
+        "name = \"Both\"\ntype = \"formula\"\napplies_to = [ \"CAMERA_X\" ]\n"
+        "formula = \"t\"\nformula_type = \"circle\"\n",
+        engine);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  ok &= check(threw, "formula and formula_type together should be rejected");
+  return ok;
+}
+
 static bool testFormulaCircleAssignsSinThenCosByAxisOrder() {
   MockEngine engine;
   auto mod = makeMod<FormulaModifier>(
@@ -2289,6 +2553,115 @@ while_amplitude = 0.5
   return ok;
 }
 
+static bool testScalingCurveMatchesLinearFormula() {
+  bool ok = true;
+  const double cases[][2] = {{1.0, 0.0}, {-1.0, 0.0}, {2.0, 100.0}, {0.5, -30.0}, {-0.37, 12.5}};
+  for (const auto& c : cases) {
+    ResponseCurve curve = ResponseCurve::linear(c[0], c[1]);
+    for (int x = JOYSTICK_MIN; x <= JOYSTICK_MAX; ++x) {
+      const short expected = fmin(fmax((int)(c[0] * x + c[1]), JOYSTICK_MIN), JOYSTICK_MAX);
+      if (curve.apply(x) != expected) {
+        ok &= check(false, "linear curve should match the scaling formula at " + std::to_string(x));
+        break;
+      }
+    }
+  }
+  ok &= check(!ResponseCurve::covers(JOYSTICK_MAX + 1) && !ResponseCurve::covers(JOYSTICK_MIN - 1),
+              "the table should only cover 8-bit values");
+  return ok;
+}
+
+static bool testCurveModifierAppliesControlPoints() {
+  MockEngine engine;
+  auto mod = makeMod<CurveModifier>(
+      R"(
+name = "Soft Center"
+type = "curve"
+applies_to = [ "CAMERA_X" ]
+points = [ [-128, -128], [-32, 0], [32, 0], [127, 127] ]
+)",
+      engine);
+
+  bool ok = true;
+  const std::pair<short, short> expected[] = {
+      {-128, -128}, {-80, -64}, {-32, 0}, {0, 0}, {20, 0}, {32, 0}, {64, 43}, {127, 127}};
+  for (const auto& [in, out] : expected) {
+    DeviceEvent event = commandEvent(engine, "CAMERA_X", in);
+    ok &= check(mod->tweak(event), "curve tweak should accept matching event");
+    ok &= check(event.value == out, "curve should interpolate between points at " +
+                std::to_string(in) + " (got " + std::to_string(event.value) + ")");
+  }
+
+  DeviceEvent other = commandEvent(engine, "CAMERA_Y", 20);
+  ok &= check(mod->tweak(other) && other.value == 20, "curve should leave other commands alone");
+
+  bool rejected = false;
+  try {
+    makeMod<CurveModifier>(
+        R"(
+name = "Backwards"
+type = "curve"
+applies_to = [ "CAMERA_X" ]
+points = [ [10, 0], [-10, 0] ]
+)",
+        engine);
+  } catch (const std::runtime_error&) {
+    rejected = true;
+  }
+  ok &= check(rejected, "points out of order should be rejected");
+  return ok;
+}
+
+static bool testCurveModifierNamedCurves() {
+  MockEngine engine;
+  bool ok = true;
+
+  auto deadzone = makeMod<CurveModifier>(
+      R"(
+name = "Sticky Stick"
+type = "curve"
+applies_to = [ "CAMERA_X" ]
+curve = "deadzone"
+deadzone = 0.5
+)",
+      engine);
+  DeviceEvent small = commandEvent(engine, "CAMERA_X", -60);
+  deadzone->tweak(small);
+  ok &= check(small.value == 0, "deflection inside the dead zone should read as centred");
+  DeviceEvent full = commandEvent(engine, "CAMERA_X", JOYSTICK_MAX);
+  deadzone->tweak(full);
+  ok &= check(full.value == JOYSTICK_MAX, "full deflection should survive the dead zone");
+
+  auto squared = makeMod<CurveModifier>(
+      R"(
+name = "Squared"
+type = "curve"
+applies_to = [ "CAMERA_X" ]
+curve = "exponential"
+exponent = 2
+)",
+      engine);
+  DeviceEvent half = commandEvent(engine, "CAMERA_X", -64);
+  squared->tweak(half);
+  ok &= check(half.value == -32, "exponential curve should square half deflection (got " +
+              std::to_string(half.value) + ")");
+
+  auto stepped = makeMod<CurveModifier>(
+      R"(
+name = "Stepped"
+type = "curve"
+applies_to = [ "CAMERA_X" ]
+curve = "steps"
+steps = 2
+)",
+      engine);
+  DeviceEvent step = commandEvent(engine, "CAMERA_X", 40);
+  stepped->tweak(step);
+  ok &= check(step.value == 64, "stepped curve should round to the nearest level (got " +
+              std::to_string(step.value) + ")");
+  return ok;
+}
+
 static bool testRepeatModifierForcesAndBlocksWhileOn() {
   MockEngine engine;
   auto mod = makeMod<RepeatModifier>(
@@ -2296,7 +2669,7 @@ static bool testRepeatModifierForcesAndBlocksWhileOn() {
 name = "Repeat Fire"
 type = "repeat"
 applies_to = [ "FIRE" ]
-time_on = 0.001
+time_on = 0.02
 time_off = 0.001
 repeat = 1
 cycle_delay = 0.01
@@ -2316,6 +2689,7 @@ block_while_busy = [ "MOVE_X" ]
 
   usleep(2500);
   mod->_update(false);
+  engine.runScheduled();
   ok &= check(!engine.set_value_calls.empty(), "repeat should force command value on first ON phase");
   if (!engine.set_value_calls.empty()) {
     const auto& call = engine.set_value_calls.back();
@@ -2330,8 +2704,9 @@ block_while_busy = [ "MOVE_X" ]
   DeviceEvent blocked_evt = commandEvent(engine, "MOVE_X", 500);
   ok &= check(!mod->tweak(blocked_evt), "repeat should block configured block_while command while on");
 
-  usleep(2500);
+  usleep(25000);
   mod->_update(false);
+  engine.runScheduled();
   ok &= check(sawName(engine.set_off_calls, "FIRE"),
               "repeat should turn FIRE off after time_on elapses");
   return ok;
@@ -2354,21 +2729,27 @@ cycle_delay = 0.003
 
   bool ok = true;
   usleep(1500);
-  mod->_update(false); // ON
+  mod->_update(false);
+  engine.runScheduled(); // ON
   usleep(1500);
-  mod->_update(false); // OFF (repeat_count 1)
+  mod->_update(false);
+  engine.runScheduled(); // OFF (repeat_count 1)
   usleep(1500);
-  mod->_update(false); // ON
+  mod->_update(false);
+  engine.runScheduled(); // ON
   usleep(1500);
-  mod->_update(false); // OFF (repeat_count 2)
+  mod->_update(false);
+  engine.runScheduled(); // OFF (repeat_count 2)
 
   size_t on_before_reset = engine.set_on_calls.size();
   ok &= check(on_before_reset >= 2, "repeat should turn command on during each cycle");
 
   usleep(4000);
-  mod->_update(false); // reset repeat_count after cycle_delay
+  mod->_update(false);
+  engine.runScheduled(); // reset repeat_count after cycle_delay
   usleep(1500);
-  mod->_update(false); // ON again after reset
+  mod->_update(false);
+  engine.runScheduled(); // ON again after reset
   ok &= check(engine.set_on_calls.size() > on_before_reset,
               "repeat should restart ON/OFF cycling after cycle_delay reset");
   return ok;
@@ -2391,7 +2772,8 @@ block_while_busy = [ "MOVE_X" ]
 
   bool ok = true;
   usleep(2500);
-  mod->_update(false); // ON
+  mod->_update(false);
+  engine.runScheduled(); // ON
   ok &= check(engine.set_value_calls.size() >= 2,
               "repeat should apply force_on values for each configured command");
 
@@ -2416,7 +2798,7 @@ static bool testRepeatModifierClipsOutOfRangeAxisForceValues() {
 name = "Repeat Axis Clip"
 type = "repeat"
 applies_to = [ "MOVE_X" ]
-time_on = 0.001
+time_on = 0.02
 time_off = 0.001
 force_on = [ 128 ]
 force_off = [ -999 ]
@@ -2426,7 +2808,8 @@ force_off = [ -999 ]
 
   bool ok = true;
   usleep(2500);
-  mod->_update(false); // ON
+  mod->_update(false);
+  engine.runScheduled(); // ON
   ok &= check(!engine.set_value_calls.empty(),
               "repeat axis clip should set configured force_on value");
   if (!engine.set_value_calls.empty()) {
@@ -2440,8 +2823,9 @@ force_off = [ -999 ]
   ok &= check(forced.value == JOYSTICK_MAX,
               "repeat tweak should enforce clipped force_on axis value");
 
-  usleep(2500);
-  mod->_update(false); // OFF
+  usleep(25000);
+  mod->_update(false);
+  engine.runScheduled(); // OFF
   ok &= check(engine.set_value_calls.size() >= 2,
               "repeat axis clip should set configured force_off value");
   if (engine.set_value_calls.size() >= 2) {
@@ -2452,6 +2836,55 @@ force_off = [ -999 ]
   return ok;
 }
 
+static bool testRepeatModifierSchedulesPressesAtExactTimes() {
+  MockEngine engine;
+  auto mod = makeMod<RepeatModifier>(
+      R"(
+name = "Repeat Rapid Fire"
+type = "repeat"
+applies_to = [ "FIRE" ]
+time_on = 0.02
+time_off = 0.03
+repeat = 2
+cycle_delay = 0.1
+)",
+      engine);
+  const int64_t ms = 1000000;
+  bool ok = true;
+  Clock::useVirtual(0);
+  mod->_begin();
+  // A tick that lands between edges should not move them
+  Clock::advanceTo(7 * ms);
+  mod->_update(false);
+
+  std::vector<ScheduledAction> due;
+  engine.scheduled.popDue(200 * ms, due);
+  const int64_t expected[] = {30 * ms, 50 * ms, 80 * ms, 100 * ms};
+  ok &= check(due.size() == 4, "repeat should schedule each press and release of the cycle");
+  for (size_t i = 0; i < due.size() && i < 4; ++i) {
+    ok &= check(due[i].when == expected[i], "repeat edges should fall at exact offsets from the start");
+    ok &= check(due[i].kind == ((i % 2 == 0) ? ScheduledAction::Kind::ON : ScheduledAction::Kind::OFF),
+                "repeat edges should alternate between on and off");
+  }
+  ok &= check(engine.scheduled.nextDeadline() == 230 * ms,
+              "repeat should keep the next cycle queued ahead of time");
+
+  // A 500 ms pause moves the rest of the timeline back by its length
+  Clock::advanceTo(60 * ms);
+  mod->_update(false);
+  Clock::advanceTo(560 * ms);
+  mod->_update(true);
+  due.clear();
+  engine.scheduled.popDue(600 * ms, due);
+  ok &= check(due.size() == 2 && due[0].when == 580 * ms && due[1].when == 600 * ms,
+              "repeat should reschedule the remaining presses after a pause");
+
+  mod->_finish();
+  ok &= check(engine.scheduled.empty(), "finishing a repeat should cancel its scheduled changes");
+  Clock::useSystem();
+  return ok;
+}
+
 static bool testSequenceModifierTriggersAndBlocksDuringSequence() {
   MockEngine engine;
   auto mod = makeMod<SequenceModifier>(
@@ -2577,6 +3010,49 @@ static bool testSequenceParallelHandlesDelayBetweenEvents() {
   return ok;
 }
 
+static bool testSequenceTimelineSharesIncludedSequences() {
+  MockEngine engine;
+  auto listen = commandInput(engine, "LISTEN");
+  bool ok = true;
+  ok &= check(listen != nullptr, "sequence-sharing test input should exist");
+  if (!listen) {
+    return false;
+  }
+
+  auto inner = std::make_shared<Sequence>(engine.controller);
+  inner->addHold(listen, 1, 2000);
+  inner->addRelease(listen, 1000);
+  Sequence outer(engine.controller);
+  outer.addDelay(1000);
+  outer.addSequence(inner);
+  outer.addSequence(inner);
+
+  auto timeline = outer.getTimeline();
+  const auto& segments = timeline->getSegments();
+  ok &= check(segments.size() == 3 && timeline->size() == 5 && timeline->duration() == 7000,
+              "included sequences should each add one segment");
+  if (segments.size() == 3) {
+    ok &= check(segments[1].block == segments[2].block &&
+                    segments[1].block == inner->getTimeline()->getSegments()[0].block,
+                "included sequences should share their events instead of copying them");
+    ok &= check(segments[1].start == 1000 && segments[2].start == 4000,
+                "segments should start at absolute times");
+  }
+  auto due = timeline->firstPending(4500);
+  ok &= check(due.segment == 2 && due.event == 1,
+              "the first pending event should be found from the elapsed time");
+
+  inner->addDelay(5000);
+  ok &= check(outer.getTimeline()->size() == 5,
+              "changing an included sequence should not change the sequences that include it");
+
+  ok &= check(!outer.sendParallel(0.0045), "parallel send should wait for the remaining events");
+  ok &= check(engine.controller.getState(listen->getID(), listen->getButtonType()) == 1,
+              "parallel send should jump straight to the events that are due");
+  ok &= check(outer.sendParallel(0.007), "parallel send should finish at the end of the timeline");
+  return ok;
+}
+
 static bool testSequenceModifierRetriggersImmediatelyWhenCycleDelayZero() {
   MockEngine engine;
   auto mod = makeMod<SequenceModifier>(
@@ -2860,6 +3336,36 @@ static bool testAllDifferingModifierPairOrdersStayStableWhenIdle() {
   return ok;
 }
 
+static bool testParentModifierChildrenShareTickTime() {
+  ProbeChildModifier::reset();
+  MockEngine engine;
+
+  auto child = makeMod<ProbeChildModifier>(
+      R"(
+name = "child1"
+type = "probe_child"
+delta = 1
+)",
+      engine);
+  engine.modifier_map["child1"] = child;
+
+  auto parent = makeMod<ParentModifier>(
+      R"(
+name = "parent"
+type = "parent"
+children = [ "child1" ]
+)",
+      engine);
+
+  // Timestamps are handed in, so lifetimes are exact no matter how long the calls take
+  bool ok = true;
+  parent->_begin(1000000000);
+  parent->_update(false, 2500000000);
+  ok &= check(parent->lifetime() == 1.5, "parent lifetime should come from the supplied time");
+  ok &= check(child->lifetime() == 1.5, "child should run on the parent's tick time");
+  return ok;
+}
+
 static bool testParentModifierForwardsLifecycleAndTweak() {
   ProbeChildModifier::reset();
   MockEngine engine;
@@ -3196,9 +3702,92 @@ select_groups = [ "parent" ]
   return ok;
 }
 
+static bool testModifierIndexTracksGroupsAndTypes() {
+  MockEngine engine;
+  auto probe = makeMod<ProbeChildModifier>(
+      R"(
+name = "index_probe"
+type = "probe_child"
+groups = [ "movement" ]
+)",
+      engine);
+  engine.modifier_map["index_probe"] = probe;
+  auto fixed_parent = makeMod<ParentModifier>(
+      R"(
+name = "index_fixed_parent"
+type = "parent"
+children = [ "index_probe" ]
+)",
+      engine);
+  auto random_parent = makeMod<ParentModifier>(
+      R"(
+name = "index_random_parent"
+type = "parent"
+random = true
+value = 1
+)",
+      engine);
+  probe->setTableIndex(0);
+  fixed_parent->setTableIndex(1);
+  random_parent->setTableIndex(2);
+  engine.modifier_map["index_fixed_parent"] = fixed_parent;
+  engine.modifier_map["index_random_parent"] = random_parent;
+
+  ModifierIndex index;
+  index.build(engine.modifier_map);
+  bool ok = true;
+  ok &= check(index.size() == 3 && index.all().count() == 3, "index should hold every modifier");
+  ok &= check(index.id(probe.get()) == 0 && index.id(random_parent.get()) == 2,
+              "index ids should follow table order");
+  ok &= check(index.inGroup("movement").test(0) && index.inGroup("probe_child").test(0) &&
+              index.inGroup("movement").count() == 1,
+              "configured groups and the default type group should be indexed");
+  ok &= check(index.ofType("parent").count() == 2 && !index.ofType("parent").test(0),
+              "type index should hold both parents");
+  ok &= check(index.notChildren().count() == 1 && index.notChildren().test(2),
+              "only the random parent should be excluded as a child");
+  ok &= check(index.inGroup("unknown").none(), "unknown groups should be empty");
+
+  DynamicBitset picks = index.all();
+  picks -= index.ofType("parent");
+  ok &= check(picks.count() == 1 && picks.nth(0) == 0 && picks.nth(1) == picks.size(),
+              "set difference and n-th bit lookup should agree");
+  return ok;
+}
+
+static bool testRandomSeedRepeatsDraws() {
+  bool ok = true;
+  Random rng;
+  Random::seed(42);
+  std::vector<uint64_t> first;
+  for (int i = 0; i < 8; ++i) {
+    first.push_back(rng.next());
+  }
+  Random::seed(42);
+  for (int i = 0; i < 8; ++i) {
+    ok &= check(rng.next() == first[i], "the same seed should repeat the same draws");
+  }
+
+  std::vector<int> counts(3, 0);
+  for (int i = 0; i < 3000; ++i) {
+    uint64_t n = rng.below(3);
+    ok &= check(n < 3, "below(n) should stay under n");
+    ++counts[n < 3 ? n : 0];
+    int64_t b = rng.between(-2, 2);
+    ok &= check(b >= -2 && b <= 2, "between(min, max) should include both ends only");
+  }
+  for (int c : counts) {
+    ok &= check(c > 800 && c < 1200, "below(n) should draw each value about equally often");
+  }
+  ok &= check(rng.below(0) == 0 && rng.between(5, 5) == 5, "empty ranges should return their bound");
+  Random::seedRandomly();
+  return ok;
+}
+
 int main() {
   bool ok = true;
   ok &= testGameDefaultsToNoErrorsBeforeLoad();
+  ok &= testGameConditionCachesUntilInputsChange();
   ok &= testCooldownModifierBlocksAfterTrigger();
   ok &= testCooldownModifierRequiresWhileConditionWhenCumulativeStartType();
   ok &= testCooldownModifierCancelableResetsIfConditionDrops();
@@ -3207,6 +3796,7 @@ int main() {
   ok &= testDelayModifierQueuesAndReplays();
   ok &= testDelayModifierAppliesToAllCommands();
   ok &= testDelayModifierReplaysMultipleSequentialEvents();
+  ok &= testDelayModifierCoalescesAxesAndCapsQueue();
   ok &= testDelayModifierDelaysHybridButtonAndAxis();
   ok &= testDelayModifierClearsQueueAcrossLifecycle();
   ok &= testDelayModifierClearPendingInjectedEvents();
@@ -3230,6 +3820,9 @@ int main() {
   ok &= testFormulaModifierRestoresOnWhileConditionClear();
   ok &= testFormulaModifierSupportsEightCurveType();
   ok &= testFormulaCircleAssignsSinThenCosByAxisOrder();
+  ok &= testFormulaWaveformsMatchReferenceFormulas();
+  ok &= testFormulaExpressionsCompileAndFold();
+  ok &= testFormulaExpressionDrivesAxes();
   ok &= testFormulaEightCurveAlternatesAcrossAxisPairs();
   ok &= testFormulaRandomOffsetAppliesConstantRangeWithoutDirection();
   ok &= testFormulaRandomOffsetDirectionDecomposesPairs();
@@ -3241,26 +3834,34 @@ int main() {
   ok &= testScalingModifierInvertsVerticalCameraAxis();
   ok &= testScalingModifierUsesWhileAmplitudeWhenConditionTrue();
   ok &= testScalingModifierIgnoresWhileAmplitudeWithoutWhileCondition();
+  ok &= testScalingCurveMatchesLinearFormula();
+  ok &= testCurveModifierAppliesControlPoints();
+  ok &= testCurveModifierNamedCurves();
   ok &= testRepeatModifierForcesAndBlocksWhileOn();
   ok &= testRepeatModifierDefaultCycleAndRepeatReset();
   ok &= testRepeatModifierSupportsMultipleForceOnValues();
   ok &= testRepeatModifierClipsOutOfRangeAxisForceValues();
+  ok &= testRepeatModifierSchedulesPressesAtExactTimes();
   ok &= testSequenceModifierTriggersAndBlocksDuringSequence();
   ok &= testSequenceModifierLockAllBlocksAllSignals();
   ok &= testSequenceModifierAutoStartsWithoutTrigger();
   ok &= testSequenceParallelHandlesDelayBetweenEvents();
+  ok &= testSequenceTimelineSharesIncludedSequences();
   ok &= testSequenceModifierRetriggersImmediatelyWhenCycleDelayZero();
   ok &= testMenuModifierAppliesAndRestoresMenuState();
   ok &= testMenuModifierSupportsDefaultAndMultipleEntries();
   ok &= testMenuModifiersDoNotBlockLaterDisableModifier();
   ok &= testAllDifferingModifierPairOrdersStayStableWhenIdle();
   ok &= testParentModifierForwardsLifecycleAndTweak();
+  ok &= testParentModifierChildrenShareTickTime();
   ok &= testParentModifierForwardsRemapIntoLaterChildTweaks();
   ok &= testParentModifierRandomSelectionChoosesRequestedCount();
   ok &= testParentModifierRandomSelectFromRestrictsPool();
   ok &= testParentModifierRandomSelectFromRejectsParentEntries();
   ok &= testParentModifierRandomSelectGroupsRestrictsPool();
   ok &= testParentModifierRandomSelectGroupsExcludesParents();
+  ok &= testModifierIndexTracksGroupsAndTypes();
+  ok &= testRandomSeedRepeatsDraws();
 
   if (!ok) {
     return 1;
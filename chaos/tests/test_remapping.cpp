@@ -28,7 +28,7 @@ public:
   std::vector<DeviceEvent> applied_events;
   std::vector<DeviceEvent> pipelined_events;
   std::unordered_map<std::string, std::shared_ptr<Modifier>> modifier_map;
-  std::list<std::shared_ptr<Modifier>> active_mods;
+  ActiveModifiers active_mods;
 
   MockEngine() : signal_table(controller) {}
 
@@ -40,17 +40,19 @@ public:
   }
 
   short getState(uint8_t id, uint8_t type) override { return controller.getState(id, type); }
-  bool eventMatches(const DeviceEvent& event, std::shared_ptr<GameCommand> command) override {
+  bool eventMatches(const DeviceEvent& event, Handle<GameCommand> command) override {
     (void) event;
     (void) command;
     return false;
   }
-  void setOff(std::shared_ptr<GameCommand> command) override { (void) command; }
-  void setOn(std::shared_ptr<GameCommand> command) override { (void) command; }
-  void setValue(std::shared_ptr<GameCommand> command, short value) override {
+  void setOff(Handle<GameCommand> command) override { (void) command; }
+  void setOn(Handle<GameCommand> command) override { (void) command; }
+  void setValue(Handle<GameCommand> command, short value) override {
     (void) command;
     (void) value;
   }
+  void scheduleAction(const ScheduledAction& action) override { (void) action; }
+  void cancelScheduled(const Modifier* source) override { (void) source; }
   void applyEvent(const DeviceEvent& event) override {
     applied_events.push_back(event);
     controller.applyEvent(event);
@@ -66,7 +68,7 @@ public:
   std::unordered_map<std::string, std::shared_ptr<Modifier>>& getModifierMap() override {
     return modifier_map;
   }
-  std::list<std::shared_ptr<Modifier>>& getActiveMods() override { return active_mods; }
+  ActiveModifiers& getActiveMods() override { return active_mods; }
 
   std::shared_ptr<MenuItem> getMenuItem(const std::string& name) override {
     (void) name;
@@ -693,6 +695,56 @@ random_remap = [ "X", "SQUARE", "CIRCLE", "TRIANGLE" ]
   return ok;
 }
 
+static bool testCompiledRoutesLeaveOtherSignalsUntouched() {
+  MockEngine engine;
+  auto mod = makeRemap(
+      R"(
+name = "Route Table Test"
+type = "remap"
+remap = [
+  { from = "R2", to = "L2" },
+  { from = "X", to = "NOTHING" }
+]
+)",
+      engine);
+
+  auto r2 = engine.getInput("R2");
+  auto l2 = engine.getInput("L2");
+  auto square = engine.getInput("SQUARE");
+  auto lx = engine.getInput("LX");
+
+  bool ok = true;
+  ok &= check(r2 && l2 && square && lx, "route table inputs should exist");
+  if (!(r2 && l2 && square && lx)) {
+    return false;
+  }
+
+  DeviceEvent square_press = {0, 1, square->getButtonType(), square->getID()};
+  ok &= check(mod->remap(square_press), "unmapped button should be accepted");
+  ok &= check(square_press.type == square->getButtonType() && square_press.id == square->getID() &&
+                  square_press.value == 1,
+              "unmapped button should pass through unchanged");
+
+  DeviceEvent lx_move = {0, -42, lx->getButtonType(), lx->getID()};
+  ok &= check(mod->remap(lx_move), "unmapped axis should be accepted");
+  ok &= check(lx_move.type == TYPE_AXIS && lx_move.id == lx->getID() && lx_move.value == -42,
+              "unmapped axis should pass through unchanged");
+
+  // Both channels of a hybrid source must resolve to the same route
+  DeviceEvent r2_button = {0, 1, TYPE_BUTTON, r2->getID()};
+  DeviceEvent r2_axis = {0, 90, TYPE_AXIS, r2->getHybridAxis()};
+  ok &= check(mod->remap(r2_button) && mod->remap(r2_axis), "R2 events should be accepted");
+  ok &= check(r2_button.type == TYPE_BUTTON && r2_button.id == l2->getID(),
+              "R2 button channel should route to L2 button");
+  ok &= check(r2_axis.type == TYPE_AXIS && r2_axis.id == l2->getHybridAxis() && r2_axis.value == 90,
+              "R2 axis channel should route to L2 axis");
+
+  DeviceEvent out_of_range = {0, 1, 7, 3};
+  ok &= check(mod->remap(out_of_range), "events outside the route table should be accepted");
+  ok &= check(engine.applied_events.empty(), "route table lookups should not inject events");
+  return ok;
+}
+
 static bool testTouchpadInactiveDelayInjection() {
   ControllerStateProbe probe;
   ControllerState::setTouchpadInactiveDelay(0.001);
@@ -792,6 +844,7 @@ int main() {
   ok &= testDualshockTouchpadReleaseWhenTouchCountDropsToZero();
   ok &= testRemapBeginResetsTouchpadState();
   ok &= testRandomRemapProducesPermutation();
+  ok &= testCompiledRoutesLeaveOtherSignalsUntouched();
   ok &= testTouchpadInactiveDelayInjection();
   ok &= testTouchpadInactiveDelayParsing();
   ok &= testControllerInputTypeAndHybridAxisState();
@@ -69,7 +69,7 @@ public:
     return controller.getState(id, type);
   }
 
-  bool eventMatches(const Chaos::DeviceEvent& event, std::shared_ptr<Chaos::GameCommand> command) override {
+  bool eventMatches(const Chaos::DeviceEvent& event, Chaos::Handle<Chaos::GameCommand> command) override {
     if (!command) {
       return false;
     }
@@ -77,7 +77,7 @@ public:
     return signal ? signal->matches(event) : false;
   }
 
-  void setOff(std::shared_ptr<Chaos::GameCommand> command) override {
+  void setOff(Chaos::Handle<Chaos::GameCommand> command) override {
     if (!command) {
       return;
     }
@@ -87,7 +87,7 @@ public:
     }
   }
 
-  void setOn(std::shared_ptr<Chaos::GameCommand> command) override {
+  void setOn(Chaos::Handle<Chaos::GameCommand> command) override {
     if (!command) {
       return;
     }
@@ -97,7 +97,12 @@ public:
     }
   }
 
-  void setValue(std::shared_ptr<Chaos::GameCommand> command, short value) override {
+  // Nothing runs here, so scheduled changes are never due
+  void scheduleAction(const Chaos::ScheduledAction&) override {}
+
+  void cancelScheduled(const Chaos::Modifier*) override {}
+
+  void setValue(Chaos::Handle<Chaos::GameCommand> command, short value) override {
     if (!command) {
       return;
     }
@@ -119,7 +124,9 @@ public:
     return game.getModifierMap();
   }
 
-  std::list<std::shared_ptr<Chaos::Modifier>>& getActiveMods() override {
+  const Chaos::ModifierIndex* getModifierIndex() override { return &game.getModifierIndex(); }
+
+  Chaos::ActiveModifiers& getActiveMods() override {
     return active_mods;
   }
 
@@ -175,7 +182,7 @@ public:
 private:
   Chaos::Controller controller;
   Chaos::Game game;
-  std::list<std::shared_ptr<Chaos::Modifier>> active_mods;
+  Chaos::ActiveModifiers active_mods;
 };
 
 void printUsage(const char* program) {
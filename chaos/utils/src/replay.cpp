@@ -0,0 +1,326 @@
+/*
+ * Twitch Controls Chaos (TCC)
+ * Copyright 2021-2026 The Twitch Controls Chaos developers. See the AUTHORS
+ * file in the top-level directory of this distribution for a list of the
+ * contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Headless replay of a Chaos session.
+ *
+ * The engine runs on a virtual clock and is ticked from this program's single thread, so a long
+ * session replays as fast as the engine can process it and produces the same output every time.
+ * Input comes from a trace file of timed controller events and interface commands, or from the
+ * INPUT records of a flight recorder dump. Every change to the state sent to the console is
+ * written out, one line per change, so that two runs can be compared with diff.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <plog/Log.h>
+#include <plog/Formatters/TxtFormatter.h>
+#include <plog/Initializers/ConsoleInitializer.h>
+
+#include <clock.hpp>
+#include <random.hpp>
+#include "ChaosEngine.hpp"
+#include "Controller.hpp"
+#include "ControllerInputTable.hpp"
+#include "DeviceEvent.hpp"
+#include "FlightRecorder.hpp"
+#include "signals.hpp"
+
+namespace {
+
+struct Options {
+  std::filesystem::path game_config_path;
+  std::optional<std::filesystem::path> trace_path;
+  std::optional<std::filesystem::path> recording_path;
+  std::optional<std::filesystem::path> output_path;
+  plog::Severity verbosity = plog::warning;
+  int64_t tick_ns = 500000;
+  double tail_sec = 0.0;
+  uint64_t seed = 1;
+};
+
+// One timed entry from the trace: either a controller event or an interface command
+struct TraceEntry {
+  int64_t time;
+  bool is_command;
+  Chaos::DeviceEvent event;
+  std::string command;
+};
+
+// Controller that reports every change to the state sent to the console
+class ReplayController : public Chaos::Controller {
+public:
+  explicit ReplayController(std::ostream& o) : out{o} {}
+
+  void inject(const Chaos::DeviceEvent& event) { handleNewDeviceEvent(event); }
+
+  void applyEvent(const Chaos::DeviceEvent& event) override {
+    const short before = getState(event.id, event.type);
+    Chaos::Controller::applyEvent(event);
+    report(event, before);
+  }
+
+  void applyEvents(const std::vector<Chaos::DeviceEvent>& events) override {
+    for (const auto& event : events) {
+      const short before = getState(event.id, event.type);
+      Chaos::Controller::applyEvent(event);
+      report(event, before);
+    }
+  }
+
+private:
+  void report(const Chaos::DeviceEvent& event, short before) {
+    if (event.isDelay() || getState(event.id, event.type) == before) {
+      return;
+    }
+    out << std::fixed << std::setprecision(3) << Chaos::Clock::now() / 1e6 << " "
+        << Chaos::ControllerInputTable::canonicalEventName(event)
+        << (event.type == Chaos::TYPE_AXIS ? "/axis " : " ") << event.value << "\n";
+  }
+
+  std::ostream& out;
+};
+
+void printUsage(const char* program) {
+  std::cerr
+      << "Usage: " << program << " -g <game-config.toml> (-i <trace> | --recording <file>) [options]\n"
+      << "Options:\n"
+      << "  -g, --game-config <path>   Game config TOML file (required)\n"
+      << "  -i, --input <path>         Trace of timed controller events and interface commands\n"
+      << "      --recording <file>     Use the controller input from a flight recorder dump\n"
+      << "  -o, --output <path|->      Controller-state stream destination (default: stdout)\n"
+      << "  -v, --verbosity <0-6>      plog verbosity, written to stderr (default: 3/warning)\n"
+      << "      --tick-us <us>         Virtual time between engine ticks (default: 500)\n"
+      << "      --tail <seconds>       Keep running this long after the last trace entry\n"
+      << "      --seed <n>             Seed for random modifier choices (default: 1)\n"
+      << "  -h, --help                 Show this help\n";
+}
+
+bool parseArgs(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      printUsage(argv[0]);
+      std::exit(EXIT_SUCCESS);
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "Missing value for " << arg << "\n";
+      return false;
+    }
+    const std::string value = argv[++i];
+    try {
+      if (arg == "-g" || arg == "--game-config") {
+        options.game_config_path = value;
+      } else if (arg == "-i" || arg == "--input") {
+        options.trace_path = value;
+      } else if (arg == "--recording") {
+        options.recording_path = value;
+      } else if (arg == "-o" || arg == "--output") {
+        if (value == "-") {
+          options.output_path.reset();
+        } else {
+          options.output_path = value;
+        }
+      } else if (arg == "-v" || arg == "--verbosity") {
+        options.verbosity = static_cast<plog::Severity>(
+            std::clamp(std::stoi(value), static_cast<int>(plog::none), static_cast<int>(plog::verbose)));
+      } else if (arg == "--tick-us") {
+        const long parsed = std::stol(value);
+        if (parsed <= 0) {
+          std::cerr << "Invalid value for --tick-us: " << value << "\n";
+          return false;
+        }
+        options.tick_ns = parsed * 1000;
+      } else if (arg == "--tail") {
+        options.tail_sec = std::stod(value);
+      } else if (arg == "--seed") {
+        options.seed = std::stoull(value);
+      } else {
+        std::cerr << "Unknown option: " << arg << "\n";
+        return false;
+      }
+    } catch (const std::exception&) {
+      std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+      return false;
+    }
+  }
+
+  if (options.game_config_path.empty()) {
+    std::cerr << "Missing required option: -g/--game-config\n";
+    return false;
+  }
+  if (!options.trace_path && !options.recording_path) {
+    std::cerr << "Nothing to replay: give -i/--input or --recording\n";
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Trace format, one entry per line, times in seconds from the start of the session:
+ *
+ *   <time> event <type> <id> <value>
+ *   <time> command <json>
+ *
+ * Blank lines and lines starting with '#' are ignored.
+ */
+bool loadTrace(const std::filesystem::path& path, std::vector<TraceEntry>& entries) {
+  std::ifstream in(path);
+  if (!in) {
+    std::cerr << "Cannot open trace '" << path.string() << "'\n";
+    return false;
+  }
+  std::string line;
+  int line_number = 0;
+  while (std::getline(in, line)) {
+    ++line_number;
+    std::istringstream fields(line);
+    double seconds;
+    std::string kind;
+    if (line.find_first_not_of(" \t\r") == std::string::npos ||
+        line[line.find_first_not_of(" \t")] == '#') {
+      continue;
+    }
+    if (!(fields >> seconds >> kind)) {
+      std::cerr << path.string() << ":" << line_number << ": expected '<time> event|command ...'\n";
+      return false;
+    }
+    TraceEntry entry{static_cast<int64_t>(seconds * Chaos::Clock::NSEC_PER_SEC), false, {}, {}};
+    if (kind == "event") {
+      int type, id, value;
+      if (!(fields >> type >> id >> value)) {
+        std::cerr << path.string() << ":" << line_number << ": expected '<type> <id> <value>'\n";
+        return false;
+      }
+      entry.event = Chaos::DeviceEvent{0, static_cast<short>(value), static_cast<uint8_t>(type),
+                                       static_cast<uint8_t>(id)};
+    } else if (kind == "command") {
+      entry.is_command = true;
+      std::getline(fields >> std::ws, entry.command);
+    } else {
+      std::cerr << path.string() << ":" << line_number << ": unknown entry '" << kind << "'\n";
+      return false;
+    }
+    entries.push_back(std::move(entry));
+  }
+  return true;
+}
+
+// Controller input from a flight recorder dump, timed from the first record
+bool loadRecording(const std::filesystem::path& path, std::vector<TraceEntry>& entries) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    std::cerr << "Cannot open recording '" << path.string() << "'\n";
+    return false;
+  }
+  std::vector<std::string> names;
+  std::vector<Chaos::FlightRecorder::Record> records;
+  if (!Chaos::FlightRecorder::load(in, names, records)) {
+    std::cerr << "'" << path.string() << "' is not a readable flight recording\n";
+    return false;
+  }
+  if (records.empty()) {
+    return true;
+  }
+  const int64_t start = records.front().time_ns;
+  for (const auto& rec : records) {
+    if (rec.stage == Chaos::FlightRecorder::Stage::INPUT) {
+      entries.push_back(TraceEntry{rec.time_ns - start, false,
+                                   Chaos::DeviceEvent{0, rec.in_value, rec.in_type, rec.in_id}, {}});
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseArgs(argc, argv, options)) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  // Keep the log off stdout so it doesn't mix with the state stream
+  plog::init<plog::TxtFormatter>(options.verbosity, plog::streamStdErr);
+
+  std::vector<TraceEntry> entries;
+  if (options.recording_path && !loadRecording(*options.recording_path, entries)) {
+    return EXIT_FAILURE;
+  }
+  if (options.trace_path && !loadTrace(*options.trace_path, entries)) {
+    return EXIT_FAILURE;
+  }
+  // Recording input and trace commands may interleave. Keep file order for equal times.
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const TraceEntry& a, const TraceEntry& b) { return a.time < b.time; });
+
+  std::ofstream file;
+  if (options.output_path) {
+    file.open(*options.output_path);
+    if (!file) {
+      std::cerr << "Cannot write to '" << options.output_path->string() << "'\n";
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream& out = options.output_path ? file : std::cout;
+
+  // The clock must be virtual before the engine and its timers are created
+  Chaos::Clock::useVirtual(0);
+  Chaos::Random::seed(options.seed);
+  ReplayController controller(out);
+  Chaos::ChaosEngine engine(controller, "", "", false);
+  if (!engine.setGame(options.game_config_path.string())) {
+    std::cerr << "Could not load '" << options.game_config_path.string() << "'\n";
+    return EXIT_FAILURE;
+  }
+
+  // The engine starts paused. Press and release SHARE as a player would to start the session.
+  controller.inject(Chaos::DeviceEvent{0, 1, Chaos::TYPE_BUTTON, Chaos::BUTTON_SHARE});
+  controller.inject(Chaos::DeviceEvent{0, 0, Chaos::TYPE_BUTTON, Chaos::BUTTON_SHARE});
+
+  const int64_t end = (entries.empty() ? 0 : entries.back().time) +
+                      static_cast<int64_t>(options.tail_sec * Chaos::Clock::NSEC_PER_SEC);
+  size_t next = 0;
+  for (int64_t now = 0; now <= end; now += options.tick_ns) {
+    // A sequence played during the last tick may have carried the clock past this point
+    Chaos::Clock::advanceTo(now);
+    while (next < entries.size() && entries[next].time <= Chaos::Clock::now()) {
+      const TraceEntry& entry = entries[next++];
+      if (entry.is_command) {
+        engine.newCommand(entry.command);
+      } else {
+        controller.inject(entry.event);
+      }
+    }
+    engine.tick();
+  }
+  out.flush();
+  return EXIT_SUCCESS;
+}
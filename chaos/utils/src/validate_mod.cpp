@@ -27,6 +27,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <list>
@@ -48,11 +49,13 @@
 #include <plog/Initializers/RollingFileInitializer.h>
 #include <toml++/toml.h>
 
+#include <clock.hpp>
 #include "Controller.hpp"
 #include "ControllerInput.hpp"
 #include "ControllerState.hpp"
 #include "DeviceEvent.hpp"
 #include "EngineInterface.hpp"
+#include "FlightRecorder.hpp"
 #include "Game.hpp"
 #include "GameCommand.hpp"
 #include "GameCondition.hpp"
@@ -74,6 +77,7 @@ struct Options {
   bool usb_mode = false;
   bool include_accel = false;
   int joystick_fuzz = 10;
+  std::optional<std::filesystem::path> recording_path;
 };
 
 std::atomic<bool> keep_running{true};
@@ -110,7 +114,7 @@ public:
     return controller.getState(id, type);
   }
 
-  bool eventMatches(const Chaos::DeviceEvent& event, std::shared_ptr<Chaos::GameCommand> command) override {
+  bool eventMatches(const Chaos::DeviceEvent& event, Chaos::Handle<Chaos::GameCommand> command) override {
     if (!command) {
       return false;
     }
@@ -118,7 +122,7 @@ public:
     return signal ? signal->matches(event) : false;
   }
 
-  void setOff(std::shared_ptr<Chaos::GameCommand> command) override {
+  void setOff(Chaos::Handle<Chaos::GameCommand> command) override {
     if (!command) {
       return;
     }
@@ -128,7 +132,7 @@ public:
     }
   }
 
-  void setOn(std::shared_ptr<Chaos::GameCommand> command) override {
+  void setOn(Chaos::Handle<Chaos::GameCommand> command) override {
     if (!command) {
       return;
     }
@@ -138,7 +142,24 @@ public:
     }
   }
 
-  void setValue(std::shared_ptr<Chaos::GameCommand> command, short value) override {
+  void scheduleAction(const Chaos::ScheduledAction& action) override {
+    scheduled.push(action);
+  }
+
+  void cancelScheduled(const Chaos::Modifier* source) override {
+    scheduled.cancel(source);
+  }
+
+  // Make the scheduled changes that have come due. Called from the lifecycle loop.
+  void runScheduled(int64_t now) {
+    std::vector<Chaos::ScheduledAction> due;
+    scheduled.popDue(now, due);
+    for (const auto& action : due) {
+      applyScheduled(action);
+    }
+  }
+
+  void setValue(Chaos::Handle<Chaos::GameCommand> command, short value) override {
     if (!command) {
       return;
     }
@@ -160,7 +181,9 @@ public:
     return game.getModifierMap();
   }
 
-  std::list<std::shared_ptr<Chaos::Modifier>>& getActiveMods() override {
+  const Chaos::ModifierIndex* getModifierIndex() override { return &game.getModifierIndex(); }
+
+  Chaos::ActiveModifiers& getActiveMods() override {
     return active_mods;
   }
 
@@ -228,12 +251,14 @@ private:
 
   ValidationController controller;
   Chaos::Game game;
-  std::list<std::shared_ptr<Chaos::Modifier>> active_mods;
+  Chaos::ActiveModifiers active_mods;
+  Chaos::ScheduledActionQueue scheduled;
 };
 
 void printUsage(const char* program) {
   std::cerr
       << "Usage: " << program << " -g <game-config.toml> -m <modifier name> [options]\n"
+      << "       " << program << " --decode-recording <file> [-g <game-config.toml>]\n"
       << "Options:\n"
       << "  -g, --game-config <path>   Game config TOML file (required)\n"
       << "  -m, --mod <name>           Modifier name to validate (required)\n"
@@ -244,6 +269,8 @@ void printUsage(const char* program) {
       << "      --usb                  Read live controller USB input and report input->output mapping\n"
       << "      --accel                In USB mode, print ACCX/ACCY/ACCZ changes\n"
       << "      --fuzz=<int>           In USB mode, suppress LX/LY/RX/RY when abs(value) < fuzz (default: 10)\n"
+      << "      --decode-recording <file>\n"
+      << "                             Print a flight recorder dump. With -g, signals are shown by name\n"
       << "  -h, --help                 Show this help\n";
 }
 
@@ -364,10 +391,21 @@ bool parseArgs(int argc, char** argv, Options& options) {
       }
       continue;
     }
+    if (arg == "--decode-recording") {
+      if (i + 1 >= argc) {
+        std::cerr << "Missing value for " << arg << "\n";
+        return false;
+      }
+      options.recording_path = argv[++i];
+      continue;
+    }
     std::cerr << "Unknown option: " << arg << "\n";
     return false;
   }
 
+  if (options.recording_path) {
+    return true;
+  }
   if (options.game_config_path.empty()) {
     std::cerr << "Missing required option: -g/--game-config\n";
     return false;
@@ -455,7 +493,7 @@ bool shouldLogUsbMapping(ParseEngine& engine, const Chaos::DeviceEvent& input,
 class UsbEventCollector final : public Chaos::UsbPassthrough::Observer {
 public:
   UsbEventCollector(ParseEngine& engine, const Options& options,
-                    std::list<std::shared_ptr<Chaos::Modifier>>& active_mods,
+                    Chaos::ActiveModifiers& active_mods,
                     std::mutex& lifecycle_mutex)
       : engine_(engine),
         options_(options),
@@ -518,7 +556,7 @@ public:
           return;
         }
         for (auto& mod : active_mods_) {
-          valid = mod->remap(output);
+          valid = mod->_remap(output);
           if (!valid) {
             break;
           }
@@ -571,7 +609,7 @@ private:
 
   ParseEngine& engine_;
   const Options& options_;
-  std::list<std::shared_ptr<Chaos::Modifier>>& active_mods_;
+  Chaos::ActiveModifiers& active_mods_;
   std::mutex& lifecycle_mutex_;
   std::mutex lock_;
   int vendor_ = -1;
@@ -617,6 +655,72 @@ void listAvailableModifiers(ParseEngine& engine) {
   }
 }
 
+// Print a flight recorder dump, one line per record, with a blank line between events. Times are
+// shown in milliseconds relative to the first record.
+int decodeRecording(const Options& options) {
+  std::ifstream in(*options.recording_path, std::ios::binary);
+  if (!in) {
+    std::cerr << "Cannot open recording '" << options.recording_path->string() << "'\n";
+    return EXIT_FAILURE;
+  }
+  std::vector<std::string> names;
+  std::vector<Chaos::FlightRecorder::Record> records;
+  if (!Chaos::FlightRecorder::load(in, names, records)) {
+    std::cerr << "'" << options.recording_path->string() << "' is not a readable flight recording\n";
+    return EXIT_FAILURE;
+  }
+
+  // Signal names come from the game config, if we have one
+  ParseEngine engine;
+  bool named = false;
+  if (!options.game_config_path.empty()) {
+    try {
+      named = engine.loadGame(options.game_config_path.string());
+    } catch (const std::exception& err) {
+      PLOG_ERROR << "Fatal parse exception: " << err.what();
+    }
+    if (!named) {
+      PLOG_WARNING << "Could not load '" << options.game_config_path.string()
+                   << "'; signals will be shown by type and id.";
+    }
+  }
+  auto signal = [&engine, named](uint8_t type, uint8_t id, short value) {
+    Chaos::DeviceEvent event{0, value, type, id};
+    if (named) {
+      return describeEvent(engine, event);
+    }
+    std::ostringstream out;
+    out << "type=" << static_cast<int>(type) << " id=" << static_cast<int>(id) << " =" << value;
+    return out.str();
+  };
+
+  std::cout << records.size() << " records, " << names.size() << " modifiers\n";
+  if (records.empty()) {
+    return EXIT_SUCCESS;
+  }
+  const int64_t start = records.front().time_ns;
+  uint32_t last_serial = records.front().serial;
+  for (const auto& rec : records) {
+    if (rec.serial != last_serial) {
+      std::cout << "\n";
+      last_serial = rec.serial;
+    }
+    std::cout << std::fixed << std::setprecision(3) << std::setw(10)
+              << (rec.time_ns - start) / 1e6 << " ms  #" << rec.serial << "  "
+              << std::left << std::setw(6) << Chaos::FlightRecorder::stageName(rec.stage) << std::right;
+    if (rec.modifier != Chaos::FlightRecorder::NO_MODIFIER) {
+      std::cout << "  [" << (rec.modifier < names.size() ? names[rec.modifier] : "?") << "]";
+    }
+    std::cout << "  " << Chaos::FlightRecorder::decisionName(rec.decision) << "  "
+              << signal(rec.in_type, rec.in_id, rec.in_value);
+    if (rec.decision == Chaos::FlightRecorder::Decision::REWRITE) {
+      std::cout << " -> " << signal(rec.out_type, rec.out_id, rec.out_value);
+    }
+    std::cout << "\n";
+  }
+  return EXIT_SUCCESS;
+}
+
 int runModifierLifecycle(ParseEngine& engine, std::shared_ptr<Chaos::Modifier> mod,
                          double duration_sec, useconds_t loop_sleep_us,
                          std::mutex& lifecycle_mutex,
@@ -626,7 +730,7 @@ int runModifierLifecycle(ParseEngine& engine, std::shared_ptr<Chaos::Modifier> m
     return EXIT_FAILURE;
   }
 
-  std::list<std::shared_ptr<Chaos::Modifier>>& active_mods = engine.getActiveMods();
+  Chaos::ActiveModifiers& active_mods = engine.getActiveMods();
   {
     std::lock_guard<std::mutex> lifecycle_guard(lifecycle_mutex);
     active_mods.clear();
@@ -687,17 +791,19 @@ int runModifierLifecycle(ParseEngine& engine, std::shared_ptr<Chaos::Modifier> m
         }
       }
 
+      const int64_t now = Chaos::Clock::now();
       for (auto& m : mods_to_begin) {
-        m->_begin();
+        m->_begin(now);
         if (m == mod) {
           saw_start = true;
         }
       }
 
       for (auto& m : mods_to_update) {
-        m->_update(paused_prior);
+        m->_update(paused_prior, now);
       }
       paused_prior = false;
+      engine.runScheduled(now);
 
       std::shared_ptr<Chaos::Modifier> expired_mod;
       for (auto& m : active_mods) {
@@ -747,6 +853,10 @@ int main(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
+  if (options.recording_path) {
+    return decodeRecording(options);
+  }
+
   ParseEngine engine;
   bool loaded = false;
   try {